@@ -849,6 +849,7 @@ void delete_all(int selected_only) {
   if(!selected_only) {
                 include_H_from_C=1;
                 use_FL_COMMAND=0;
+                embed_compressed_images=0;
         }
 
   selection_changed(0);
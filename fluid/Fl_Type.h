@@ -902,6 +902,7 @@ int storestring(const char *n, const char * & p, int nostrip=0);
 
 extern int include_H_from_C;
 extern int use_FL_COMMAND;
+extern int embed_compressed_images;
 
 /*
  This class is needed for additional command line plugins.
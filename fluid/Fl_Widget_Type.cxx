@@ -2534,13 +2534,75 @@ void Fl_Widget_Type::write_properties() {
 
 int pasteoffset;
 extern double read_version;
+
+// Property names understood by Fl_Widget_Type::read_property(). The table
+// must be sorted by name, it is searched with bsearch() because large files
+// contain many thousands of properties.
+
+enum {
+  PROP_ALIGN, PROP_BOX, PROP_CLASS, PROP_COLOR, PROP_DEACTIVATE, PROP_DEIMAGE,
+  PROP_DOWN_BOX, PROP_HIDE, PROP_HOTSPOT, PROP_IMAGE, PROP_LABELCOLOR,
+  PROP_LABELFONT, PROP_LABELSIZE, PROP_LABELTYPE, PROP_MAXIMUM, PROP_MINIMUM,
+  PROP_PRIVATE, PROP_PROTECTED, PROP_RESIZABLE, PROP_SELECTION_COLOR,
+  PROP_SHORTCUT, PROP_SLIDER_SIZE, PROP_STEP, PROP_TEXTCOLOR, PROP_TEXTFONT,
+  PROP_TEXTSIZE, PROP_TOOLTIP, PROP_TYPE, PROP_VALUE, PROP_WHEN, PROP_XYWH
+};
+
+struct widget_property {const char *name; int id;};
+
+static const widget_property widget_properties[] = {
+  {"align",             PROP_ALIGN},
+  {"box",               PROP_BOX},
+  {"class",             PROP_CLASS},
+  {"color",             PROP_COLOR},
+  {"deactivate",        PROP_DEACTIVATE},
+  {"deimage",           PROP_DEIMAGE},
+  {"divider",           PROP_HOTSPOT},
+  {"down_box",          PROP_DOWN_BOX},
+  {"hide",              PROP_HIDE},
+  {"hotspot",           PROP_HOTSPOT},
+  {"image",             PROP_IMAGE},
+  {"labelcolor",        PROP_LABELCOLOR},
+  {"labelfont",         PROP_LABELFONT},
+  {"labelsize",         PROP_LABELSIZE},
+  {"labeltype",         PROP_LABELTYPE},
+  {"maximum",           PROP_MAXIMUM},
+  {"minimum",           PROP_MINIMUM},
+  {"private",           PROP_PRIVATE},
+  {"protected",         PROP_PROTECTED},
+  {"resizable",         PROP_RESIZABLE},
+  {"selection_color",   PROP_SELECTION_COLOR},
+  {"shortcut",          PROP_SHORTCUT},
+  {"size",              PROP_SLIDER_SIZE},
+  {"slider_size",       PROP_SLIDER_SIZE},
+  {"step",              PROP_STEP},
+  {"textcolor",         PROP_TEXTCOLOR},
+  {"textfont",          PROP_TEXTFONT},
+  {"textsize",          PROP_TEXTSIZE},
+  {"tooltip",           PROP_TOOLTIP},
+  {"type",              PROP_TYPE},
+  {"value",             PROP_VALUE},
+  {"when",              PROP_WHEN},
+  {"xywh",              PROP_XYWH}
+};
+
+static int compare_widget_property(const void *a, const void *b) {
+  return strcmp((const char *)a, ((const widget_property *)b)->name);
+}
+
 void Fl_Widget_Type::read_property(const char *c) {
   int x,y,w,h; Fl_Font f; int s; Fl_Color cc;
-  if (!strcmp(c,"private")) {
+  const widget_property *prop = (const widget_property *)
+    bsearch(c, widget_properties, sizeof(widget_properties)/sizeof(*widget_properties),
+            sizeof(*widget_properties), compare_widget_property);
+  switch (prop ? prop->id : -1) {
+  case PROP_PRIVATE:
     public_ = 0;
-  } else if (!strcmp(c,"protected")) {
+    return;
+  case PROP_PROTECTED:
     public_ = 2;
-  } else if (!strcmp(c,"xywh")) {
+    return;
+  case PROP_XYWH:
     if (sscanf(read_word(),"%d %d %d %d",&x,&y,&w,&h) == 4) {
       x += pasteoffset;
       y += pasteoffset;
@@ -2551,45 +2613,54 @@ void Fl_Widget_Type::read_property(const char *c) {
       }
       o->resize(x,y,w,h);
     }
-  } else if (!strcmp(c,"tooltip")) {
+    return;
+  case PROP_TOOLTIP:
     tooltip(read_word());
-  } else if (!strcmp(c,"image")) {
+    return;
+  case PROP_IMAGE:
     image_name(read_word());
-  } else if (!strcmp(c,"deimage")) {
+    return;
+  case PROP_DEIMAGE:
     inactive_name(read_word());
-  } else if (!strcmp(c,"type")) {
+    return;
+  case PROP_TYPE:
     if (is_spinner())
       ((Fl_Spinner*)o)->type(item_number(subtypes(), read_word()));
     else
       o->type(item_number(subtypes(), read_word()));
-  } else if (!strcmp(c,"box")) {
+    return;
+  case PROP_BOX: {
     const char* value = read_word();
     if ((x = boxnumber(value))) {
       if (x == ZERO_ENTRY) x = 0;
       o->box((Fl_Boxtype)x);
     } else if (sscanf(value,"%d",&x) == 1) o->box((Fl_Boxtype)x);
-  } else if (is_button() && !strcmp(c,"down_box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      ((Fl_Button*)o)->down_box((Fl_Boxtype)x);
-    }
-  } else if (!strcmp(type_name(), "Fl_Input_Choice") && !strcmp(c,"down_box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      ((Fl_Input_Choice*)o)->down_box((Fl_Boxtype)x);
-    }
-  } else if (is_menu_button() && !strcmp(c,"down_box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      ((Fl_Menu_*)o)->down_box((Fl_Boxtype)x);
+    return; }
+  case PROP_DOWN_BOX:
+    if (is_button()) {
+      const char* value = read_word();
+      if ((x = boxnumber(value))) {
+        if (x == ZERO_ENTRY) x = 0;
+        ((Fl_Button*)o)->down_box((Fl_Boxtype)x);
+      }
+      return;
+    } else if (!strcmp(type_name(), "Fl_Input_Choice")) {
+      const char* value = read_word();
+      if ((x = boxnumber(value))) {
+        if (x == ZERO_ENTRY) x = 0;
+        ((Fl_Input_Choice*)o)->down_box((Fl_Boxtype)x);
+      }
+      return;
+    } else if (is_menu_button()) {
+      const char* value = read_word();
+      if ((x = boxnumber(value))) {
+        if (x == ZERO_ENTRY) x = 0;
+        ((Fl_Menu_*)o)->down_box((Fl_Boxtype)x);
+      }
+      return;
     }
-  } else if (is_button() && !strcmp(c,"value")) {
-    const char* value = read_word();
-    ((Fl_Button*)o)->value(atoi(value));
-  } else if (!strcmp(c,"color")) {
+    break;
+  case PROP_COLOR: {
     const char *cw = read_word();
     if (cw[0]=='0' && cw[1]=='x') {
       sscanf(cw,"0x%x",&x);
@@ -2603,9 +2674,11 @@ void Fl_Widget_Type::read_property(const char *c) {
         o->color(x);
       }
     }
-  } else if (!strcmp(c,"selection_color")) {
+    return; }
+  case PROP_SELECTION_COLOR:
     if (sscanf(read_word(),"%d",&x)) o->selection_color(x);
-  } else if (!strcmp(c,"labeltype")) {
+    return;
+  case PROP_LABELTYPE:
     c = read_word();
     if (!strcmp(c,"image")) {
       Fluid_Image *i = Fluid_Image::find(label());
@@ -2616,65 +2689,92 @@ void Fl_Widget_Type::read_property(const char *c) {
     } else {
       o->labeltype((Fl_Labeltype)item_number(labeltypemenu,c));
     }
-  } else if (!strcmp(c,"labelfont")) {
+    return;
+  case PROP_LABELFONT:
     if (sscanf(read_word(),"%d",&x) == 1) o->labelfont(x);
-  } else if (!strcmp(c,"labelsize")) {
+    return;
+  case PROP_LABELSIZE:
     if (sscanf(read_word(),"%d",&x) == 1) o->labelsize(x);
-  } else if (!strcmp(c,"labelcolor")) {
+    return;
+  case PROP_LABELCOLOR:
     if (sscanf(read_word(),"%d",&x) == 1) o->labelcolor(x);
-  } else if (!strcmp(c,"align")) {
+    return;
+  case PROP_ALIGN:
     if (sscanf(read_word(),"%d",&x) == 1) o->align(x);
-  } else if (!strcmp(c,"when")) {
+    return;
+  case PROP_WHEN:
     if (sscanf(read_word(),"%d",&x) == 1) o->when(x);
-  } else if (!strcmp(c,"minimum")) {
+    return;
+  case PROP_MINIMUM:
     if (is_valuator()) ((Fl_Valuator*)o)->minimum(strtod(read_word(),0));
     if (is_spinner()) ((Fl_Spinner*)o)->minimum(strtod(read_word(),0));
-  } else if (!strcmp(c,"maximum")) {
+    return;
+  case PROP_MAXIMUM:
     if (is_valuator()) ((Fl_Valuator*)o)->maximum(strtod(read_word(),0));
     if (is_spinner()) ((Fl_Spinner*)o)->maximum(strtod(read_word(),0));
-  } else if (!strcmp(c,"step")) {
+    return;
+  case PROP_STEP:
     if (is_valuator()) ((Fl_Valuator*)o)->step(strtod(read_word(),0));
     if (is_spinner()) ((Fl_Spinner*)o)->step(strtod(read_word(),0));
-  } else if (!strcmp(c,"value")) {
+    return;
+  case PROP_VALUE:
+    if (is_button()) {
+      const char* value = read_word();
+      ((Fl_Button*)o)->value(atoi(value));
+      return;
+    }
     if (is_valuator()) ((Fl_Valuator*)o)->value(strtod(read_word(),0));
     if (is_spinner()) ((Fl_Spinner*)o)->value(strtod(read_word(),0));
-  } else if ((!strcmp(c,"slider_size")||!strcmp(c,"size"))&&is_valuator()==2) {
-    ((Fl_Slider*)o)->slider_size(strtod(read_word(),0));
-  } else if (!strcmp(c,"textfont")) {
+    return;
+  case PROP_SLIDER_SIZE:
+    if (is_valuator()==2) {
+      ((Fl_Slider*)o)->slider_size(strtod(read_word(),0));
+      return;
+    }
+    break;
+  case PROP_TEXTFONT:
     if (sscanf(read_word(),"%d",&x) == 1) {f=(Fl_Font)x; textstuff(1,f,s,cc);}
-  } else if (!strcmp(c,"textsize")) {
+    return;
+  case PROP_TEXTSIZE:
     if (sscanf(read_word(),"%d",&x) == 1) {s=x; textstuff(2,f,s,cc);}
-  } else if (!strcmp(c,"textcolor")) {
+    return;
+  case PROP_TEXTCOLOR:
     if (sscanf(read_word(),"%d",&x) == 1) {cc=(Fl_Color)x;textstuff(3,f,s,cc);}
-  } else if (!strcmp(c,"hide")) {
+    return;
+  case PROP_HIDE:
     o->hide();
-  } else if (!strcmp(c,"deactivate")) {
+    return;
+  case PROP_DEACTIVATE:
     o->deactivate();
-  } else if (!strcmp(c,"resizable")) {
+    return;
+  case PROP_RESIZABLE:
     resizable(1);
-  } else if (!strcmp(c,"hotspot") || !strcmp(c, "divider")) {
+    return;
+  case PROP_HOTSPOT:
     hotspot(1);
-  } else if (!strcmp(c,"class")) {
+    return;
+  case PROP_CLASS:
     subclass(read_word());
-  } else if (!strcmp(c,"shortcut")) {
+    return;
+  case PROP_SHORTCUT: {
     int shortcut = strtol(read_word(),0,0);
     if (is_button()) ((Fl_Button*)o)->shortcut(shortcut);
     else if (is_input()) ((Fl_Input_*)o)->shortcut(shortcut);
     else if (is_value_input()) ((Fl_Value_Input*)o)->shortcut(shortcut);
     else if (is_text_display()) ((Fl_Text_Display*)o)->shortcut(shortcut);
-  } else {
-    if (!strncmp(c,"code",4)) {
-      int n = atoi(c+4);
-      if (n >= 0 && n <= NUM_EXTRA_CODE) {
-        extra_code(n,read_word());
-        return;
-      }
-    } else if (!strcmp(c,"extra_code")) {
-      extra_code(0,read_word());
+    return; }
+  }
+  if (!strncmp(c,"code",4)) {
+    int n = atoi(c+4);
+    if (n >= 0 && n <= NUM_EXTRA_CODE) {
+      extra_code(n,read_word());
       return;
     }
-    Fl_Type::read_property(c);
+  } else if (!strcmp(c,"extra_code")) {
+    extra_code(0,read_word());
+    return;
   }
+  Fl_Type::read_property(c);
 }
 
 Fl_Menu_Item boxmenu1[] = {
@@ -39,6 +39,7 @@ extern int show_guides;
 
 int include_H_from_C = 1;
 int use_FL_COMMAND = 0;
+int embed_compressed_images = 0;
 extern int i18n_type;
 extern const char* i18n_include;
 extern const char* i18n_function;
@@ -181,6 +182,7 @@ void show_project_cb(Fl_Widget *, void *) {
   if(project_window==0) make_project_window();
   include_H_from_C_button->value(include_H_from_C);
   use_FL_COMMAND_button->value(use_FL_COMMAND);
+  embed_compressed_images_button->value(embed_compressed_images);
   header_file_input->value(header_file_name);
   code_file_input->value(code_file_name);
   i18n_type_chooser->value(i18n_type);
@@ -264,6 +266,13 @@ void use_FL_COMMAND_button_cb(Fl_Check_Button* b, void*) {
   }
 }
 
+void embed_compressed_images_button_cb(Fl_Check_Button* b, void*) {
+  if (embed_compressed_images != b->value()) {
+    set_modflag(1);
+    embed_compressed_images = b->value();
+  }
+}
+
 ////////////////////////////////////////////////////////////////
 
 Fl_Menu_Item window_type_menu[] = {
@@ -25,6 +25,7 @@
 #include <stdarg.h>
 #include <FL/filename.H>
 #include <FL/fl_string.h>
+#include <string.h>
 
 extern void goto_source_dir(); // in fluid.cxx
 extern void leave_source_dir(); // in fluid.cxx
@@ -40,13 +41,142 @@ void Fluid_Image::deimage(Fl_Widget *o) {
 static int pixmap_header_written = 0;
 static int bitmap_header_written = 0;
 static int image_header_written = 0;
-static int jpeg_header_written = 0;
+
+// Image file formats that are embedded as the original (compressed) file
+// data and decoded from memory when the image is first used. SVG files and
+// JPEG files named *.jpg are always embedded this way, other JPEG files and
+// PNG, GIF, and BMP files only if the project option embed_compressed_images
+// is set.
+enum { EMBED_JPEG, EMBED_PNG, EMBED_GIF, EMBED_BMP, EMBED_SVG, EMBED_NUM };
+static const char *embed_type_name[EMBED_NUM] = {
+  "Fl_JPEG_Image", "Fl_PNG_Image", "Fl_GIF_Image", "Fl_BMP_Image", "Fl_SVG_Image"
+};
+static int embed_header_written[EMBED_NUM];
+
+// Return the format of the file data if it can be embedded, or -1.
+static int embed_format(const unsigned char *data, size_t n) {
+  if (n > 3 && data[0] == 0xff && data[1] == 0xd8 && data[2] == 0xff)
+    return EMBED_JPEG;
+  if (n > 8 && memcmp(data, "\211PNG\r\n\032\n", 8) == 0)
+    return EMBED_PNG;
+  if (n > 6 && (memcmp(data, "GIF87a", 6) == 0 || memcmp(data, "GIF89a", 6) == 0))
+    return EMBED_GIF;
+  if (n > 2 && data[0] == 'B' && data[1] == 'M')
+    return EMBED_BMP;
+  // Fl_SVG_Image can't read compressed (.svgz) data from memory
+  if ((n > 5 && memcmp(data, "<?xml", 5) == 0) || (n > 4 && memcmp(data, "<svg", 4) == 0))
+    return EMBED_SVG;
+  return -1;
+}
+
+// Read the complete image file, returns NULL if the file can't be read.
+// SVG data needs a trailing nul, so one more byte is allocated and cleared.
+static unsigned char *read_image_file(const char *name, size_t &n) {
+  n = 0;
+  FILE *f = fl_fopen(name, "rb");
+  if (!f) return 0;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  unsigned char *data = 0;
+  if (size > 0) {
+    data = (unsigned char *)calloc(size + 1, 1);
+    if (fread(data, size, 1, f) == 1) {
+      n = size;
+    } else {
+      free(data);
+      data = 0;
+    }
+  }
+  fclose(f);
+  return data;
+}
+
+// Image files embedded into the current source file. Images with the same
+// file data (e.g. the same file under different paths) share the data and
+// the function that returns the image.
+struct Fluid_Embedded_File {
+  unsigned char *data;
+  size_t size;
+  unsigned hash;
+  const char *function_name;
+};
+static Fluid_Embedded_File *embedded = 0;
+static int num_embedded = 0;
+static int alloc_embedded = 0;
+static int embedded_written = 0;
+
+static unsigned hash_data(const unsigned char *data, size_t n) {
+  unsigned h = 2166136261U; // FNV-1a
+  for (size_t i = 0; i < n; i++) {
+    h ^= data[i];
+    h *= 16777619U;
+  }
+  return h;
+}
 
 void Fluid_Image::write_static() {
   if (!img) return;
   const char *idata_name = unique_id(this, "idata", fl_filename_name(name()), 0);
   function_name_ = unique_id(this, "image", fl_filename_name(name()), 0);
-  if (img->count() > 1) {
+
+  // check the file for a format that can be embedded compressed
+  size_t nData = 0;
+  unsigned char *data = read_image_file(name(), nData);
+  int format = data ? embed_format(data, nData) : -1;
+  // Other data than SVG and JPEG in *.jpg files is only embedded if the
+  // project asks for it, since the program must then be linked with fltk_images
+  if (format >= 0 && format != EMBED_SVG && !embed_compressed_images &&
+      !(format == EMBED_JPEG && strcmp(fl_filename_ext(name()), ".jpg") == 0))
+    format = -1;
+  if (format < 0) {
+    free(data);
+  } else {
+    if (embedded_written != write_number) {
+      for (int i = 0; i < num_embedded; i++) free(embedded[i].data);
+      num_embedded = 0;
+      embedded_written = write_number;
+    }
+    unsigned hash = hash_data(data, nData);
+    for (int i = 0; i < num_embedded; i++) {
+      Fluid_Embedded_File &e = embedded[i];
+      if (e.hash == hash && e.size == nData && !memcmp(e.data, data, nData)) {
+        // identical file data was already written
+        function_name_ = e.function_name;
+        free(data);
+        return;
+      }
+    }
+    if (num_embedded >= alloc_embedded) {
+      alloc_embedded = alloc_embedded ? 2 * alloc_embedded : 16;
+      embedded = (Fluid_Embedded_File *)realloc(embedded, alloc_embedded * sizeof(Fluid_Embedded_File));
+    }
+    Fluid_Embedded_File &e = embedded[num_embedded++];
+    e.data = data;
+    e.size = nData;
+    e.hash = hash;
+    e.function_name = function_name_;
+  }
+
+  if (format >= 0) {
+    // Write the original image file data...
+    write_c("\n");
+    if (embed_header_written[format] != write_number) {
+      write_c("#include <FL/%s.H>\n", embed_type_name[format]);
+      embed_header_written[format] = write_number;
+    }
+    write_c("static const unsigned char %s[] =\n", idata_name);
+    if (format == EMBED_SVG) {
+      write_cdata((const char *)data, (int)nData + 1); // including the nul
+      write_c(";\n");
+      write_initializer("Fl_SVG_Image", "NULL, (const char *)%s", idata_name);
+    } else {
+      write_cdata((const char *)data, (int)nData);
+      write_c(";\n");
+      write_initializer(embed_type_name[format], "\"%s\", %s, %d",
+                        fl_filename_name(name()), idata_name, (int)nData);
+    }
+  } else if (img->count() > 1) {
     // Write Pixmap data...
     write_c("\n");
     if (pixmap_header_written != write_number) {
@@ -87,33 +217,6 @@ void Fluid_Image::write_static() {
     write_cdata(img->data()[0], ((img->w() + 7) / 8) * img->h());
     write_c(";\n");
     write_initializer( "Fl_Bitmap", "%s, %d, %d", idata_name, img->w(), img->h());
-  } else if (strcmp(fl_filename_ext(name()), ".jpg")==0) {
-    // Write jpeg image data...
-    write_c("\n");
-    if (jpeg_header_written != write_number) {
-      write_c("#include <FL/Fl_JPEG_Image.H>\n");
-      jpeg_header_written = write_number;
-    }
-    write_c("static const unsigned char %s[] =\n", idata_name);
-
-    FILE *f = fl_fopen(name(), "rb");
-    if (!f) {
-      // message = "Can't inline file into source code. Can't open";
-    } else {
-      fseek(f, 0, SEEK_END);
-      size_t nData = ftell(f);
-      fseek(f, 0, SEEK_SET);
-      if (nData) {
-        char *data = (char*)calloc(nData, 1);
-        if (fread(data, nData, 1, f)==0) { /* ignore */ }
-        write_cdata(data, nData);
-        free(data);
-      }
-      fclose(f);
-    }
-
-    write_c(";\n");
-    write_initializer("Fl_JPEG_Image", "\"%s\", %s", fl_filename_name(name()), idata_name);
   } else {
     // Write image data...
     write_c("\n");
@@ -27,6 +27,10 @@
 static FILE *code_file;
 static FILE *header_file;
 
+// stdio buffer size for the generated files, large files are written
+// in few big chunks
+#define WRITE_BUFFER_SIZE 0x40000
+
 extern char i18n_program[];
 extern int i18n_type;
 extern const char* i18n_include;
@@ -41,23 +45,85 @@ int is_id(char c) {
 }
 
 ////////////////////////////////////////////////////////////////
-// Generate unique but human-readable identifiers:
+// Hash tables of strings, used for identifiers and declarations:
 
 struct id {
   char* text;
   void* object;
-  id *left, *right;
-  id (const char* t, void* o) : text(fl_strdup(t)), object(o) {left = right = 0;}
-  ~id();
+  int suffix;   // last number appended to text to make it unique
+  id *next;     // next entry in the same hash bucket
+};
+
+struct id_table {
+  id **bucket;
+  unsigned size, count;
 };
 
-id::~id() {
-  delete left;
-  free((void *)text);
-  delete right;
+static unsigned id_hash(const char *t) {
+  unsigned h = 2166136261U; // FNV-1a
+  while (*t) {
+    h ^= (unsigned char)*t++;
+    h *= 16777619U;
+  }
+  return h;
+}
+
+static id *id_find(const id_table &tbl, const char *t) {
+  if (!tbl.size) return 0;
+  for (id *p = tbl.bucket[id_hash(t) & (tbl.size - 1)]; p; p = p->next)
+    if (!strcmp(p->text, t)) return p;
+  return 0;
+}
+
+static id *id_add(id_table &tbl, const char *t, void *o) {
+  if (tbl.count >= tbl.size) { // grow and rehash
+    unsigned size = tbl.size ? 2 * tbl.size : 1024;
+    id **bucket = (id **)calloc(size, sizeof(id *));
+    for (unsigned i = 0; i < tbl.size; i++) {
+      for (id *p = tbl.bucket[i]; p;) {
+        id *n = p->next;
+        unsigned h = id_hash(p->text) & (size - 1);
+        p->next = bucket[h];
+        bucket[h] = p;
+        p = n;
+      }
+    }
+    free(tbl.bucket);
+    tbl.bucket = bucket;
+    tbl.size = size;
+  }
+  id *p = new id;
+  p->text = fl_strdup(t);
+  p->object = o;
+  p->suffix = 0;
+  unsigned h = id_hash(t) & (tbl.size - 1);
+  p->next = tbl.bucket[h];
+  tbl.bucket[h] = p;
+  tbl.count++;
+  return p;
+}
+
+static void id_clear(id_table &tbl) {
+  for (unsigned i = 0; i < tbl.size; i++) {
+    for (id *p = tbl.bucket[i]; p;) {
+      id *n = p->next;
+      free(p->text);
+      delete p;
+      p = n;
+    }
+  }
+  free(tbl.bucket);
+  tbl.bucket = 0;
+  tbl.size = tbl.count = 0;
 }
 
-static id* id_root;
+////////////////////////////////////////////////////////////////
+// Generate unique but human-readable identifiers:
+
+// all identifiers used so far
+static id_table ids;
+// identifiers that got a suffix, keyed by object and base name
+static id_table id_aliases;
 
 const char* unique_id(void* o, const char* type, const char* name, const char* label) {
   char buffer[128];
@@ -71,23 +137,29 @@ const char* unique_id(void* o, const char* type, const char* name, const char* l
     while (is_id(*n)) *q++ = *n++;
   }
   *q = 0;
-  // okay, search the tree and see if the name was already used:
-  id** p = &id_root;
-  int which = 0;
-  while (*p) {
-    int i = strcmp(buffer, (*p)->text);
-    if (!i) {
-      if ((*p)->object == o) return (*p)->text;
-      // already used, we need to pick a new name:
-      sprintf(q,"%x",++which);
-      p = &id_root;
-      continue;
+  // okay, see if the name was already used:
+  id* base = id_find(ids, buffer);
+  if (!base) return id_add(ids, buffer, o)->text;
+  if (base->object == o) return base->text;
+  // already used, see if we picked a new name for this object before:
+  char key[160];
+  snprintf(key, sizeof(key), "%p %s", o, buffer);
+  id* alias = id_find(id_aliases, key);
+  if (alias) return ((id*)alias->object)->text;
+  // no, so pick a new name, continuing after the last suffix used
+  // for this name:
+  id* p;
+  for (;;) {
+    sprintf(q, "%x", ++base->suffix);
+    p = id_find(ids, buffer);
+    if (!p) {
+      p = id_add(ids, buffer, o);
+      break;
     }
-    else if (i < 0) p = &((*p)->left);
-    else p  = &((*p)->right);
+    if (p->object == o) break;
   }
-  *p = new id(buffer, o);
-  return (*p)->text;
+  id_add(id_aliases, key, p);
+  return p->text;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -103,25 +175,10 @@ const char* indent() {
 ////////////////////////////////////////////////////////////////
 // declarations/include files:
 // Each string generated by write_declare is written only once to
-// the header file.  This is done by keeping a binary tree of all
-// the calls so far and not printing it if it is in the tree.
-
-struct included {
-  char *text;
-  included *left, *right;
-  included(const char *t) {
-    text = fl_strdup(t);
-    left = right = 0;
-  }
-  ~included();
-};
+// the header file.  This is done by keeping a hash table of all
+// the calls so far and not printing it if it is in the table.
 
-included::~included() {
-  delete left;
-  free((void *)text);
-  delete right;
-}
-static included *included_root;
+static id_table included;
 
 int write_declare(const char *format, ...) {
   va_list args;
@@ -129,15 +186,9 @@ int write_declare(const char *format, ...) {
   va_start(args, format);
   vsnprintf(buf, sizeof(buf), format, args);
   va_end(args);
-  included **p = &included_root;
-  while (*p) {
-    int i = strcmp(buf,(*p)->text);
-    if (!i) return 0;
-    else if (i < 0) p = &((*p)->left);
-    else p  = &((*p)->right);
-  }
+  if (id_find(included, buf)) return 0;
   fprintf(header_file,"%s\n",buf);
-  *p = new included(buf);
+  id_add(included, buf, 0);
   return 1;
 }
 
@@ -173,8 +224,14 @@ void write_cstring(const char *s, int length) {
   const char *p = s;
   const char *e = s+length;
   int linelength = 1;
-  putc('\"', code_file);
+  // collect the output in a buffer, putc() per character is slow
+  char buf[1024], *o = buf;
+  *o++ = '\"';
   for (; p < e;) {
+    if (o > buf+sizeof(buf)-16) {
+      fwrite(buf, 1, o-buf, code_file);
+      o = buf;
+    }
     int c = *p++;
     switch (c) {
     case '\b': c = 'b'; goto QUOTED;
@@ -186,9 +243,9 @@ void write_cstring(const char *s, int length) {
     case '\'':
     case '\\':
     QUOTED:
-      if (linelength >= 77) {fputs("\\\n",code_file); linelength = 0;}
-      putc('\\', code_file);
-      putc(c, code_file);
+      if (linelength >= 77) {*o++ = '\\'; *o++ = '\n'; linelength = 0;}
+      *o++ = '\\';
+      *o++ = c;
       linelength += 2;
       break;
     case '?': // prevent trigraphs by writing ?? as ?\?
@@ -197,39 +254,41 @@ void write_cstring(const char *s, int length) {
     default:
       if (c >= ' ' && c < 127) {
         // a legal ASCII character
-        if (linelength >= 78) {fputs("\\\n",code_file); linelength = 0;}
-        putc(c, code_file);
+        if (linelength >= 78) {*o++ = '\\'; *o++ = '\n'; linelength = 0;}
+        *o++ = c;
         linelength++;
         break;
       }
       // otherwise we must print it as an octal constant:
       c &= 255;
       if (c < 8) {
-        if (linelength >= 76) {fputs("\\\n",code_file); linelength = 0;}
-        fprintf(code_file, "\\%o",c);
+        if (linelength >= 76) {*o++ = '\\'; *o++ = '\n'; linelength = 0;}
         linelength += 2;
       } else if (c < 64) {
-        if (linelength >= 75) {fputs("\\\n",code_file); linelength = 0;}
-        fprintf(code_file, "\\%o",c);
+        if (linelength >= 75) {*o++ = '\\'; *o++ = '\n'; linelength = 0;}
         linelength += 3;
       } else {
-        if (linelength >= 74) {fputs("\\\n",code_file); linelength = 0;}
-        fprintf(code_file, "\\%o",c);
+        if (linelength >= 74) {*o++ = '\\'; *o++ = '\n'; linelength = 0;}
         linelength += 4;
       }
+      *o++ = '\\';
+      if (c >= 64) *o++ = '0' + (c>>6);
+      if (c >= 8) *o++ = '0' + ((c>>3)&7);
+      *o++ = '0' + (c&7);
       // We must not put more numbers after it, because some C compilers
       // consume them as part of the quoted sequence.  Use string constant
       // pasting to avoid this:
       c = *p;
       if (p < e && ( (c>='0'&&c<='9') || (c>='a'&&c<='f') || (c>='A'&&c<='F') )) {
-        putc('\"', code_file); linelength++;
-        if (linelength >= 79) {fputs("\n",code_file); linelength = 0;}
-        putc('\"', code_file); linelength++;
+        *o++ = '\"'; linelength++;
+        if (linelength >= 79) {*o++ = '\n'; linelength = 0;}
+        *o++ = '\"'; linelength++;
       }
       break;
     }
   }
-  putc('\"', code_file);
+  *o++ = '\"';
+  fwrite(buf, 1, o-buf, code_file);
 }
 
 // write a C string, quoting characters if necessary:
@@ -256,17 +315,27 @@ void write_cdata(const char *s, int length) {
   const unsigned char *w = (const unsigned char *)s;
   const unsigned char *e = w+length;
   int linelength = 1;
-  putc('{', code_file);
+  // format the numbers into a buffer, fprintf() per byte is slow for
+  // large images
+  char buf[1024], *b = buf;
+  *b++ = '{';
   for (; w < e;) {
     unsigned char c = *w++;
     if (c>99) linelength += 4;
     else if (c>9) linelength += 3;
     else linelength += 2;
-    if (linelength >= 77) {fputs("\n",code_file); linelength = 0;}
-    fprintf(code_file, "%d", c);
-    if (w<e) putc(',', code_file);
+    if (linelength >= 77) {*b++ = '\n'; linelength = 0;}
+    if (c>99) *b++ = '0' + c/100;
+    if (c>9) *b++ = '0' + c/10%10;
+    *b++ = '0' + c%10;
+    if (w<e) *b++ = ',';
+    if (b > buf+sizeof(buf)-8) {
+      fwrite(buf, 1, b-buf, code_file);
+      b = buf;
+    }
   }
-  putc('}', code_file);
+  *b++ = '}';
+  fwrite(buf, 1, b-buf, code_file);
 }
 
 void vwrite_c(const char* format, va_list args) {
@@ -375,7 +444,8 @@ int write_code(const char *s, const char *t) {
   if (write_sourceview)
     filemode = "wb";
   write_number++;
-  delete id_root; id_root = 0;
+  id_clear(ids);
+  id_clear(id_aliases);
   indentation = 0;
   current_class = 0L;
   current_widget_class = 0L;
@@ -383,12 +453,14 @@ int write_code(const char *s, const char *t) {
   else {
     FILE *f = fl_fopen(s, filemode);
     if (!f) return 0;
+    setvbuf(f, NULL, _IOFBF, WRITE_BUFFER_SIZE);
     code_file = f;
   }
   if (!t) header_file = stdout;
   else {
     FILE *f = fl_fopen(t, filemode);
     if (!f) {fclose(code_file); return 0;}
+    setvbuf(f, NULL, _IOFBF, WRITE_BUFFER_SIZE);
     header_file = f;
   }
   // if the first entry in the Type tree is a comment, then it is probably
@@ -468,7 +540,7 @@ int write_code(const char *s, const char *t) {
     p = write_code(p);
   }
 
-  delete included_root; included_root = 0;
+  id_clear(included);
 
   if (!s) return 1;
 
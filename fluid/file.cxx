@@ -122,26 +122,66 @@ void write_close(int n) {
 ////////////////////////////////////////////////////////////////
 // BASIC FILE READING:
 
-static FILE *fin;
+// The whole file is read into memory by open_read() and the tokenizer
+// below walks through it with a pointer, which is much faster than
+// reading every single character with getc().
+
+static char *fbuf;              // file contents
+static const char *fptr;        // current read position
+static const char *fend;        // end of file contents
+static int reading;             // set while a file is open for reading
 static int lineno;
 static const char *fname;
 
+// read the next character, or -1 at the end of the file
+static inline int read_char() {
+  return fptr < fend ? (uchar)*fptr++ : -1;
+}
+
+// put back the last character returned by read_char()
+static inline void unread_char(int x) {
+  if (x >= 0) fptr--;
+}
+
 int open_read(const char *s) {
   lineno = 1;
-  if (!s) {fin = stdin; fname = "stdin"; return 1;}
-  FILE *f = fl_fopen(s,"r");
-  if (!f) return 0;
-  fin = f;
-  fname = s;
+  FILE *f;
+  if (!s) {
+    f = stdin;
+    fname = "stdin";
+  } else {
+    f = fl_fopen(s,"r");
+    if (!f) return 0;
+    fname = s;
+  }
+  size_t size = 0, alloc = 0;
+  for (;;) {
+    if (size == alloc) {
+      alloc = alloc ? 2*alloc : 0x10000;
+      fbuf = (char*)realloc(fbuf, alloc);
+    }
+    size_t n = fread(fbuf+size, 1, alloc-size, f);
+    if (!n) break;
+    size += n;
+  }
+  int err = ferror(f);
+  if (f != stdin) fclose(f);
+  if (err) {
+    free(fbuf);
+    fbuf = 0;
+    return 0;
+  }
+  fptr = fbuf;
+  fend = fbuf+size;
+  reading = 1;
   return 1;
 }
 
 int close_read() {
-  if (fin != stdin) {
-    int x = fclose(fin);
-    fin = 0;
-    return x >= 0;
-  }
+  free(fbuf);
+  fbuf = 0;
+  fptr = fend = 0;
+  reading = 0;
   return 1;
 }
 
@@ -150,7 +190,7 @@ int close_read() {
 void read_error(const char *format, ...) {
   va_list args;
   va_start(args, format);
-  if (!fin) {
+  if (!reading) {
     char buffer[1024];
     vsnprintf(buffer, sizeof(buffer), format, args);
     fl_message("%s", buffer);
@@ -172,7 +212,7 @@ static int hexdigit(int x) {
 
 static int read_quoted() {      // read whatever character is after a \ .
   int c,d,x;
-  switch(c = fgetc(fin)) {
+  switch(c = read_char()) {
   case '\n': lineno++; return -1;
   case 'a' : return('\a');
   case 'b' : return('\b');
@@ -183,9 +223,9 @@ static int read_quoted() {      // read whatever character is after a \ .
   case 'v' : return('\v');
   case 'x' :    /* read hex */
     for (c=x=0; x<3; x++) {
-      int ch = fgetc(fin);
+      int ch = read_char();
       d = hexdigit(ch);
-      if (d > 15) {ungetc(ch,fin); break;}
+      if (d > 15) {unread_char(ch); break;}
       c = (c<<4)+d;
     }
     break;
@@ -193,9 +233,9 @@ static int read_quoted() {      // read whatever character is after a \ .
     if (c<'0' || c>'7') break;
     c -= '0';
     for (x=0; x<2; x++) {
-      int ch = fgetc(fin);
+      int ch = read_char();
       d = hexdigit(ch);
-      if (d>7) {ungetc(ch,fin); break;}
+      if (d>7) {unread_char(ch); break;}
       c = (c<<3)+d;
     }
     break;
@@ -231,11 +271,11 @@ const char *read_word(int wantbrace) {
 
   // skip all the whitespace before it:
   for (;;) {
-    x = getc(fin);
-    if (x < 0 && feof(fin)) {   // eof
+    x = read_char();
+    if (x < 0) {                // eof
       return 0;
     } else if (x == '#') {      // comment
-      do x = getc(fin); while (x >= 0 && x != '\n');
+      do x = read_char(); while (x >= 0 && x != '\n');
       lineno++;
       continue;
     } else if (x == '\n') {
@@ -253,10 +293,10 @@ const char *read_word(int wantbrace) {
     int length = 0;
     int nesting = 0;
     for (;;) {
-      x = getc(fin);
+      x = read_char();
       if (x<0) {read_error("Missing '}'"); break;}
       else if (x == '#') { // embedded comment
-        do x = getc(fin); while (x >= 0 && x != '\n');
+        do x = read_char(); while (x >= 0 && x != '\n');
         lineno++;
         continue;
       } else if (x == '\n') lineno++;
@@ -284,9 +324,9 @@ const char *read_word(int wantbrace) {
       else if (x<0 || isspace(x & 255) || x=='{' || x=='}' || x=='#') break;
       buffer[length++] = x;
       expand_buffer(length);
-      x = getc(fin);
+      x = read_char();
     }
-    ungetc(x, fin);
+    unread_char(x);
     buffer[length] = 0;
     return buffer;
 
@@ -316,6 +356,8 @@ int write_file(const char *filename, int selected_only) {
     write_string("\ndo_not_include_H_from_C");
   if(use_FL_COMMAND)
     write_string("\nuse_FL_COMMAND");
+  if(embed_compressed_images)
+    write_string("\nembed_compressed_images");
   if (i18n_type) {
     write_string("\ni18n_type %d", i18n_type);
     write_string("\ni18n_include %s", i18n_include);
@@ -401,6 +443,10 @@ static void read_children(Fl_Type *p, int paste) {
       use_FL_COMMAND=1;
       goto CONTINUE;
     }
+    if (!strcmp(c,"embed_compressed_images")) {
+      embed_compressed_images=1;
+      goto CONTINUE;
+    }
     if (!strcmp(c,"i18n_type")) {
       i18n_type = atoi(read_word());
       goto CONTINUE;
@@ -518,8 +564,8 @@ int read_fdesign_line(const char*& name, const char*& value) {
   int x;
   // find a colon:
   for (;;) {
-    x = getc(fin);
-    if (x < 0 && feof(fin)) return 0;
+    x = read_char();
+    if (x < 0) return 0;
     if (x == '\n') {length = 0; continue;} // no colon this line...
     if (!isspace(x & 255)) {
       buffer[length++] = x;
@@ -532,17 +578,17 @@ int read_fdesign_line(const char*& name, const char*& value) {
 
   // skip to start of value:
   for (;;) {
-    x = getc(fin);
-    if ((x < 0 && feof(fin)) || x == '\n' || !isspace(x & 255)) break;
+    x = read_char();
+    if (x < 0 || x == '\n' || !isspace(x & 255)) break;
   }
 
   // read the value:
   for (;;) {
     if (x == '\\') {x = read_quoted(); if (x<0) continue;}
-    else if (x == '\n') break;
+    else if (x < 0 || x == '\n') break;
     buffer[length++] = x;
     expand_buffer(length);
-    x = getc(fin);
+    x = read_char();
   }
   buffer[length] = 0;
   name = buffer;
@@ -0,0 +1,124 @@
+#!/bin/sh
+#
+# Code generation benchmark for the Fast Light Tool Kit (FLTK) UI designer.
+#
+# Copyright 1998-2020 by Bill Spitzak and others.
+#
+# This library is free software. Distribution and use rights are outlined in
+# the file "COPYING" which should have been included with this file.  If this
+# file is missing or damaged, see the license at:
+#
+#      https://www.fltk.org/COPYING.php
+#
+# Please see the following page on how to report bugs and issues:
+#
+#      https://www.fltk.org/bugs.php
+#
+
+#
+# Notes to developers:
+#
+# This script writes a synthetic project with many widgets to a temporary
+# directory and measures how long "fluid -c" takes to generate its code.
+# The project has 30 functions with one window each, and the widgets are
+# distributed over 20 groups per window. Widgets share a few labels and
+# callbacks, so that many generated identifiers collide, and every third
+# widget has a name.
+#
+# Usage:
+#
+# $ misc/fluid_benchmark.sh path/to/fluid [widgets [runs]]
+#
+#   widgets     total number of widgets, default 30000
+#   runs        number of "fluid -c" runs, default 3
+#
+# Set KEEP=1 to keep the generated files for comparing the output of
+# different versions of fluid, e.g.
+#
+# $ KEEP=1 misc/fluid_benchmark.sh old/bin/fluid
+# $ KEEP=1 misc/fluid_benchmark.sh new/bin/fluid
+# $ diff /tmp/fluid_benchmark.1234/bench.cxx /tmp/fluid_benchmark.5678/bench.cxx
+#
+
+if test $# -lt 1; then
+  echo "Usage: $0 path/to/fluid [widgets [runs]]"
+  exit 1
+fi
+
+fluid=$1
+widgets=${2:-30000}
+runs=${3:-3}
+
+case "$fluid" in
+  /*) ;;
+  *) fluid=`pwd`/$fluid ;;
+esac
+
+if test ! -x "$fluid"; then
+  echo "$0: $fluid is not executable"
+  exit 1
+fi
+
+# Current time in seconds, with fractions if date supports them
+now() {
+  date +%s.%N | sed -e 's/\.N$//' -e 's/\.%N$//'
+}
+
+dir=${TMPDIR:-/tmp}/fluid_benchmark.$$
+mkdir -p "$dir" || exit 1
+
+# Write the project...
+awk -v widgets="$widgets" 'BEGIN {
+  funcs = 30; groups = 20;
+  per_group = int((widgets + funcs * groups - 1) / (funcs * groups));
+  split("OK Cancel Apply Help Name: Value", labels, " ");
+  split("Fl_Button Fl_Input Fl_Check_Button Fl_Value_Slider", kinds, " ");
+  print "# data file for the Fltk User Interface Designer (fluid)";
+  print "version 1.0400";
+  print "header_name {.h}";
+  print "code_name {.cxx}";
+  n = 0;
+  for (f = 0; f < funcs; f++) {
+    printf("Function {make_window%d()} {open\n} {\n", f);
+    print "  Fl_Window {} {open";
+    print "    xywh {100 100 800 600} type Double visible";
+    print "  } {";
+    for (g = 0; g < groups; g++) {
+      print "    Fl_Group {} {open";
+      print "      xywh {0 0 800 600}";
+      print "    } {";
+      for (i = 0; i < per_group && n < widgets; i++) {
+        n++;
+        printf("      %s %s {\n", kinds[n % 4 + 1], (i % 3) ? "{}" : "w" n);
+        printf("        label {%s}", labels[(n * 7) % 6 + 1]);
+        if (i % 2) printf(" callback {puts(\"x\");}");
+        printf("\n        xywh {%d %d 80 20} tooltip {Tip \"%d\" here}\n",
+               (i % 10) * 80, int(i / 10) * 25, n);
+        print "      }";
+      }
+      print "    }";
+    }
+    print "  }";
+    print "}";
+  }
+}' > "$dir/bench.fl" || exit 1
+
+echo "Project: $dir/bench.fl, $widgets widgets, `wc -c < "$dir/bench.fl"` bytes"
+
+# Generate the code...
+cd "$dir" || exit 1
+i=0
+while test $i -lt $runs; do
+  i=`expr $i + 1`
+  start=`now`
+  "$fluid" -c bench.fl || exit 1
+  end=`now`
+  secs=`awk -v start=$start -v end=$end 'BEGIN { printf("%.2f", end - start) }'`
+  echo "Run $i: $secs seconds"
+done
+echo "Code: `wc -c < bench.cxx` bytes"
+
+cd /
+if test "x$KEEP" = x; then
+  rm -rf "$dir"
+fi
@@ -1559,6 +1559,8 @@ void Fl_Widget::damage(uchar fl, int X, int Y, int W, int H) {
   Fl_Widget* wi = this;
   // mark all parent widgets between this and window with FL_DAMAGE_CHILD:
   while (wi->type() < FL_WINDOW) {
+    if (!wi->damage_ && wi->parent_ && wi->parent_->as_group())
+      wi->parent_->child_damaged(wi);
     wi->damage_ |= fl;
     wi = wi->parent();
     if (!wi) return;
@@ -26,6 +26,7 @@
 #include <FL/Fl.H>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 //
 // BMP definitions...
@@ -95,6 +96,31 @@ Fl_BMP_Image::Fl_BMP_Image(const char *imagename, const unsigned char *data)
   }
 }
 
+/**
+ \brief Read a BMP image of known size from memory.
+
+ Unlike Fl_BMP_Image(const char *imagename, const unsigned char *data) this
+ constructor never reads beyond the given \p datasize, missing pixel data
+ of a truncated image is read as zeros.
+
+ \param[in] imagename  A name given to this image or NULL
+ \param[in] data       Pointer to the start of the BMP image in memory
+ \param[in] datasize   Size of the BMP image in memory in bytes
+
+ \see Fl_BMP_Image::Fl_BMP_Image(const char *imagename, const unsigned char *data)
+ \since 1.4.0
+*/
+Fl_BMP_Image::Fl_BMP_Image(const char *imagename, const unsigned char *data, int datasize)
+: Fl_RGB_Image(0,0,0)
+{
+  Fl_Image_Reader rdr;
+  if (rdr.open(imagename, data, datasize) == -1) {
+    ld(ERR_FILE_ACCESS);
+  } else {
+    load_bmp_(rdr);
+  }
+}
+
 /*
  This method reads BMP image data and creates an RGB or RGBA image. The BMP
  format supports only 1 bit for alpha. To avoid code duplication, we use
@@ -120,6 +146,9 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
   uchar   bit,          // Bit in image
           byte;         // Byte in image
   uchar   *ptr;         // Pointer into pixels
+  uchar   *row = 0;     // Row buffer for uncompressed data
+  const uchar *src;     // Pointer into row buffer
+  int     row_bytes = 0;// Bytes per row including alignment
   uchar   colormap[256][3]; // Colormap
   uchar   havemask;     // Single bit mask follows image data
   int     use_5_6_5;    // Use 5:6:5 for R:G:B channels in 16 bit images
@@ -191,10 +220,8 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
   //         w(), h(), depth, compression, colors_used, repcount);
 
   // Skip remaining header bytes...
-  while (repcount > 0) {
-    rdr.read_byte();
-    repcount --;
-  }
+  if (repcount > 0)
+    rdr.skip(repcount);
 
   // Check header data...
   if (!w() || !h() || !depth) {
@@ -243,6 +270,14 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
   byte  = 0;
   temp  = 0;
 
+  // Rows with 8 or more bits per pixel that are not run-length encoded are
+  // read as a whole and converted from the row buffer...
+  if (depth > 8 || (depth == 8 && compression != BI_RLE8)) {
+    row_bytes = w() * (depth / 8);
+    if (depth != 8 || !compression) row_bytes = (row_bytes + 3) & ~3;
+    row = new uchar[row_bytes];
+  }
+
   if (row_order < 0) {
     start_y = h() - 1;
     end_y   = -1;
@@ -254,6 +289,12 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
   for (y = start_y; y != end_y; y += row_order) {
     ptr = (uchar *)array + y * w() * d();
 
+    if (row) {
+      int n = rdr.read_bytes(row, row_bytes);
+      if (n < row_bytes) memset(row + n, 0, row_bytes - n);
+    }
+    src = row;
+
     switch (depth)
     {
       case 1 : // Bitmap
@@ -297,6 +338,7 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
 
               if ((repcount = rdr.read_byte()) == 0) {
                 if ((repcount = rdr.read_byte()) == 0) {
+                  if (rdr.eof()) break; // truncated image
                   // End of line...
                   x ++;
                   continue;
@@ -353,13 +395,16 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
         break;
 
       case 8 : // 256-color
-        for (x = w(); x > 0; x --) {
-          // Get a new repcount as needed...
-          if (compression != BI_RLE8) {
-            repcount = 1;
-            color = -1;
+        if (row) {
+          for (x = w(); x > 0; x --, src ++, ptr += bDepth) {
+            ptr[0] = colormap[*src][2];
+            ptr[1] = colormap[*src][1];
+            ptr[2] = colormap[*src][0];
           }
+          break;
+        }
 
+        for (x = w(); x > 0; x --) {
           if (repcount == 0) {
             while (align > 0) {
               align --;
@@ -368,6 +413,7 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
 
             if ((repcount = rdr.read_byte()) == 0) {
               if ((repcount = rdr.read_byte()) == 0) {
+                if (rdr.eof()) break; // truncated image
                 // End of line...
                 x ++;
                 continue;
@@ -400,18 +446,11 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
           *ptr++ = colormap[temp][0];
           if (havemask) ptr++;
         }
-
-        if (!compression) {
-          // Read remaining bytes to align to 32 bits...
-          for (temp = w(); temp & 3; temp ++) {
-            rdr.read_byte();
-          }
-        }
         break;
 
       case 16 : // 16-bit 5:5:5 or 5:6:5 RGB
-        for (x = w(); x > 0; x --, ptr += bDepth) {
-          uchar b = rdr.read_byte(), a = rdr.read_byte() ;
+        for (x = w(); x > 0; x --, src += 2, ptr += bDepth) {
+          uchar b = src[0], a = src[1];
           if (use_5_6_5) {
             ptr[2] = (uchar)(( b << 3 ) & 0xf8);
             ptr[1] = (uchar)(((a << 5) & 0xe0) | ((b >> 3) & 0x1c));
@@ -422,37 +461,29 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
             ptr[0] = (uchar)((a<<1) & 0xf8);
           }
         }
-
-        // Read remaining bytes to align to 32 bits...
-        for (temp = w() * 2; temp & 3; temp ++) {
-          rdr.read_byte();
-        }
         break;
 
       case 24 : // 24-bit RGB
-        for (x = w(); x > 0; x --, ptr += bDepth) {
-          ptr[2] = rdr.read_byte();
-          ptr[1] = rdr.read_byte();
-          ptr[0] = rdr.read_byte();
-        }
-
-        // Read remaining bytes to align to 32 bits...
-        for (temp = w() * 3; temp & 3; temp ++) {
-          rdr.read_byte();
+        for (x = w(); x > 0; x --, src += 3, ptr += bDepth) {
+          ptr[0] = src[2];
+          ptr[1] = src[1];
+          ptr[2] = src[0];
         }
         break;
 
       case 32 : // 32-bit RGBA
-        for (x = w(); x > 0; x --, ptr += bDepth) {
-          ptr[2] = rdr.read_byte();
-          ptr[1] = rdr.read_byte();
-          ptr[0] = rdr.read_byte();
-          ptr[3] = rdr.read_byte();
+        for (x = w(); x > 0; x --, src += 4, ptr += 4) {
+          ptr[0] = src[2];
+          ptr[1] = src[1];
+          ptr[2] = src[0];
+          ptr[3] = src[3];
         }
         break;
     }
   }
 
+  delete[] row;
+
   if (havemask) {
     for (y = h() - 1; y >= 0; y --) {
       ptr = (uchar *)array + y * w() * d() + 3;
@@ -21,6 +21,8 @@
 #include <FL/Fl_Widget.H>
 #include <FL/Fl_Browser_.H>
 #include <FL/fl_draw.H>
+#include <FL/Fl_Device.H>
+#include <FL/Fl_Graphics_Driver.H>
 
 
 // This is the base class for browsers.  To be useful it must be
@@ -124,7 +126,7 @@ void Fl_Browser_::resize(int X, int Y, int W, int H) {
 void Fl_Browser_::redraw_line(void* item) {
   if (!redraw1 || redraw1 == item) {redraw1 = item; damage(FL_DAMAGE_EXPOSE);}
   else if (!redraw2 || redraw2 == item) {redraw2 = item; damage(FL_DAMAGE_EXPOSE);}
-  else damage(FL_DAMAGE_SCROLL);
+  else redraw_lines();
 }
 
 // Figure out top() based on position():
@@ -195,7 +197,7 @@ void Fl_Browser_::position(int pos) {
   if (pos < 0) pos = 0;
   if (pos == position_) return;
   position_ = pos;
-  if (pos != real_position_) redraw_lines();
+  if (pos != real_position_) damage(FL_DAMAGE_SCROLL);
 }
 
 /**
@@ -210,7 +212,7 @@ void Fl_Browser_::hposition(int pos) {
   if (pos < 0) pos = 0;
   if (pos == hposition_) return;
   hposition_ = pos;
-  if (pos != real_hposition_) redraw_lines();
+  if (pos != real_hposition_) damage(FL_DAMAGE_SCROLL);
 }
 
 // Tell whether item is currently displayed:
@@ -349,6 +351,7 @@ J1:
     top_ = item_first(); real_position_ = offset_ = 0;
     if (scrollbar.visible()) {
       scrollbar.clear_visible();
+      lines_changed_ = 1;
       clear_damage((uchar)(damage()|FL_DAMAGE_SCROLL));
     }
   }
@@ -364,6 +367,7 @@ J1:
     real_hposition_ = 0;
     if (hscrollbar.visible()) {
       hscrollbar.clear_visible();
+      lines_changed_ = 1;
       clear_damage((uchar)(damage()|FL_DAMAGE_SCROLL));
     }
   }
@@ -382,6 +386,7 @@ J1:
     top_ = item_first(); real_position_ = offset_ = 0;
     if (scrollbar.visible()) {
       scrollbar.clear_visible();
+      lines_changed_ = 1;
       clear_damage((uchar)(damage()|FL_DAMAGE_SCROLL));
     }
   }
@@ -389,38 +394,31 @@ J1:
   bbox(X, Y, W, H);
 
   fl_push_clip(X, Y, W, H);
-  // for each line, draw it if full redraw or scrolled.  Erase background
-  // if not a full redraw or if it is selected:
-  void* l = top();
-  int yy = -offset_;
-  for (; l && yy < H; l = item_next(l)) {
-    int hh = item_height(l);
-    if (hh <= 0) continue;
-    if ((damage()&(FL_DAMAGE_SCROLL|FL_DAMAGE_ALL)) || l == redraw1 || l == redraw2) {
-      if (item_selected(l)) {
-        fl_color(active_r() ? selection_color() : fl_inactive(selection_color()));
-        fl_rectf(X, yy+Y, W, hh);
-      } else if (!(damage()&FL_DAMAGE_ALL)) {
-        fl_push_clip(X, yy+Y, W, hh);
-        draw_box(box() ? box() : FL_DOWN_BOX, x(), y(), w(), h(), color());
-        fl_pop_clip();
-      }
-      item_draw(l, X-hposition_, yy+Y, W+hposition_, hh);
-      if (l == selection_ && Fl::focus() == this) {
-        draw_box(FL_BORDER_FRAME, X, yy+Y, W, hh, color());
-        draw_focus(FL_NO_BOX, X, yy+Y, W+1, hh+1);
-      }
-      int ww = item_width(l);
-      if (ww > max_width) {max_width = ww; max_width_item = l;}
+  // if the list was only scrolled, move the lines that stay visible and
+  // draw the exposed area. This is not possible if lines changed or
+  // with fractional scaling, where copying can leave gaps:
+  int scrolled = 0;
+  if ((damage() & FL_DAMAGE_SCROLL) && !(damage() & FL_DAMAGE_ALL) && !lines_changed_ &&
+      (drawn_position_ != real_position_ || drawn_hposition_ != hposition_)) {
+    float s = Fl_Surface_Device::surface()->driver()->scale();
+    if (s == int(s)) {
+      fl_scroll(X, Y, W, H, drawn_hposition_ - hposition_,
+                drawn_position_ - real_position_, scroll_draw_cb, this);
+      scrolled = 1;
     }
-    yy += hh;
   }
-  // erase the area below last line:
-  if (!(damage()&FL_DAMAGE_ALL) && yy < H) {
-    fl_push_clip(X, yy+Y, W, H-yy);
-    draw_box(box() ? box() : FL_DOWN_BOX, x(), y(), w(), h(), color());
-    fl_pop_clip();
+  // the focus frame does not move with the contents, hence the focused
+  // line must be drawn again if the list was scrolled horizontally:
+  if (scrolled && drawn_hposition_ != hposition_ && selection_ && Fl::focus() == this &&
+      selection_ != redraw1 && selection_ != redraw2) {
+    if (!redraw1) redraw1 = selection_;
+    else if (!redraw2) redraw2 = selection_;
+    else scrolled = 0; // draw all lines
   }
+  // draw all lines if full redraw or scrolled without copying, otherwise
+  // only the lines changed by redraw_line():
+  draw_lines(X, Y, W, H, Y, H,
+             !scrolled && (damage() & (FL_DAMAGE_SCROLL|FL_DAMAGE_ALL)));
   fl_pop_clip();
 
   fl_push_clip(x(),y(),w(),h());                // STR# 2886
@@ -474,6 +472,54 @@ J1:
   }
 
   real_hposition_ = hposition_;
+  drawn_position_ = real_position_;
+  drawn_hposition_ = hposition_;
+  lines_changed_ = 0;
+  fl_pop_clip();
+}
+
+// Draw the lines intersecting the vertical range CY..CY+CH of the list
+// area X,Y,W,H, or only the lines changed by redraw_line() if all is 0.
+// Erase background if not a full redraw or if the line is selected:
+void Fl_Browser_::draw_lines(int X, int Y, int W, int H, int CY, int CH, int all) {
+  void* l = top();
+  int yy = -offset_;
+  for (; l && yy < H && yy+Y < CY+CH; l = item_next(l)) {
+    int hh = item_height(l);
+    if (hh <= 0) continue;
+    if ((all && yy+Y+hh > CY) || l == redraw1 || l == redraw2) {
+      if (item_selected(l)) {
+        fl_color(active_r() ? selection_color() : fl_inactive(selection_color()));
+        fl_rectf(X, yy+Y, W, hh);
+      } else if (!(damage()&FL_DAMAGE_ALL)) {
+        fl_push_clip(X, yy+Y, W, hh);
+        draw_box(box() ? box() : FL_DOWN_BOX, x(), y(), w(), h(), color());
+        fl_pop_clip();
+      }
+      item_draw(l, X-hposition_, yy+Y, W+hposition_, hh);
+      if (l == selection_ && Fl::focus() == this) {
+        draw_box(FL_BORDER_FRAME, X, yy+Y, W, hh, color());
+        draw_focus(FL_NO_BOX, X, yy+Y, W+1, hh+1);
+      }
+      int ww = item_width(l);
+      if (ww > max_width) {max_width = ww; max_width_item = l;}
+    }
+    yy += hh;
+  }
+  // erase the area below last line:
+  if (!(damage()&FL_DAMAGE_ALL) && yy < H && yy+Y < CY+CH) {
+    fl_push_clip(X, yy+Y, W, H-yy);
+    draw_box(box() ? box() : FL_DOWN_BOX, x(), y(), w(), h(), color());
+    fl_pop_clip();
+  }
+}
+
+// Draw the area exposed by fl_scroll() in draw()
+void Fl_Browser_::scroll_draw_cb(void *v, int X, int Y, int W, int H) {
+  Fl_Browser_ *b = (Fl_Browser_ *)v;
+  int bx, by, bw, bh; b->bbox(bx, by, bw, bh);
+  fl_push_clip(X, Y, W, H);
+  b->draw_lines(bx, by, bw, bh, Y, H, 1);
   fl_pop_clip();
 }
 
@@ -976,6 +1022,8 @@ Fl_Browser_::Fl_Browser_(int X, int Y, int W, int H, const char* L)
   max_width_item = 0;
   scrollbar_size_ = 0;
   redraw1 = redraw2 = 0;
+  drawn_position_ = drawn_hposition_ = 0;
+  lines_changed_ = 1;
   end();
 }
 
@@ -114,6 +114,49 @@ static void draw_horbarchart(int x,int y,int w,int h,
               FL_ALIGN_RIGHT);
 }
 
+static void draw_decimated(int type, int x, int zeroh,
+                           int numb, FL_CHART_ENTRY entries[],
+                           double incr, double bwidth, Fl_Color textcolor)
+/* Draws the values of a line, fill, or spike chart with less than one pixel
+   per value. All values in a pixel column are drawn as a vertical line from
+   their minimum to their maximum, lines connect the last value of a column
+   with the first value of the next one. */
+{
+  int i = 0, lastx = 0, lasty = 0;
+  while (i < numb) {
+    int xx = x + (int)rint((i+.5)*bwidth);
+    float lo = entries[i].val, hi = lo;
+    int j = i;
+    while (j+1 < numb && x + (int)rint((j+1.5)*bwidth) == xx) {
+      j++;
+      if (entries[j].val < lo) lo = entries[j].val;
+      if (entries[j].val > hi) hi = entries[j].val;
+    }
+    int ylo = zeroh - (int)rint(lo*incr);
+    int yhi = zeroh - (int)rint(hi*incr);
+    int yy0 = zeroh - (int)rint(entries[i].val*incr);
+    if (type == FL_SPIKE_CHART) {
+      fl_color((Fl_Color)entries[i].col);
+      fl_line(xx, yhi < zeroh ? yhi : zeroh, xx, ylo > zeroh ? ylo : zeroh);
+    } else {
+      if (type == FL_FILLED_CHART) {
+        int top = yhi < zeroh ? yhi : zeroh;
+        int bottom = ylo > zeroh ? ylo : zeroh;
+        fl_color((Fl_Color)entries[i].col);
+        fl_rectf(xx, top, 1, bottom - top + 1);
+        fl_color(textcolor);
+      } else {
+        fl_color((Fl_Color)entries[i ? i-1 : 0].col);
+      }
+      if (i) fl_line(lastx, lasty, xx, yy0);
+      if (ylo != yhi) fl_line(xx, yhi, xx, ylo);
+    }
+    lastx = xx;
+    lasty = zeroh - (int)rint(entries[j].val*incr);
+    i = j + 1;
+  }
+}
+
 static void draw_linechart(int type, int x,int y,int w,int h,
                            int numb, FL_CHART_ENTRY entries[],
                            double min, double max, int autosize, int maxnumb,
@@ -128,7 +171,10 @@ static void draw_linechart(int type, int x,int y,int w,int h,
   else incr = (h-2.0*lh)/ (max-min);
   int zeroh = (int)rint(y+h-lh+min * incr);
   double bwidth = w/double(autosize?numb:maxnumb);
-  /* Draw the values */
+  if (numb > w) {
+    /* More values than pixels: draw each pixel column only once */
+    draw_decimated(type, x, zeroh, numb, entries, incr, bwidth, textcolor);
+  } else
   for (i=0; i<numb; i++) {
       int x0 = x + (int)rint((i-.5)*bwidth);
       int x1 = x + (int)rint((i+.5)*bwidth);
@@ -159,6 +205,7 @@ static void draw_linechart(int type, int x,int y,int w,int h,
   fl_line(x,zeroh,x+w,zeroh);
   /* Draw the labels */
   for (i=0; i<numb; i++)
+    if (entries[i].str[0])
       fl_draw(entries[i].str,
               x+(int)rint((i+.5)*bwidth), zeroh - (int)rint(entries[i].val*incr),0,0,
               entries[i].val>=0 ? FL_ALIGN_BOTTOM : FL_ALIGN_TOP);
@@ -231,11 +278,13 @@ void Fl_Chart::draw() {
 
     ww--; hh--; // adjust for line thickness
 
+    FL_CHART_ENTRY *e = entries + firstnumb;
+
     if (min >= max) {
         min = max = 0.0;
         for (int i=0; i<numb; i++) {
-            if (entries[i].val < min) min = entries[i].val;
-            if (entries[i].val > max) max = entries[i].val;
+            if (e[i].val < min) min = e[i].val;
+            if (e[i].val > max) max = e[i].val;
         }
     }
 
@@ -244,22 +293,22 @@ void Fl_Chart::draw() {
     switch (type()) {
     case FL_BAR_CHART:
         ww++; // makes the bars fill box correctly
-        draw_barchart(xx,yy,ww,hh, numb, entries, min, max,
+        draw_barchart(xx,yy,ww,hh, numb, e, min, max,
                         autosize(), maxnumb, textcolor());
         break;
     case FL_HORBAR_CHART:
         hh++; // makes the bars fill box correctly
-        draw_horbarchart(xx,yy,ww,hh, numb, entries, min, max,
+        draw_horbarchart(xx,yy,ww,hh, numb, e, min, max,
                         autosize(), maxnumb, textcolor());
         break;
     case FL_PIE_CHART:
-        draw_piechart(xx,yy,ww,hh,numb,entries,0, textcolor());
+        draw_piechart(xx,yy,ww,hh,numb,e,0, textcolor());
         break;
     case FL_SPECIALPIE_CHART:
-        draw_piechart(xx,yy,ww,hh,numb,entries,1,textcolor());
+        draw_piechart(xx,yy,ww,hh,numb,e,1,textcolor());
         break;
     default:
-        draw_linechart(type(),xx,yy,ww,hh, numb, entries, min, max,
+        draw_linechart(type(),xx,yy,ww,hh, numb, e, min, max,
                         autosize(), maxnumb, textcolor());
         break;
     }
@@ -287,6 +336,7 @@ Fl_Widget(X,Y,W,H,L) {
   numb       = 0;
   maxnumb    = 0;
   sizenumb   = FL_CHART_MAX;
+  firstnumb  = 0;
   autosize_  = 1;
   min = max  = 0;
   textfont_  = FL_HELVETICA;
@@ -307,6 +357,7 @@ Fl_Chart::~Fl_Chart() {
  */
 void Fl_Chart::clear() {
   numb = 0;
+  firstnumb = 0;
   min = max = 0;
   redraw();
 }
@@ -319,27 +370,84 @@ void Fl_Chart::clear() {
   \param[in] col optional data color
  */
 void Fl_Chart::add(double val, const char *str, unsigned col) {
-  /* Allocate more entries if required */
-  if (numb >= sizenumb) {
-    sizenumb += FL_CHART_MAX;
-    entries = (FL_CHART_ENTRY *)realloc(entries, sizeof(FL_CHART_ENTRY) * (sizenumb + 1));
-  }
-  // Shift entries as needed
+  // Drop the oldest entry as needed
   if (numb >= maxnumb && maxnumb > 0) {
-    memmove(entries, entries + 1, sizeof(FL_CHART_ENTRY) * (numb - 1));
-    numb --;
+    firstnumb++;
+    numb--;
   }
-  entries[numb].val = float(val);
-  entries[numb].col = col;
+  make_room(1);
+  FL_CHART_ENTRY *e = entries + firstnumb + numb;
+  e->val = float(val);
+  e->col = col;
     if (str) {
-        strlcpy(entries[numb].str,str,FL_CHART_LABEL_MAX + 1);
+        strlcpy(e->str,str,FL_CHART_LABEL_MAX + 1);
     } else {
-        entries[numb].str[0] = 0;
+        e->str[0] = 0;
     }
   numb++;
   redraw();
 }
 
+/**
+  Add \p n data values without labels and with the same color \p col
+  to the chart.
+
+  This is much faster than adding the values one by one, e.g. to stream
+  data into a chart with a maxsize(). If the chart has a maxsize() and
+  \p n exceeds it, only the last maxsize() values are added.
+
+  \param[in] val array of \p n data values
+  \param[in] n number of data values
+  \param[in] col optional data color
+
+  \since 1.4.0
+ */
+void Fl_Chart::add(const double *val, int n, unsigned col) {
+  if (!val || n <= 0) return;
+  if (maxnumb > 0) {
+    if (n > maxnumb) {
+      val += n - maxnumb;
+      n = maxnumb;
+    }
+    // Drop the oldest entries as needed
+    if (numb + n > maxnumb) {
+      firstnumb += numb + n - maxnumb;
+      numb = maxnumb - n;
+    }
+  }
+  make_room(n);
+  FL_CHART_ENTRY *e = entries + firstnumb + numb;
+  for (int i = 0; i < n; i++) {
+    e[i].val = float(val[i]);
+    e[i].col = col;
+    e[i].str[0] = 0;
+  }
+  numb += n;
+  redraw();
+}
+
+/*
+  Makes sure that n more entries (plus one spare entry) fit behind the
+  last entry. The entries start at entries[firstnumb], entries dropped
+  from the front by add() are reused when they are at least as many as
+  the remaining entries, so every entry is moved only once per maxsize()
+  values on average.
+*/
+void Fl_Chart::make_room(int n) {
+  if (firstnumb + numb + n <= sizenumb) return;
+  if (firstnumb >= numb) {
+    memmove(entries, entries + firstnumb, sizeof(FL_CHART_ENTRY) * numb);
+    firstnumb = 0;
+    if (numb + n <= sizenumb) return;
+  }
+  // Allocate more entries
+  int s = 2 * sizenumb;
+  if (maxnumb > 0 && s > 2 * maxnumb) s = 2 * maxnumb;
+  if (s < firstnumb + numb + n) s = firstnumb + numb + n;
+  sizenumb = s;
+  entries = (FL_CHART_ENTRY *)realloc(entries, sizeof(FL_CHART_ENTRY) * (sizenumb + 1));
+}
+
 /**
   Inserts a data value \p val at the given position \p ind.
   Position 1 is the first data value.
@@ -352,20 +460,18 @@ void Fl_Chart::insert(int ind, double val, const char *str, unsigned col) {
   int i;
   if (ind < 1 || ind > numb+1) return;
   /* Allocate more entries if required */
-  if (numb >= sizenumb) {
-    sizenumb += FL_CHART_MAX;
-    entries = (FL_CHART_ENTRY *)realloc(entries, sizeof(FL_CHART_ENTRY) * (sizenumb + 1));
-  }
+  make_room(1);
+  FL_CHART_ENTRY *e = entries + firstnumb;
   // Shift entries as needed
-  for (i=numb; i >= ind; i--) entries[i] = entries[i-1];
+  for (i=numb; i >= ind; i--) e[i] = e[i-1];
   if (numb < maxnumb || maxnumb == 0) numb++;
   /* Fill in the new entry */
-  entries[ind-1].val = float(val);
-  entries[ind-1].col = col;
+  e[ind-1].val = float(val);
+  e[ind-1].col = col;
   if (str) {
-      strlcpy(entries[ind-1].str,str,FL_CHART_LABEL_MAX+1);
+      strlcpy(e[ind-1].str,str,FL_CHART_LABEL_MAX+1);
   } else {
-      entries[ind-1].str[0] = 0;
+      e[ind-1].str[0] = 0;
   }
   redraw();
 }
@@ -380,12 +486,13 @@ void Fl_Chart::insert(int ind, double val, const char *str, unsigned col) {
  */
 void Fl_Chart::replace(int ind,double val, const char *str, unsigned col) {
   if (ind < 1 || ind > numb) return;
-  entries[ind-1].val = float(val);
-  entries[ind-1].col = col;
+  FL_CHART_ENTRY *e = entries + firstnumb;
+  e[ind-1].val = float(val);
+  e[ind-1].col = col;
   if (str) {
-      strlcpy(entries[ind-1].str,str,FL_CHART_LABEL_MAX+1);
+      strlcpy(e[ind-1].str,str,FL_CHART_LABEL_MAX+1);
   } else {
-      entries[ind-1].str[0] = 0;
+      e[ind-1].str[0] = 0;
   }
   redraw();
 }
@@ -407,14 +514,12 @@ void Fl_Chart::bounds(double a, double b) {
   \param[in] m maximum number of data values allowed.
  */
 void Fl_Chart::maxsize(int m) {
-  int i;
   /* Fill in the new number */
   if (m < 0) return;
   maxnumb = m;
-  /* Shift entries if required */
+  /* Drop the oldest entries if required */
   if (numb > maxnumb) {
-      for (i = 0; i<maxnumb; i++)
-          entries[i] = entries[i+numb-maxnumb];
+      firstnumb += numb - maxnumb;
       numb = maxnumb;
       redraw();
   }
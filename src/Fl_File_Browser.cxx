@@ -21,7 +21,11 @@
 //   Fl_File_Browser::item_width()      - Return the width of a list item.
 //   Fl_File_Browser::item_draw()       - Draw a list item.
 //   Fl_File_Browser::Fl_File_Browser() - Create a Fl_File_Browser widget.
+//   Fl_File_Browser::add_files()       - Add files of a directory listing.
 //   Fl_File_Browser::load()            - Load a directory into the browser.
+//   Fl_File_Browser::load_async()      - Start loading a directory.
+//   Fl_File_Browser::load_cancel()     - Stop loading a directory.
+//   Fl_File_Browser::load_timeout_cb() - Add files read by the worker thread.
 //   Fl_File_Browser::filter()          - Set the filename filter.
 //
 
@@ -35,10 +39,14 @@
 #include <FL/fl_draw.H>
 #include <FL/filename.H>
 #include <FL/fl_string.h>
+#include <FL/fl_utf8.h>
 #include <FL/Fl_Image.H>        // icon
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
 #include "flstring.h"
+#include "fl_thread.h"
 
 //
 // FL_BLINE definition from "Fl_Browser.cxx"...
@@ -372,11 +380,17 @@ Fl_File_Browser::Fl_File_Browser(int        X,  // I - Upper-lefthand X coordina
   iconsize_  = (uchar)(3 * textsize() / 2);
   filetype_  = FILES;
   errmsg_    = NULL;
+  load_      = NULL;
+  loaded_    = 0;
+  num_dirs_  = 0;
+  load_cb_   = NULL;
+  load_data_ = NULL;
 }
 
 
 // DTOR
 Fl_File_Browser::~Fl_File_Browser() {
+  load_cancel();
   errmsg(NULL);       // free()s prev errmsg, if any
 }
 
@@ -392,6 +406,276 @@ void Fl_File_Browser::errmsg(const char* emsg) {
 }
 
 
+//
+// Directory listings are read by a worker thread if threads are available,
+// so that Fl_File_Browser::load_async() doesn't block the user interface
+// on huge directories or slow network file systems. The worker thread
+// sorts the directory and determines the types of the files, the main
+// thread adds the files to the browser from a timeout. Since the listing
+// must be sorted, nothing is added before the whole directory was read,
+// only the file types are determined while files are added. Complete
+// listings are kept in a small cache until the modification time of the
+// directory changes.
+//
+
+// Flag in Fl_File_Dir::types for entries that are directories
+#define TYPE_DIRECTORY 0x80
+
+// Number of complete listings kept in the cache
+#define MAX_CACHED_DIRS 8
+
+// Maximum number of files added to the browser per timeout
+#define LOAD_BATCH 2000
+
+// Time between checks for new files from the worker thread
+#define LOAD_INTERVAL 0.02
+
+// A sorted directory listing, shared by the cache and running loads
+struct Fl_File_Dir {
+  char          *directory;     // Directory name
+  Fl_File_Sort_F *sort;         // Sort function used
+  time_t        mtime;          // Modification time of the directory
+  int           typed;          // Non-zero if types contains the file types
+  int           count;          // Number of entries
+  dirent        **files;        // Entries from fl_filename_list()
+  uchar         *types;         // Fl_File_Icon type of each entry
+  int           refs;           // Reference count
+  unsigned long stamp;          // Last use, for LRU eviction
+  Fl_File_Dir   *next;          // Next listing in cache
+};
+
+// A directory being loaded, shared by the browser and the worker thread
+struct Fl_File_Load {
+  char          *directory;     // Directory name
+  Fl_File_Sort_F *sort;         // Sort function to use
+  int           need_types;     // Non-zero if the file types are needed
+  Fl_File_Dir   *dir;           // Listing, once it was read
+  int           num_files;      // Number of entries or error
+  int           ready;          // Number of entries with known type
+  int           done;           // Set when the worker has finished
+  int           cancel;         // Set when the browser lost interest
+  int           refs;           // Reference count
+  char          errmsg[1024];   // Error message if num_files <= 0
+};
+
+static Fl_File_Dir *cached_dirs = 0;
+static unsigned long cache_stamp = 0;
+
+// Protects the cache and running loads
+static Fl_Thread_Mutex load_mutex;
+
+static void lock_loads() { load_mutex.lock(); }
+static void unlock_loads() { load_mutex.unlock(); }
+
+// Release a listing, the caller must hold the lock
+static void release_dir(Fl_File_Dir *d) {
+  if (--d->refs) return;
+  for (int i = 0; i < d->count; i ++) free(d->files[i]);
+  free(d->files);
+  free(d->types);
+  free(d->directory);
+  delete d;
+}
+
+// Release a load, the caller must hold the lock
+static void release_load(Fl_File_Load *l) {
+  if (--l->refs) return;
+  if (l->dir) release_dir(l->dir);
+  free(l->directory);
+  delete l;
+}
+
+// Find an up-to-date listing in the cache, the caller must hold the lock
+static Fl_File_Dir *find_cached_dir(Fl_File_Load *l, time_t mtime) {
+  for (Fl_File_Dir *d = cached_dirs; d; d = d->next)
+    if (d->sort == l->sort && d->mtime == mtime &&
+        d->typed >= l->need_types && !strcmp(d->directory, l->directory)) {
+      d->stamp = ++cache_stamp;
+      d->refs ++;
+      return d;
+    }
+  return 0;
+}
+
+// Add a listing to the cache, replacing an older listing of the same
+// directory or the least recently used listing. The caller must hold the lock.
+static void cache_dir(Fl_File_Dir *d) {
+  Fl_File_Dir **p, **oldest = 0;
+  int n = 0;
+  for (p = &cached_dirs; *p; ) {
+    if ((*p)->sort == d->sort && !strcmp((*p)->directory, d->directory)) {
+      Fl_File_Dir *old = *p;
+      *p = old->next;
+      release_dir(old);
+      continue;
+    }
+    if (!oldest || (*p)->stamp < (*oldest)->stamp) oldest = p;
+    n ++;
+    p = &(*p)->next;
+  }
+  if (n >= MAX_CACHED_DIRS) {
+    Fl_File_Dir *old = *oldest;
+    *oldest = old->next;
+    release_dir(old);
+  }
+  d->stamp = ++cache_stamp;
+  d->refs ++;
+  d->next = cached_dirs;
+  cached_dirs = d;
+}
+
+// Read a directory and the types of its files. This runs in the worker
+// thread, or in the main thread if no threads are available.
+static void read_dir(Fl_File_Load *l) {
+  struct stat   fileinfo;               // Information on directory
+  time_t        mtime;                  // Modification time of directory
+  char          filename[4096];         // Current file
+  dirent        **files;                // Files in directory
+  int           i, n;                   // Looping var, number of files
+
+  mtime = fl_stat(l->directory, &fileinfo) ? 0 : fileinfo.st_mtime;
+
+  lock_loads();
+  Fl_File_Dir *d = mtime ? find_cached_dir(l, mtime) : 0;
+  if (d) {
+    l->dir       = d;
+    l->num_files = d->count;
+    l->ready     = d->count;
+  }
+  unlock_loads();
+
+  if (!d) {
+    char emsg[1024] = "";
+    n = Fl::system_driver()->file_browser_load_directory(l->directory,
+                                                         filename, sizeof(filename),
+                                                         &files, l->sort,
+                                                         emsg, sizeof(emsg));
+    if (n > 0) {
+      d = new Fl_File_Dir;
+      d->directory = fl_strdup(l->directory);
+      d->sort      = l->sort;
+      d->mtime     = mtime;
+      d->typed     = l->need_types;
+      d->count     = n;
+      d->files     = files;
+      d->types     = (uchar *)malloc(n);
+      d->refs      = 1;
+      d->stamp     = 0;
+      d->next      = 0;
+    }
+
+    lock_loads();
+    l->dir       = d;
+    l->num_files = n;
+    if (n <= 0) strlcpy(l->errmsg, emsg, sizeof(l->errmsg));
+    unlock_loads();
+
+    for (i = 0; i < n; i ++) {
+      const char *name = files[i]->d_name;
+      int type = Fl_File_Icon::ANY;
+      int isdir;
+
+      fl_snprintf(filename, sizeof(filename), "%s/%s", l->directory, name);
+
+      // fl_filename_list() appends a slash to directory names, so files
+      // don't need to be checked unless their types are needed anyway...
+      isdir = *name && name[strlen(name) - 1] == '/';
+      if (l->need_types) {
+        type = Fl::system_driver()->file_type(filename);
+        if (type == Fl_File_Icon::DIRECTORY) isdir = 1;
+      }
+      d->types[i] = (uchar)(type | (isdir ? TYPE_DIRECTORY : 0));
+
+      // Publish the progress every now and then...
+      if ((i & 255) == 255 || i == n - 1) {
+        lock_loads();
+        l->ready = i + 1;
+        int cancel = l->cancel;
+        unlock_loads();
+        if (cancel) break;
+      }
+    }
+  }
+
+  lock_loads();
+  // Don't cache listings of directories that were changed in the last few
+  // seconds since the modification time may not change on the next change...
+  if (d && l->ready == d->count && mtime && mtime < time(0) - 2)
+    cache_dir(d);
+  l->done = 1;
+  release_load(l);
+  unlock_loads();
+}
+
+static void load_thread(void *l) {
+  read_dir((Fl_File_Load *)l);
+}
+
+// Create a new load, referenced by the browser and the reader
+static Fl_File_Load *new_load(const char *directory, Fl_File_Sort_F *sort) {
+  Fl_File_Load *l = new Fl_File_Load;
+  l->directory  = fl_strdup(directory);
+  l->sort       = sort;
+  l->need_types = Fl_File_Icon::first() != NULL;
+  l->dir        = 0;
+  l->num_files  = 0;
+  l->ready      = 0;
+  l->done       = 0;
+  l->cancel     = 0;
+  l->refs       = 2;
+  l->errmsg[0]  = '\0';
+  return l;
+}
+
+
+//
+// 'Fl_File_Browser::add_files()' - Add files of a directory listing.
+//
+
+void
+Fl_File_Browser::add_files(dirent      **files, // I - Files in directory
+                           const uchar *types,  // I - File types
+                           int         first,   // I - First file to add
+                           int         last)    // I - Last file to add + 1
+{
+  char          filename[4096];         // Current file
+  Fl_File_Icon  *icon;                  // Icon to use
+  const char    *text;                  // Text of last directory line
+
+
+  // The load callback may have removed lines (e.g. hidden directories)
+  // since the last group was added, so make sure that num_dirs_ still
+  // counts the directories at the top of the list...
+  while (num_dirs_ > 0) {
+    if (num_dirs_ <= size() && (text = this->text(num_dirs_)) != NULL &&
+        *text && text[strlen(text) - 1] == '/') break;
+    num_dirs_ --;
+  }
+
+  for (int i = first; i < last; i ++) {
+    const char *name = files[i]->d_name;
+    if (!strcmp(name, "./")) continue;
+
+    int isdir = types[i] & TYPE_DIRECTORY;
+    if (!isdir && (filetype_ != FILES || !fl_filename_match(name, pattern_)))
+      continue;
+
+    icon = NULL;
+    if (Fl_File_Icon::first() != NULL) {
+      fl_snprintf(filename, sizeof(filename), "%s/%s", directory_, name);
+      icon = Fl_File_Icon::find(filename, types[i] & ~TYPE_DIRECTORY);
+    }
+
+    if (isdir) {
+      num_dirs_ ++;
+      insert(num_dirs_, name, icon);
+    } else {
+      add(name, icon);
+    }
+  }
+}
+
+
 /**
   Loads the specified directory into the browser. If icons have been
   loaded then the correct icon is associated with each file in the list.
@@ -404,17 +688,18 @@ void Fl_File_Browser::errmsg(const char* emsg) {
 
   Return value is the number of filename entries, or 0 if none.
   On error, 0 is returned, and errmsg() has OS error string if non-NULL.
+
+  \see load_async()
 */
 int                                             // O - Number of files loaded
 Fl_File_Browser::load(const char     *directory,// I - Directory to load
                       Fl_File_Sort_F *sort)     // I - Sort function to use
 {
-  int           i;                              // Looping var
   int           num_files;                      // Number of files in directory
-  int           num_dirs;                       // Number of directories in list
   char          filename[4096];                 // Current file
   Fl_File_Icon  *icon;                          // Icon to use
 
+  load_cancel();
   errmsg(NULL); // clear errors first
 
 //  printf("Fl_File_Browser::load(\"%s\")\n", directory);
@@ -422,6 +707,7 @@ Fl_File_Browser::load(const char     *directory,// I - Directory to load
   clear();
 
   directory_ = directory;
+  num_dirs_  = 0;
 
   if (!directory) {
     errmsg("NULL directory specified");
@@ -437,43 +723,147 @@ Fl_File_Browser::load(const char     *directory,// I - Directory to load
       icon = Fl_File_Icon::find("any", Fl_File_Icon::DIRECTORY);
     num_files = Fl::system_driver()->file_browser_load_filesystem(this, filename, (int)sizeof(filename), icon);
   } else {
-    dirent **files;        // Files in in directory
-    char emsg[1024] = "";
+    Fl_File_Load *l = new_load(directory_, sort);
 
-    // Build the file list, check for errors
-    num_files = Fl::system_driver()->file_browser_load_directory(directory_,
-                                                                 filename, sizeof(filename),
-                                                                 &files, sort,
-                                                                 emsg, sizeof(emsg));
-    // printf("Fl_File_Browser::load(dir='%s',filename='%s'): failed, emsg='%s'\n", directory_, filename, emsg);
+    read_dir(l);
 
-    if (num_files <= 0) {
-      errmsg(emsg);
-      return 0;
-    }
+    num_files = l->num_files;
+    if (num_files <= 0) errmsg(l->errmsg);
+    else add_files(l->dir->files, l->dir->types, 0, l->dir->count);
 
-    for (i = 0, num_dirs = 0; i < num_files; i ++) {
-      if (strcmp(files[i]->d_name, "./")) {
-        fl_snprintf(filename, sizeof(filename), "%s/%s", directory_, files[i]->d_name);
-
-        icon = Fl_File_Icon::find(filename);
-        if ((icon && icon->type() == Fl_File_Icon::DIRECTORY) ||
-            Fl::system_driver()->filename_isdir_quick(filename)) {
-          num_dirs ++;
-          insert(num_dirs, files[i]->d_name, icon);
-        } else if (filetype_ == FILES &&
-                   fl_filename_match(files[i]->d_name, pattern_)) {
-          add(files[i]->d_name, icon);
-        }
-      }
+    lock_loads();
+    release_load(l);
+    unlock_loads();
+
+    if (num_files < 0) num_files = 0;
+  }
+
+  return (num_files);
+}
 
-      free(files[i]);
+
+/**
+  Starts loading the specified directory into the browser without
+  blocking the user interface.
+
+  The directory is read and sorted in a separate thread and the files
+  are added to the browser in groups from a timeout while the program
+  waits for events. loading() returns non-zero until all files were
+  added, and the function set with load_callback() is called after each
+  group of files and once more when the directory is complete. The first
+  group is added after the whole directory was read and sorted. If an
+  error occurs, errmsg() is set before the last call of the callback.
+
+  Listings of recently loaded directories are cached until the modification
+  time of the directory changes, so these appear immediately.
+
+  If threads are not available, or directory is "", the directory is
+  loaded like load() does, and the load callback is called once before
+  this method returns.
+
+  The directory string must stay valid while the directory is loaded.
+  Calling load(), load_async(), or load_cancel() stops the current load.
+
+  \param[in] directory directory to load
+  \param[in] sort sort function to be used with fl_filename_list()
+  \return 1 if the directory is loaded, 0 on error
+
+  \since 1.4.0
+*/
+int Fl_File_Browser::load_async(const char     *directory,
+                                Fl_File_Sort_F *sort)
+{
+  load_cancel();
+
+  if (directory && directory[0]) {
+    Fl_File_Load *l = new_load(directory, sort);
+
+    if (fl_start_thread(load_thread, l)) {
+      errmsg(NULL);
+      clear();
+      directory_ = directory;
+      num_dirs_  = 0;
+      load_      = l;
+      loaded_    = 0;
+      Fl::add_timeout(LOAD_INTERVAL, load_timeout_cb, this);
+      return 1;
     }
 
-    free(files);
+    lock_loads();
+    l->refs = 1;
+    release_load(l);
+    unlock_loads();
   }
 
-  return (num_files);
+  // No threads, load the directory now...
+  int ret = load(directory, sort);
+  if (load_cb_) load_cb_(this, load_data_);
+  return ret > 0;
+}
+
+
+/**
+  Stops loading a directory started with load_async().
+
+  Files that were already added stay in the browser. The load callback
+  is not called.
+
+  \since 1.4.0
+*/
+void Fl_File_Browser::load_cancel()
+{
+  if (!load_) return;
+
+  Fl::remove_timeout(load_timeout_cb, this);
+
+  lock_loads();
+  load_->cancel = 1;
+  release_load(load_);
+  unlock_loads();
+
+  load_ = 0;
+}
+
+
+//
+// 'Fl_File_Browser::load_timeout_cb()' - Add files read by the worker thread.
+//
+
+void
+Fl_File_Browser::load_timeout_cb(void *v)       // I - File browser
+{
+  Fl_File_Browser *fb = (Fl_File_Browser *)v;
+  Fl_File_Load    *l  = fb->load_;
+
+
+  lock_loads();
+  int ready = l->ready;
+  int done  = l->done;
+  unlock_loads();
+
+  // Add the next group of files...
+  int last = ready;
+  if (last > fb->loaded_ + LOAD_BATCH) last = fb->loaded_ + LOAD_BATCH;
+
+  if (last > fb->loaded_) {
+    fb->add_files(l->dir->files, l->dir->types, fb->loaded_, last);
+    fb->loaded_ = last;
+  } else if (!done) {
+    Fl::repeat_timeout(LOAD_INTERVAL, load_timeout_cb, fb);
+    return;
+  }
+
+  if (done && fb->loaded_ >= ready) {
+    // All files are in the browser...
+    if (l->num_files <= 0) fb->errmsg(l->errmsg);
+    fb->load_cancel();
+  } else if (last < ready) {
+    Fl::repeat_timeout(0.0, load_timeout_cb, fb);
+  } else {
+    Fl::repeat_timeout(LOAD_INTERVAL, load_timeout_cb, fb);
+  }
+
+  if (fb->load_cb_) fb->load_cb_(fb, fb->load_data_);
 }
 
 
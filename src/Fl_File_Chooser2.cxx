@@ -330,6 +330,8 @@
 //   Fl_File_Chooser::favoritesButtonCB() - Handle favorites selections.
 //   Fl_File_Chooser::fileListCB()        - Handle clicks (and double-clicks)
 //                                          in the Fl_File_Browser.
+//   Fl_File_Chooser::fileListLoadCB()    - Update the chooser while the
+//                                          Fl_File_Browser loads a directory.
 //   Fl_File_Chooser::fileNameCB()        - Handle text entry in the FileBrowser.
 //   Fl_File_Chooser::showChoiceCB()      - Handle show selections.
 //   compare_dirnames()                   - Compare two directory names.
@@ -755,6 +757,62 @@ Fl_File_Chooser::fileListCB()
 }
 
 
+//
+// 'Fl_File_Chooser::fileListLoadCB()' - Update the chooser while the
+//                                       Fl_File_Browser loads a directory.
+//
+
+void
+Fl_File_Chooser::fileListLoadCB(Fl_Widget *, void *d)
+{
+  Fl_File_Chooser *fc = (Fl_File_Chooser *)d;
+  Fl_File_Browser *fileList = fc->fileList;
+  int           i;
+  char          pathname[FL_PATH_MAX];  // Filename to select
+
+
+  if (Fl::system_driver()->dot_file_hidden() && !fc->showHiddenButton->value())
+    fc->remove_hidden_files();
+
+  if (fileList->loading()) return;
+
+  // The directory is complete...
+  if (fileList->errmsg() || fileList->size() <= 0) {
+    if ( fileList->errmsg() ) fc->errorBox->label(fileList->errmsg());   // show OS errormsg when possible
+    else                      fc->errorBox->label("No files found...");
+    fc->show_error_box(1);
+  }
+
+  // Update the preview box...
+  fc->update_preview();
+
+  if (!fc->keep_filename_) return;
+  fc->keep_filename_ = 0;
+
+  // and select the chosen file
+  char found = 0;
+  strlcpy(pathname, fc->fileName->value(), sizeof(pathname));
+  char *slash = strrchr(pathname, '/');
+  if (slash)
+    slash++;
+  else
+    slash = pathname;
+  for (i = 1; i <= fileList->size(); i ++)
+    if ( (Fl::system_driver()->case_insensitive_filenames() ? strcasecmp(fileList->text(i), slash) : strcmp(fileList->text(i), slash)) == 0) {
+      fileList->topline(i);
+      fileList->select(i);
+      found = 1;
+      break;
+    }
+
+  // update OK button activity
+  if (found || fc->type_ & CREATE)
+    fc->okButton->activate();
+  else
+    fc->okButton->deactivate();
+}
+
+
 //
 // 'Fl_File_Chooser::fileNameCB()' - Handle text entry in the FileBrowser.
 //
@@ -1093,18 +1151,10 @@ Fl_File_Chooser::rescan()
   else
     okButton->deactivate();
 
-  // Build the file list...
-  if ( fileList->load(directory_, sort) <= 0 ) {
-    if ( fileList->errmsg() ) errorBox->label(fileList->errmsg());     // show OS errormsg when possible
-    else                      errorBox->label("No files found...");
-    show_error_box(1);
-  } else {
-    show_error_box(0);
-  }
-
-  if (Fl::system_driver()->dot_file_hidden() && !showHiddenButton->value()) remove_hidden_files();
-  // Update the preview box...
-  update_preview();
+  // Build the file list, fileListLoadCB() finishes the job...
+  keep_filename_ = 0;
+  show_error_box(0);
+  fileList->load_async(directory_, sort);
 }
 
 /**
@@ -1120,42 +1170,10 @@ void Fl_File_Chooser::rescan_keep_filename()
     return;
   }
 
-  int   i;
-  char  pathname[FL_PATH_MAX];          // New pathname for filename field
-  strlcpy(pathname, fn, sizeof(pathname));
-
-  // Build the file list...
-  if (fileList->load(directory_, sort) <= 0) {
-    if ( fileList->errmsg() ) errorBox->label(fileList->errmsg());     // show OS errormsg when possible
-    else                      errorBox->label("No files found...");
-    show_error_box(1);
-  } else {
-    show_error_box(0);
-  }
-  if (Fl::system_driver()->dot_file_hidden() && !showHiddenButton->value()) remove_hidden_files();
-  // Update the preview box...
-  update_preview();
-
-  // and select the chosen file
-  char found = 0;
-  char *slash = strrchr(pathname, '/');
-  if (slash)
-    slash++;
-  else
-    slash = pathname;
-  for (i = 1; i <= fileList->size(); i ++)
-    if ( (Fl::system_driver()->case_insensitive_filenames() ? strcasecmp(fileList->text(i), slash) : strcmp(fileList->text(i), slash)) == 0) {
-      fileList->topline(i);
-      fileList->select(i);
-      found = 1;
-      break;
-    }
-
-  // update OK button activity
-  if (found || type_ & CREATE)
-    okButton->activate();
-  else
-    okButton->deactivate();
+  // Build the file list, fileListLoadCB() selects the file when done...
+  keep_filename_ = 1;
+  show_error_box(0);
+  fileList->load_async(directory_, sort);
 }
 
 
@@ -1539,6 +1557,9 @@ Fl_File_Chooser::value(const char *filename)
       fileList->select(i);
       break;
     }
+
+  // If the directory is still loading, select the file when it is done...
+  if (fileList->loading()) keep_filename_ = 1;
 }
 
 /** Shows the Fl_File_Chooser window.*/
@@ -1557,9 +1578,11 @@ void Fl_File_Chooser::show()
 void Fl_File_Chooser::showHidden(int value)
 {
   if (value) {
-    fileList->load(directory());
+    keep_filename_ = 0;
+    fileList->load_async(directory(), sort);
   } else {
     remove_hidden_files();
+    fileList->topline(1);
     fileList->redraw();
   }
 }
@@ -1571,7 +1594,6 @@ void Fl_File_Chooser::remove_hidden_files()
     const char *p = fileList->text(num);
     if (*p == '.' && strcmp(p, "../") != 0) fileList->remove(num);
   }
-  fileList->topline(1);
 }
 
 
@@ -36,6 +36,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 
 // Read a .gif file and convert it to a "xpm" format (actually my
 // modified one with compressed colormaps).
@@ -90,9 +91,11 @@
  \param[in] filename a full path and name pointing to a valid GIF file.
 
  \see Fl_GIF_Image::Fl_GIF_Image(const char *imagename, const unsigned char *data)
+ \see Fl_GIF_Image::Fl_GIF_Image(const char *filename, bool all_frames)
  */
 Fl_GIF_Image::Fl_GIF_Image(const char *filename) :
-  Fl_Pixmap((char *const*)0)
+  Fl_Pixmap((char *const*)0),
+  frames_(0), alloc_frames_(0), frame_images_(0), frame_delays_(0)
 {
   Fl_Image_Reader rdr;
   if (rdr.open(filename) == -1) {
@@ -104,6 +107,33 @@ Fl_GIF_Image::Fl_GIF_Image(const char *filename) :
 }
 
 
+/**
+ \brief The constructor loads the named GIF image and optionally all frames.
+
+ The image itself is the first frame of the GIF image as with
+ Fl_GIF_Image(const char *filename). If \p all_frames is \c true, all frames
+ of an animated GIF image are decoded as well and can be retrieved with
+ frames(), frame(), and delay() for playback.
+
+ \param[in] filename    a full path and name pointing to a valid GIF file.
+ \param[in] all_frames  decode all frames of an animation
+
+ \since 1.4.0
+ */
+Fl_GIF_Image::Fl_GIF_Image(const char *filename, bool all_frames) :
+  Fl_Pixmap((char *const*)0),
+  frames_(0), alloc_frames_(0), frame_images_(0), frame_delays_(0)
+{
+  Fl_Image_Reader rdr;
+  if (rdr.open(filename) == -1) {
+    Fl::error("Fl_GIF_Image: Unable to open %s!", filename);
+    ld(ERR_FILE_ACCESS);
+  } else {
+    load_gif_(rdr, all_frames);
+  }
+}
+
+
 /**
  \brief The constructor loads a GIF image from memory.
 
@@ -123,11 +153,13 @@ Fl_GIF_Image::Fl_GIF_Image(const char *filename) :
  \param[in] imagename  A name given to this image or NULL
  \param[in] data       Pointer to the start of the GIF image in memory. This code will not check for buffer overruns.
 
+ \see Fl_GIF_Image::Fl_GIF_Image(const char *imagename, const unsigned char *data, int datasize, bool all_frames)
  \see Fl_GIF_Image::Fl_GIF_Image(const char *filename)
  \see Fl_Shared_Image
 */
 Fl_GIF_Image::Fl_GIF_Image(const char *imagename, const unsigned char *data) :
-  Fl_Pixmap((char *const*)0)
+  Fl_Pixmap((char *const*)0),
+  frames_(0), alloc_frames_(0), frame_images_(0), frame_delays_(0)
 {
   Fl_Image_Reader rdr;
   if (rdr.open(imagename, data)==-1) {
@@ -137,148 +169,111 @@ Fl_GIF_Image::Fl_GIF_Image(const char *imagename, const unsigned char *data) :
   }
 }
 
-/*
- This method reads GIF image data and creates an RGB or RGBA image. The GIF
- format supports only 1 bit for alpha. To avoid code duplication, we use
- an Fl_Image_Reader that reads data from either a file or from memory.
-*/
-void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
-{
-  char **new_data;      // Data array
 
-  {char b[6] = { 0 };
-    for (int i=0; i<6; ++i) b[i] = rdr.read_byte();
-    if (b[0]!='G' || b[1]!='I' || b[2] != 'F') {
-      Fl::error("Fl_GIF_Image: %s is not a GIF file.\n", rdr.name());
-      ld(ERR_FORMAT);
-      return;
-    }
-    if (b[3]!='8' || b[4]>'9' || b[5]!= 'a')
-      Fl::warning("%s is version %c%c%c.",rdr.name(),b[3],b[4],b[5]);
-  }
+/**
+ \brief The constructor loads a GIF image of known size and optionally all
+ frames from memory.
 
-  int Width = rdr.read_word();
-  int Height = rdr.read_word();
+ Unlike Fl_GIF_Image(const char *imagename, const unsigned char *data)
+ this constructor never reads beyond the given \p datasize, a truncated or
+ corrupt image fails to load with ERR_FORMAT.
 
-  uchar ch = rdr.read_byte();
-  char HasColormap = ((ch & 0x80) != 0);
-  int BitsPerPixel = (ch & 7) + 1;
-  int ColorMapSize;
-  if (HasColormap) {
-    ColorMapSize = 2 << (ch & 7);
-  } else {
-    ColorMapSize = 0;
-  }
-  // int OriginalResolution = ((ch>>4)&7)+1;
-  // int SortedTable = (ch&8)!=0;
-  ch = rdr.read_byte(); // Background Color index
-  ch = rdr.read_byte(); // Aspect ratio is N/64
+ \param[in] imagename   A name given to this image or NULL
+ \param[in] data        Pointer to the start of the GIF image in memory
+ \param[in] datasize    Size of the GIF image in memory in bytes
+ \param[in] all_frames  decode all frames of an animation
 
-  // Read in global colormap:
-  uchar transparent_pixel = 0;
-  char has_transparent = 0;
-  uchar Red[256], Green[256], Blue[256]; /* color map */
-  if (HasColormap) {
-    for (int i=0; i < ColorMapSize; i++) {
-      Red[i] = rdr.read_byte();
-      Green[i] = rdr.read_byte();
-      Blue[i] = rdr.read_byte();
-    }
+ \see Fl_GIF_Image::Fl_GIF_Image(const char *filename, bool all_frames)
+ \since 1.4.0
+*/
+Fl_GIF_Image::Fl_GIF_Image(const char *imagename, const unsigned char *data,
+                           int datasize, bool all_frames) :
+  Fl_Pixmap((char *const*)0),
+  frames_(0), alloc_frames_(0), frame_images_(0), frame_delays_(0)
+{
+  Fl_Image_Reader rdr;
+  if (rdr.open(imagename, data, datasize)==-1) {
+    ld(ERR_FILE_ACCESS);
+  } else {
+    load_gif_(rdr, all_frames);
   }
+}
 
-  int CodeSize;         /* Code size, init from GIF header, increases... */
-  char Interlace;
-
-  for (;;) {
-
-    int i = rdr.read_byte();
-    if (i<0) {
-      Fl::error("Fl_GIF_Image: %s - unexpected EOF", rdr.name());
-      w(0); h(0); d(0); ld(ERR_FORMAT);
-      return;
-    }
-    int blocklen;
 
-    //  if (i == 0x3B) return 0;  eof code
+/** The destructor frees all memory, including the decoded frames. */
+Fl_GIF_Image::~Fl_GIF_Image() {
+  for (int i = 0; i < frames_; i++)
+    delete frame_images_[i];
+  free(frame_images_);
+  free(frame_delays_);
+}
 
-    if (i == 0x21) {            // a "gif extension"
 
-      ch = rdr.read_byte();
-      blocklen = rdr.read_byte();
+/**
+ Returns frame \p n of an animated GIF image.
 
-      if (ch==0xF9 && blocklen==4) { // Netscape animation extension
+ Each frame is an RGBA image of the size of the GIF's logical screen that
+ shows the animation as it should be displayed at that time, i.e. all
+ previous frames and their disposal methods have been applied. Pixels that
+ are not covered by any frame are transparent.
 
-        char bits;
-        bits = rdr.read_byte();
-        rdr.read_word(); // GETSHORT(delay);
-        transparent_pixel = rdr.read_byte();
-        if (bits & 1) has_transparent = 1;
-        blocklen = rdr.read_byte();
+ The image is owned by the Fl_GIF_Image and must not be deleted.
 
-      } else if (ch == 0xFF) { // Netscape repeat count
-        ;
+ \param[in] n  frame number, 0 to frames() - 1
+ \returns the frame, or NULL if \p n is out of range
 
-      } else if (ch != 0xFE) { //Gif Comment
-        Fl::warning("%s: unknown gif extension 0x%02x.", rdr.name(), ch);
-      }
-    } else if (i == 0x2c) {     // an image
+ \see Fl_GIF_Image::Fl_GIF_Image(const char *filename, bool all_frames)
+ \since 1.4.0
+ */
+Fl_RGB_Image *Fl_GIF_Image::frame(int n) const {
+  if (n < 0 || n >= frames_) return 0;
+  return frame_images_[n];
+}
 
-      ch = rdr.read_byte(); ch = rdr.read_byte(); // GETSHORT(x_position);
-      ch = rdr.read_byte(); ch = rdr.read_byte(); // GETSHORT(y_position);
-      Width = rdr.read_word();
-      Height = rdr.read_word();
-      ch = rdr.read_byte();
-      Interlace = ((ch & 0x40) != 0);
-      if (ch & 0x80) { // image has local color table
-        BitsPerPixel = (ch & 7) + 1;
-        ColorMapSize = 2 << (ch & 7);
-        for (i=0; i < ColorMapSize; i++) {
-          Red[i] = rdr.read_byte();
-          Green[i] = rdr.read_byte();
-          Blue[i] = rdr.read_byte();
-        }
-      }
-      CodeSize = rdr.read_byte()+1;
-      break; // okay, this is the image we want
-    } else {
-      Fl::warning("%s: unknown gif code 0x%02x", rdr.name(), i);
-      blocklen = 0;
-    }
 
-    // skip the data:
-    while (blocklen>0) {while (blocklen--) {ch = rdr.read_byte();} blocklen = rdr.read_byte();}
-  }
+/**
+ Returns the time frame \p n should be shown, in 1/100 seconds.
+ \param[in] n  frame number, 0 to frames() - 1
+ \returns the delay, or 0 if \p n is out of range or the GIF has no delay
+ \since 1.4.0
+ */
+int Fl_GIF_Image::delay(int n) const {
+  if (n < 0 || n >= frames_) return 0;
+  return frame_delays_[n];
+}
 
-  if (BitsPerPixel >= CodeSize)
-  {
-    // Workaround for broken GIF files...
-    BitsPerPixel = CodeSize - 1;
-    ColorMapSize = 1 << BitsPerPixel;
-  }
 
-  // Fix images w/o color table. The standard allows this and lets the
-  // decoder choose a default color table. The standard recommends the
-  // first two color table entries should be black and white.
-
-  if (ColorMapSize == 0) { // no global and no local color table
-    Fl::warning("%s does not have a color table, using default.\n", rdr.name());
-    BitsPerPixel = CodeSize - 1;
-    ColorMapSize = 1 << BitsPerPixel;
-    Red[0] = Green[0] = Blue[0] = 0;    // black
-    Red[1] = Green[1] = Blue[1] = 255;  // white
-    for (int i = 2; i < ColorMapSize; i++) {
-      Red[i] = Green[i] = Blue[i] = (uchar)(255 * i / (ColorMapSize - 1));
-    }
-#if (0)
-    // fill color table to maximum size
-    for (int i = ColorMapSize; i < 256; i++) {
-      Red[i] = Green[i] = Blue[i] = 0; // black
-    }
-#endif
+// Append a copy of the RGBA data as the next frame.
+void Fl_GIF_Image::add_frame_(const uchar *rgba, int W, int H, int delay) {
+  if (frames_ >= alloc_frames_) {
+    alloc_frames_ = alloc_frames_ ? 2 * alloc_frames_ : 16;
+    frame_images_ = (Fl_RGB_Image **)realloc(frame_images_, alloc_frames_ * sizeof(Fl_RGB_Image *));
+    frame_delays_ = (int *)realloc(frame_delays_, alloc_frames_ * sizeof(int));
   }
+  uchar *array = new uchar[W * H * 4];
+  memcpy(array, rgba, W * H * 4);
+  Fl_RGB_Image *img = new Fl_RGB_Image(array, W, H, 4);
+  img->alloc_array = 1;
+  frame_images_[frames_] = img;
+  frame_delays_[frames_] = delay;
+  frames_++;
+}
 
-  uchar *Image = new uchar[Width*Height];
 
+/*
+ Decode the LZW compressed raster data of one image into Width x Height
+ color indexes. Returns 1 if the data sub-blocks were read up to and
+ including the block terminator, 0 if the end-of-information code was found
+ before, i.e. the remaining sub-blocks must be skipped to read the next block.
+
+ The string of a code is the string of its prefix code followed by its suffix,
+ codes below ClearCode are single pixels. The length of each string is kept in
+ a table, hence the string can be written front to back in a single walk of
+ the prefix chain and copied to the image in runs.
+*/
+static int decode_lzw(Fl_Image_Reader &rdr, uchar *Image, int Width, int Height,
+                       char Interlace, int CodeSize)
+{
   int YC = 0, Pass = 0; /* Used to de-interlace the picture */
   uchar *p = Image;
   uchar *eol = p+Width;
@@ -295,37 +290,38 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
   // tables used by LZW decompresser:
   short int Prefix[4096];
   uchar Suffix[4096];
+  short int Length[4096];
+  uchar OutCode[4097]; // the string of the current code
+  int i;
+  for (i = 0; i < ClearCode; i++) Length[i] = 1;
 
-  int blocklen = rdr.read_byte();
-  uchar thisbyte = rdr.read_byte(); blocklen--;
-  int frombit = 0;
+  // The codes can be any length from 3 to 12 bits, packed into 8-bit bytes
+  // of data sub-blocks of up to 255 bytes; whole sub-blocks are read at once
+  // and the bits are collected in an accumulator
+  uchar block[256];
+  int blocklen = 0, blockpos = 0;
+  unsigned long bits = 0;
+  int nbits = 0;
+  char done = 0; // set when the block terminator was read
 
   for (;;) {
 
-    /* Fetch the next code from the raster data stream.  The codes can be
-     * any length from 3 to 12 bits, packed into 8-bit bytes, so we have to
-     * maintain our location as a pointer and a bit offset.
-     * In addition, GIF adds totally useless and annoying block counts
-     * that must be correctly skipped over. */
-    int CurCode = thisbyte;
-    if (frombit+CodeSize > 7) {
-      if (blocklen <= 0) {
+    // Fetch the next code from the raster data stream
+    while (nbits < CodeSize) {
+      if (blockpos >= blocklen) {
         blocklen = rdr.read_byte();
-        if (blocklen <= 0) break;
+        if (blocklen <= 0 || rdr.eof()) { done = 1; break; }
+        blocklen = rdr.read_bytes(block, blocklen);
+        blockpos = 0;
+        if (blocklen <= 0) { done = 1; break; }
       }
-      thisbyte = rdr.read_byte(); blocklen--;
-      CurCode |= thisbyte<<8;
+      bits |= (unsigned long)block[blockpos++] << nbits;
+      nbits += 8;
     }
-    if (frombit+CodeSize > 15) {
-      if (blocklen <= 0) {
-        blocklen = rdr.read_byte();
-        if (blocklen <= 0) break;
-      }
-      thisbyte = rdr.read_byte(); blocklen--;
-      CurCode |= thisbyte<<16;
-    }
-    CurCode = (CurCode>>frombit)&ReadMask;
-    frombit = (frombit+CodeSize)%8;
+    if (nbits < CodeSize) break;
+    int CurCode = (int)(bits & ReadMask);
+    bits >>= CodeSize;
+    nbits -= CodeSize;
 
     if (CurCode == ClearCode) {
       CodeSize = InitCodeSize;
@@ -337,17 +333,31 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
 
     if (CurCode == EOFCode) break;
 
-    uchar OutCode[1025]; // temporary array for reversing codes
-    uchar *tp = OutCode;
-    int i;
-    if (CurCode < FreeCode) i = CurCode;
-    else if (CurCode == FreeCode) {*tp++ = (uchar)FinChar; i = OldCode;}
-    else {Fl::error("Fl_GIF_Image: %s - LZW Barf!", rdr.name()); break;}
-
-    while (i >= ColorMapSize) {*tp++ = Suffix[i]; i = Prefix[i];}
-    *tp++ = FinChar = i;
-    do {
-      *p++ = *--tp;
+    int len;
+    uchar *tp;
+    if (CurCode < FreeCode) {
+      i = CurCode;
+      len = Length[i];
+      tp = OutCode + len;
+    } else if (CurCode == FreeCode && OldCode != ClearCode) {
+      i = OldCode;
+      len = Length[i] + 1;
+      tp = OutCode + len;
+      *--tp = (uchar)FinChar;
+    } else {
+      Fl::error("Fl_GIF_Image: %s - LZW Barf!", rdr.name());
+      break;
+    }
+
+    while (i >= ClearCode) {*--tp = Suffix[i]; i = Prefix[i];}
+    *--tp = (uchar)(FinChar = i);
+
+    // copy the string to the image, one row at a time
+    while (len > 0) {
+      int n = (int)(eol - p);
+      if (n > len) n = len;
+      memcpy(p, tp, n);
+      p += n; tp += n; len -= n;
       if (p >= eol) {
         if (!Interlace) YC++;
         else switch (Pass) {
@@ -360,11 +370,14 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
         p = Image + YC*Width;
         eol = p+Width;
       }
-    } while (tp > OutCode);
+    }
 
-    if (OldCode != ClearCode) {
+    // add a new code, unless the table is full and the code would be
+    // its own prefix
+    if (OldCode != ClearCode && OldCode != FreeCode) {
       Prefix[FreeCode] = (short)OldCode;
-      Suffix[FreeCode] = FinChar;
+      Suffix[FreeCode] = (uchar)FinChar;
+      Length[FreeCode] = Length[OldCode] + 1;
       FreeCode++;
       if (FreeCode > ReadMask) {
         if (CodeSize < 12) {
@@ -377,6 +390,251 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
     OldCode = CurCode;
   }
 
+  return done;
+}
+
+
+/*
+ This method reads GIF image data and creates an RGB or RGBA image. The GIF
+ format supports only 1 bit for alpha. To avoid code duplication, we use
+ an Fl_Image_Reader that reads data from either a file or from memory.
+ If all_frames is set, all frames are decoded and composited into RGBA frames
+ of the size of the logical screen.
+*/
+void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr, bool all_frames)
+{
+  char **new_data;      // Data array
+
+  {char b[6] = { 0 };
+    for (int i=0; i<6; ++i) b[i] = rdr.read_byte();
+    if (b[0]!='G' || b[1]!='I' || b[2] != 'F') {
+      Fl::error("Fl_GIF_Image: %s is not a GIF file.\n", rdr.name());
+      ld(ERR_FORMAT);
+      return;
+    }
+    if (b[3]!='8' || b[4]>'9' || b[5]!= 'a')
+      Fl::warning("%s is version %c%c%c.",rdr.name(),b[3],b[4],b[5]);
+  }
+
+  int ScreenWidth = rdr.read_word();
+  int ScreenHeight = rdr.read_word();
+
+  uchar ch = rdr.read_byte();
+  char HasColormap = ((ch & 0x80) != 0);
+  int GlobalBitsPerPixel = (ch & 7) + 1;
+  int GlobalColorMapSize;
+  if (HasColormap) {
+    GlobalColorMapSize = 2 << (ch & 7);
+  } else {
+    GlobalColorMapSize = 0;
+  }
+  // int OriginalResolution = ((ch>>4)&7)+1;
+  // int SortedTable = (ch&8)!=0;
+  ch = rdr.read_byte(); // Background Color index
+  ch = rdr.read_byte(); // Aspect ratio is N/64
+
+  // Read in global colormap:
+  uchar GlobalMap[3*256];
+  if (HasColormap)
+    rdr.read_bytes(GlobalMap, 3*GlobalColorMapSize);
+
+  // The color map, transparency, and size of the first image, which is
+  // converted to the pixmap below
+  uchar transparent_pixel = 0;
+  char has_transparent = 0;
+  uchar Red[256], Green[256], Blue[256]; /* color map */
+  int ColorMapSize = 0;
+  int Width = 0, Height = 0;
+  uchar *Image = 0;
+
+  // Graphic control extension for the next image
+  uchar gce_transparent = 0;
+  char gce_has_transparent = 0;
+  int gce_delay = 0, gce_disposal = 0;
+
+  // Composited frames of an animation
+  uchar *canvas = 0, *previous = 0;
+
+  int i;
+
+  for (;;) {
+
+    i = rdr.read_byte();
+    if (rdr.eof() || i == 0x3B) { // end of file or trailer
+      if (!Image) {
+        Fl::error("Fl_GIF_Image: %s - unexpected EOF", rdr.name());
+        delete[] canvas;
+        delete[] previous;
+        w(0); h(0); d(0); ld(ERR_FORMAT);
+        return;
+      }
+      break;
+    }
+    int blocklen;
+
+    if (i == 0x21) {            // a "gif extension"
+
+      ch = rdr.read_byte();
+      blocklen = rdr.read_byte();
+
+      if (ch==0xF9 && blocklen==4) { // Netscape animation extension
+
+        char bits;
+        bits = rdr.read_byte();
+        gce_delay = rdr.read_word();
+        gce_transparent = rdr.read_byte();
+        gce_has_transparent = (bits & 1);
+        gce_disposal = (bits >> 2) & 7;
+        blocklen = rdr.read_byte();
+
+      } else if (ch == 0xFF) { // Netscape repeat count
+        ;
+
+      } else if (ch != 0xFE) { //Gif Comment
+        Fl::warning("%s: unknown gif extension 0x%02x.", rdr.name(), ch);
+      }
+    } else if (i == 0x2c) {     // an image
+
+      int XPos = rdr.read_word();
+      int YPos = rdr.read_word();
+      int FrameWidth = rdr.read_word();
+      int FrameHeight = rdr.read_word();
+      ch = rdr.read_byte();
+      char Interlace = ((ch & 0x40) != 0);
+      int BitsPerPixel = GlobalBitsPerPixel;
+      int FrameColorMapSize = GlobalColorMapSize;
+      uchar Map[3*256];
+      memset(Map, 0, sizeof(Map));
+      if (ch & 0x80) { // image has local color table
+        BitsPerPixel = (ch & 7) + 1;
+        FrameColorMapSize = 2 << (ch & 7);
+        rdr.read_bytes(Map, 3*FrameColorMapSize);
+      } else if (FrameColorMapSize) {
+        memcpy(Map, GlobalMap, 3*FrameColorMapSize);
+      }
+      int CodeSize = rdr.read_byte()+1; /* Code size, init from GIF header, increases... */
+      if (CodeSize < 2 || CodeSize > 12 || FrameWidth <= 0 || FrameHeight <= 0 ||
+          (size_t)FrameWidth * FrameHeight > INT_MAX) {
+        Fl::error("Fl_GIF_Image: %s - invalid image data", rdr.name());
+        delete[] canvas;
+        delete[] previous;
+        delete[] Image;
+        w(0); h(0); d(0); ld(ERR_FORMAT);
+        return;
+      }
+
+      if (BitsPerPixel >= CodeSize)
+      {
+        // Workaround for broken GIF files...
+        BitsPerPixel = CodeSize - 1;
+        FrameColorMapSize = 1 << BitsPerPixel;
+      }
+
+      // Fix images w/o color table. The standard allows this and lets the
+      // decoder choose a default color table. The standard recommends the
+      // first two color table entries should be black and white.
+
+      if (FrameColorMapSize == 0) { // no global and no local color table
+        Fl::warning("%s does not have a color table, using default.\n", rdr.name());
+        BitsPerPixel = CodeSize - 1;
+        FrameColorMapSize = 1 << BitsPerPixel;
+        Map[3] = Map[4] = Map[5] = 255;   // white
+        for (int c = 2; c < FrameColorMapSize; c++) {
+          Map[3*c] = Map[3*c+1] = Map[3*c+2] = (uchar)(255 * c / (FrameColorMapSize - 1));
+        }
+      }
+
+      uchar *FrameImage = new uchar[FrameWidth*FrameHeight];
+      memset(FrameImage, 0, FrameWidth*FrameHeight);
+      int done = decode_lzw(rdr, FrameImage, FrameWidth, FrameHeight, Interlace, CodeSize);
+
+      if (all_frames) {
+        // draw the frame onto the logical screen, keep a copy of it for
+        // the disposal method "restore to previous"
+        if (!canvas) {
+          if (ScreenWidth < XPos + FrameWidth) ScreenWidth = XPos + FrameWidth;
+          if (ScreenHeight < YPos + FrameHeight) ScreenHeight = YPos + FrameHeight;
+          // The frames may extend the logical screen up to 131070 x 131070
+          // pixels, hence the canvas size must not be computed as int
+          size_t size = (size_t)ScreenWidth * ScreenHeight * 4;
+          if (size <= INT_MAX && size <= Fl_RGB_Image::max_size()) {
+            canvas = new uchar[size];
+            memset(canvas, 0, size);
+          } else {
+            all_frames = false;
+          }
+        }
+      }
+      if (all_frames) {
+        int size = ScreenWidth * ScreenHeight * 4;
+        if (gce_disposal == 3) {
+          if (!previous) previous = new uchar[size];
+          memcpy(previous, canvas, size);
+        }
+        int x, y;
+        for (y = 0; y < FrameHeight && YPos + y < ScreenHeight; y++) {
+          const uchar *src = FrameImage + y * FrameWidth;
+          uchar *dst = canvas + ((YPos + y) * ScreenWidth + XPos) * 4;
+          for (x = 0; x < FrameWidth && XPos + x < ScreenWidth; x++, dst += 4) {
+            uchar c = src[x];
+            if (gce_has_transparent && c == gce_transparent) continue;
+            dst[0] = Map[3*c];
+            dst[1] = Map[3*c+1];
+            dst[2] = Map[3*c+2];
+            dst[3] = 255;
+          }
+        }
+        add_frame_(canvas, ScreenWidth, ScreenHeight, gce_delay);
+        if (gce_disposal == 2) { // restore to background, i.e. transparent
+          for (y = 0; y < FrameHeight && YPos + y < ScreenHeight; y++) {
+            int n = FrameWidth;
+            if (XPos + n > ScreenWidth) n = ScreenWidth - XPos;
+            if (n > 0) memset(canvas + ((YPos + y) * ScreenWidth + XPos) * 4, 0, n * 4);
+          }
+        } else if (gce_disposal == 3) { // restore to previous
+          memcpy(canvas, previous, size);
+        }
+      }
+
+      if (!Image) {
+        Image = FrameImage;
+        Width = FrameWidth;
+        Height = FrameHeight;
+        ColorMapSize = FrameColorMapSize;
+        for (int c = 0; c < 256; c++) {
+          Red[c] = Map[3*c];
+          Green[c] = Map[3*c+1];
+          Blue[c] = Map[3*c+2];
+        }
+        has_transparent = gce_has_transparent;
+        transparent_pixel = gce_transparent;
+      } else {
+        delete[] FrameImage;
+      }
+      gce_has_transparent = 0;
+      gce_transparent = 0;
+      gce_delay = gce_disposal = 0;
+
+      if (!all_frames) break; // okay, this is the image we want
+
+      // skip the rest of the data to read the next frame
+      blocklen = done ? 0 : rdr.read_byte();
+    } else {
+      Fl::warning("%s: unknown gif code 0x%02x", rdr.name(), i);
+      blocklen = 0;
+    }
+
+    // skip the data:
+    while (blocklen>0) {
+      rdr.skip(blocklen);
+      blocklen = rdr.read_byte();
+      if (rdr.eof()) break;
+    }
+  }
+
+  delete[] canvas;
+  delete[] previous;
+
   // We are done reading the file, now convert to xpm:
 
   // allocate line pointer arrays:
@@ -386,6 +644,7 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
   new_data = new char*[Height+2];
 
   // transparent pixel must be zero, swap if it isn't:
+  uchar *p;
   if (has_transparent && transparent_pixel != 0) {
     // swap transparent pixel with zero
     p = Image+Width*Height;
@@ -409,7 +668,6 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
 
   // find out what colors are actually used:
   uchar used[256]; uchar remap[256];
-  int i;
   for (i = 0; i < ColorMapSize; i++) used[i] = 0;
   p = Image+Width*Height;
   while (p-- > Image) used[*p] = 1;
@@ -422,11 +680,11 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
     numcolors++;
   }
 
-  // write the first line of xpm data (use suffix as temp array):
-  int length = sprintf((char*)(Suffix),
-                       "%d %d %d %d",Width,Height,-numcolors,1);
+  // write the first line of xpm data:
+  char line[64];
+  int length = sprintf(line, "%d %d %d %d",Width,Height,-numcolors,1);
   new_data[0] = new char[length+1];
-  strcpy(new_data[0], (char*)Suffix);
+  strcpy(new_data[0], line);
 
   // write the colormap
   new_data[1] = (char*)(p = new uchar[4*numcolors]);
@@ -21,6 +21,7 @@
 
 #include <FL/Fl_Group.H>
 #include "Fl_Window_Driver.H"
+#include "Fl_Group_Index.h"
 #include <FL/Fl_Rect.H>
 #include <FL/fl_draw.H>
 
@@ -141,6 +142,24 @@ static int navkey() {
   return 0;
 }
 
+// Returns the index of the topmost child below index i that contains the
+// current event position, or -1 if there is none. Start with i = children().
+int Fl_Group::inside_child(int i) const {
+  Fl_Widget*const* a = array();
+  if (!index_) {
+    while (i--) if (Fl::event_inside(a[i])) return i;
+    return -1;
+  }
+  index_->update(this);
+  const int *list;
+  int n = index_->find(Fl::event_x(), Fl::event_y(), list);
+  while (n--) {
+    int j = list[n];
+    if (j < i && Fl::event_inside(a[j])) return j;
+  }
+  return -1;
+}
+
 int Fl_Group::handle(int event) {
 
   Fl_Widget*const* a = array();
@@ -172,9 +191,9 @@ int Fl_Group::handle(int event) {
     return navigation(navkey());
 
   case FL_SHORTCUT:
-    for (i = children(); i--;) {
+    for (i = children(); (i = inside_child(i)) >= 0;) {
       o = a[i];
-      if (o->takesevents() && Fl::event_inside(o) && send(o,FL_SHORTCUT))
+      if (o->takesevents() && send(o,FL_SHORTCUT))
         return 1;
     }
     for (i = children(); i--;) {
@@ -187,9 +206,9 @@ int Fl_Group::handle(int event) {
 
   case FL_ENTER:
   case FL_MOVE:
-    for (i = children(); i--;) {
+    for (i = children(); (i = inside_child(i)) >= 0;) {
       o = a[i];
-      if (o->visible() && Fl::event_inside(o)) {
+      if (o->visible()) {
         if (o->contains(Fl::belowmouse())) {
           return send(o,FL_MOVE);
         } else {
@@ -203,9 +222,9 @@ int Fl_Group::handle(int event) {
 
   case FL_DND_ENTER:
   case FL_DND_DRAG:
-    for (i = children(); i--;) {
+    for (i = children(); (i = inside_child(i)) >= 0;) {
       o = a[i];
-      if (o->takesevents() && Fl::event_inside(o)) {
+      if (o->takesevents()) {
         if (o->contains(Fl::belowmouse())) {
           return send(o,FL_DND_DRAG);
         } else if (send(o,FL_DND_ENTER)) {
@@ -218,9 +237,9 @@ int Fl_Group::handle(int event) {
     return 0;
 
   case FL_PUSH:
-    for (i = children(); i--;) {
+    for (i = children(); (i = inside_child(i)) >= 0;) {
       o = a[i];
-      if (o->takesevents() && Fl::event_inside(o)) {
+      if (o->takesevents()) {
         Fl_Widget_Tracker wp(o);
         if (send(o,FL_PUSH)) {
           if (Fl::pushed() && wp.exists() && !o->contains(Fl::pushed())) Fl::pushed(o);
@@ -236,9 +255,9 @@ int Fl_Group::handle(int event) {
     if (o == this) return 0;
     else if (o) send(o,event);
     else {
-      for (i = children(); i--;) {
+      for (i = children(); (i = inside_child(i)) >= 0;) {
         o = a[i];
-        if (o->takesevents() && Fl::event_inside(o)) {
+        if (o->takesevents()) {
           if (send(o,event)) return 1;
         }
       }
@@ -246,9 +265,9 @@ int Fl_Group::handle(int event) {
     return 0;
 
   case FL_MOUSEWHEEL:
-    for (i = children(); i--;) {
+    for (i = children(); (i = inside_child(i)) >= 0;) {
       o = a[i];
-      if (o->takesevents() && Fl::event_inside(o) && send(o,FL_MOUSEWHEEL))
+      if (o->takesevents() && send(o,FL_MOUSEWHEEL))
         return 1;
     }
     for (i = children(); i--;) {
@@ -366,6 +385,7 @@ Fl_Group::Fl_Group(int X,int Y,int W,int H,const char *l)
   resizable_ = this;
   bounds_ = 0; // this is allocated when first resize() is done
   sizes_ = 0; // see bounds_ (FLTK 1.3 compatibility)
+  index_ = 0; // this is allocated by spatial_index(1)
 
   // Subclasses may want to construct child objects as part of their
   // constructor, so make sure they are add()'d to this object.
@@ -453,6 +473,7 @@ Fl_Group::~Fl_Group() {
   if (current_ == this)
     end();
   clear();
+  delete index_;
 }
 
 /**
@@ -569,6 +590,63 @@ void Fl_Group::init_sizes() {
   bounds_ = 0;
   delete[] sizes_;      // FLTK 1.3 compatibility
   sizes_ = 0;           // FLTK 1.3 compatibility
+  if (index_) {
+    index_->invalidate();
+    index_->reset_damaged();
+  }
+}
+
+/**
+  Enables or disables the spatial index of the group's children.
+
+  By default Fl_Group finds the child below the mouse pointer by testing
+  all children in reverse order. This is fast enough for typical groups,
+  but groups with thousands of children (e.g. grids of cells or tiles)
+  spend most of their event handling time in this loop.
+
+  If the spatial index is enabled the group maintains a grid of its
+  children's positions and sizes so the topmost child under the mouse
+  can be found in (almost) constant time for FL_ENTER, FL_MOVE, FL_PUSH,
+  FL_DRAG, FL_RELEASE, FL_DND_ENTER, FL_DND_DRAG, and FL_MOUSEWHEEL
+  events, and for the first pass of FL_SHORTCUT events, which is sent to
+  the children below the mouse before all other children. The order in
+  which children receive these events is the same as without the index.
+
+  The index is also used by draw_children() to skip all children outside
+  the current clip region and to update only the children that have been
+  damaged since the group was drawn last, if only FL_DAMAGE_CHILD is set.
+  Children with labels outside the widget are always drawn, hence if you
+  change the alignment of a child's label to or from an outside position
+  you should call init_sizes() as well.
+
+  The index is rebuilt lazily after children have been added, removed,
+  or resized with Fl_Widget::resize(). If you change the position or size
+  of a child by other means, call init_sizes() to update the index.
+
+  \param[in] on  non-zero to enable, zero to disable the index
+
+  \see int Fl_Group::spatial_index() const
+
+  \since FLTK 1.4.0
+*/
+void Fl_Group::spatial_index(int on) {
+  if (on && !index_) {
+    index_ = new Fl_Group_Index();
+  } else if (!on && index_) {
+    delete index_;
+    index_ = 0;
+  }
+}
+
+// Called by Fl_Widget::resize() and the window driver whenever a child's
+// position or size changes.
+void Fl_Group::child_resized() {
+  if (index_) index_->invalidate();
+}
+
+// Called by Fl_Widget::damage() when a child gets its first damage bits.
+void Fl_Group::child_damaged(Fl_Widget *o) {
+  if (index_) index_->damaged(o, children_ / 4 + 16);
 }
 
 /**
@@ -801,7 +879,9 @@ void Fl_Group::draw_children() {
                  h() - Fl::box_dh(box()));
   }
 
-  if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
+  if (index_) {
+    draw_children_indexed();
+  } else if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
     for (int i=children_; i--;) {
       Fl_Widget& o = **a++;
       draw_child(o);
@@ -814,6 +894,44 @@ void Fl_Group::draw_children() {
   if (clip_children()) fl_pop_clip();
 }
 
+// Same as the above, but uses the spatial index to visit only the children
+// that intersect the clip region or that have been damaged.
+void Fl_Group::draw_children_indexed() {
+  Fl_Widget*const* a = array();
+  const int *list;
+  int i, n;
+
+  index_->update(this);
+  if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
+    int X, Y, W, H;
+    index_->area(X, Y, W, H);
+    if (fl_clip_box(X, Y, W, H, X, Y, W, H))
+      n = index_->find(X, Y, W, H, list);
+    else
+      n = -1; // nothing clipped: draw everything
+    if (n < 0) {
+      for (i = 0; i < children_; i++) {
+        draw_child(*a[i]);
+        draw_outside_label(*a[i]);
+      }
+    } else {
+      for (i = 0; i < n; i++) {
+        Fl_Widget& o = *a[list[i]];
+        draw_child(o);
+        draw_outside_label(o);
+      }
+    }
+  } else {      // only redraw the children that need it:
+    n = index_->damaged(this, list);
+    if (n < 0) {
+      for (i = 0; i < children_; i++) update_child(*a[i]);
+    } else {
+      for (i = 0; i < n; i++) update_child(*a[list[i]]);
+    }
+  }
+  index_->clear_damaged(this, children_ / 4 + 16);
+}
+
 void Fl_Group::draw() {
   if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
     draw_box();
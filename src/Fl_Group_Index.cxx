@@ -0,0 +1,266 @@
+//
+// Internal child index class for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include "Fl_Group_Index.h"
+
+#include <FL/Fl_Group.H>
+#include <math.h>
+#include <stdlib.h>
+
+// Upper limit for the number of columns and rows of the grid
+#define MAX_GRID 1024
+
+Fl_Group_Index::Fl_Group_Index() :
+  pValid(0),
+  pX(0), pY(0), pW(0), pH(0),
+  pCols(0), pRows(0),
+  pCellW(1), pCellH(1),
+  pStart(0L), pEntries(0L),
+  pStartAlloc(0), pEntriesAlloc(0),
+  pExtra(0L), pNumExtra(0),
+  pNumChildren(0), pChildren(0L),
+  pFound(0L), pMark(0L), pMarkValue(0),
+  pDamaged(0L), pNumDamaged(0), pDamagedAlloc(0),
+  pDamagedOverflow(1)
+{
+}
+
+Fl_Group_Index::~Fl_Group_Index() {
+  free(pStart);
+  free(pEntries);
+  free(pExtra);
+  free(pChildren);
+  free(pFound);
+  free(pMark);
+  free(pDamaged);
+}
+
+// qsort() callbacks
+static int compare_children(const void *a, const void *b) {
+  const Fl_Widget *wa = *(Fl_Widget *const *)a;
+  const Fl_Widget *wb = *(Fl_Widget *const *)b;
+  return wa < wb ? -1 : wa > wb;
+}
+
+static int compare_ints(const void *a, const void *b) {
+  return *(const int *)a - *(const int *)b;
+}
+
+// Rebuild the grid from the current children of the group if necessary.
+void Fl_Group_Index::update(const Fl_Group *g) {
+  if (pValid) return;
+  pValid = 1;
+
+  // (re)allocate per child arrays
+  if (g->children() != pNumChildren) {
+    pNumChildren = g->children();
+    pExtra = (int *)realloc(pExtra, (pNumChildren + 1) * sizeof(int));
+    pChildren = (Child *)realloc(pChildren, (pNumChildren + 1) * sizeof(Child));
+    pFound = (int *)realloc(pFound, (pNumChildren + 1) * sizeof(int));
+    pMark = (unsigned *)realloc(pMark, (pNumChildren + 1) * sizeof(unsigned));
+    for (int i = 0; i < pNumChildren; i++) pMark[i] = 0;
+    pMarkValue = 0;
+  }
+
+  // find the bounding box of all children that can be hit at all and
+  // the children that must be drawn regardless of the clip region
+  int n = 0, L = 0, T = 0, R = 0, B = 0;
+  pNumExtra = 0;
+  Fl_Widget*const* a = g->array();
+  for (int i = 0; i < pNumChildren; i++) {
+    Fl_Widget *o = a[i];
+    pChildren[i].w = o;
+    pChildren[i].i = i;
+    if ((o->align() & 15) && !(o->align() & FL_ALIGN_INSIDE))
+      pExtra[pNumExtra++] = i; // label may be anywhere in the group
+    else if (o->w() <= 0 || o->h() <= 0)
+      pExtra[pNumExtra++] = i;
+    if (o->w() <= 0 || o->h() <= 0) continue;
+    if (!n || o->x() < L) L = o->x();
+    if (!n || o->y() < T) T = o->y();
+    if (!n || o->x() + o->w() > R) R = o->x() + o->w();
+    if (!n || o->y() + o->h() > B) B = o->y() + o->h();
+    n++;
+  }
+  qsort(pChildren, pNumChildren, sizeof(Child), compare_children);
+
+  pX = L; pY = T; pW = R - L; pH = B - T;
+  pCols = pRows = 0;
+  if (!n) return;
+
+  // aim for one child per cell with roughly square cells
+  int cols = (int)sqrt((double)n * pW / pH);
+  if (cols < 1) cols = 1;
+  if (cols > pW) cols = pW;
+  if (cols > MAX_GRID) cols = MAX_GRID;
+  int rows = n / cols;
+  if (rows < 1) rows = 1;
+  if (rows > pH) rows = pH;
+  if (rows > MAX_GRID) rows = MAX_GRID;
+
+  // children that span many cells (e.g. large backgrounds) are stored in
+  // every cell they overlap, use a coarser grid if this gets too big
+  int max_entries = 8 * n + 4096;
+  while (!build(g, cols, rows, max_entries)) {
+    cols = (cols + 1) / 2;
+    rows = (rows + 1) / 2;
+    if (cols == 1 && rows == 1) max_entries = n;
+  }
+}
+
+// Build the grid with the given number of columns and rows.
+int Fl_Group_Index::build(const Fl_Group *g, int cols, int rows, int max_entries) {
+  int cells = cols * rows;
+  if (cells + 1 > pStartAlloc) {
+    pStartAlloc = cells + 1;
+    pStart = (int *)realloc(pStart, pStartAlloc * sizeof(int));
+  }
+  pCols = cols;
+  pRows = rows;
+  pCellW = (pW + cols - 1) / cols;
+  pCellH = (pH + rows - 1) / rows;
+
+  // first pass: count the entries of each cell
+  int i, c, r, total = 0;
+  for (i = 0; i <= cells; i++) pStart[i] = 0;
+  Fl_Widget*const* a = g->array();
+  for (i = 0; i < g->children(); i++) {
+    Fl_Widget *o = a[i];
+    if (o->w() <= 0 || o->h() <= 0) continue;
+    int c0 = (o->x() - pX) / pCellW, c1 = (o->x() + o->w() - 1 - pX) / pCellW;
+    int r0 = (o->y() - pY) / pCellH, r1 = (o->y() + o->h() - 1 - pY) / pCellH;
+    total += (c1 - c0 + 1) * (r1 - r0 + 1);
+    if (total > max_entries) return 0;
+    for (r = r0; r <= r1; r++)
+      for (c = c0; c <= c1; c++)
+        pStart[r * cols + c + 1]++;
+  }
+  for (i = 0; i < cells; i++) pStart[i + 1] += pStart[i];
+
+  if (total > pEntriesAlloc) {
+    pEntriesAlloc = total;
+    pEntries = (int *)realloc(pEntries, pEntriesAlloc * sizeof(int));
+  }
+
+  // second pass: fill in the children in ascending order, using the start
+  // of the following cell as insertion point...
+  for (i = 0; i < g->children(); i++) {
+    Fl_Widget *o = a[i];
+    if (o->w() <= 0 || o->h() <= 0) continue;
+    int c0 = (o->x() - pX) / pCellW, c1 = (o->x() + o->w() - 1 - pX) / pCellW;
+    int r0 = (o->y() - pY) / pCellH, r1 = (o->y() + o->h() - 1 - pY) / pCellH;
+    for (r = r0; r <= r1; r++)
+      for (c = c0; c <= c1; c++)
+        pEntries[pStart[r * cols + c]++] = i;
+  }
+  // ...and shift the start offsets back into place
+  for (i = cells; i > 0; i--) pStart[i] = pStart[i - 1];
+  pStart[0] = 0;
+  return 1;
+}
+
+// Return the number of children that may contain the point (X, Y).
+int Fl_Group_Index::find(int X, int Y, const int *&list) const {
+  list = pEntries;
+  X -= pX;
+  Y -= pY;
+  if (!pCols || X < 0 || Y < 0 || X >= pW || Y >= pH) return 0;
+  int cell = (Y / pCellH) * pCols + X / pCellW;
+  list = pEntries + pStart[cell];
+  return pStart[cell + 1] - pStart[cell];
+}
+
+// Return the number of children that may intersect the rectangle (X, Y, W, H)
+// or must always be drawn.
+int Fl_Group_Index::find(int X, int Y, int W, int H, const int *&list) {
+  list = pFound;
+  int n = 0, i;
+  if (!++pMarkValue) { // wrap around: reset all marks
+    for (i = 0; i < pNumChildren; i++) pMark[i] = 0;
+    pMarkValue = 1;
+  }
+  for (i = 0; i < pNumExtra; i++) {
+    pMark[pExtra[i]] = pMarkValue;
+    pFound[n++] = pExtra[i];
+  }
+  X -= pX;
+  Y -= pY;
+  if (pCols && W > 0 && H > 0 && X < pW && Y < pH && X + W > 0 && Y + H > 0) {
+    int c0 = X < 0 ? 0 : X / pCellW;
+    int r0 = Y < 0 ? 0 : Y / pCellH;
+    int c1 = X + W >= pW ? pCols - 1 : (X + W - 1) / pCellW;
+    int r1 = Y + H >= pH ? pRows - 1 : (Y + H - 1) / pCellH;
+    for (int r = r0; r <= r1; r++) {
+      for (int c = c0; c <= c1; c++) {
+        int cell = r * pCols + c;
+        for (int e = pStart[cell]; e < pStart[cell + 1]; e++) {
+          int j = pEntries[e];
+          if (pMark[j] == pMarkValue) continue;
+          pMark[j] = pMarkValue;
+          pFound[n++] = j;
+        }
+      }
+    }
+  }
+  qsort(pFound, n, sizeof(int), compare_ints);
+  return n;
+}
+
+// Add a child to the list of damaged children.
+void Fl_Group_Index::damaged(Fl_Widget *o, int max) {
+  if (pDamagedOverflow) return;
+  if (pNumDamaged >= max) {
+    pDamagedOverflow = 1;
+    return;
+  }
+  if (pNumDamaged >= pDamagedAlloc) {
+    pDamagedAlloc = pDamagedAlloc ? 2 * pDamagedAlloc : 16;
+    pDamaged = (Fl_Widget **)realloc(pDamaged, pDamagedAlloc * sizeof(Fl_Widget *));
+  }
+  pDamaged[pNumDamaged++] = o;
+}
+
+// Return the number of damaged children or -1 if the list overflowed.
+int Fl_Group_Index::damaged(const Fl_Group *g, const int *&list) {
+  list = pFound;
+  if (pDamagedOverflow) return -1;
+  update(g);
+  int n = 0;
+  for (int i = 0; i < pNumDamaged; i++) {
+    Child key = { pDamaged[i], 0 };
+    Child *c = (Child *)bsearch(&key, pChildren, pNumChildren, sizeof(Child),
+                                compare_children);
+    if (c) pFound[n++] = c->i;
+  }
+  qsort(pFound, n, sizeof(int), compare_ints);
+  return n;
+}
+
+// Remove all children whose damage() is zero from the list of damaged children.
+void Fl_Group_Index::clear_damaged(const Fl_Group *g, int max) {
+  int i, n = 0;
+  if (pDamagedOverflow) {
+    pDamagedOverflow = 0;
+    pNumDamaged = 0;
+    Fl_Widget*const* a = g->array();
+    for (i = 0; i < g->children(); i++)
+      if (a[i]->damage()) damaged(a[i], max);
+    return;
+  }
+  for (i = 0; i < pNumDamaged; i++)
+    if (pDamaged[i]->damage()) pDamaged[n++] = pDamaged[i];
+  pNumDamaged = n;
+}
@@ -0,0 +1,125 @@
+//
+// Internal child index class for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+/*
+  This internal (undocumented) class maintains a uniform grid over the
+  bounding boxes of the children of an Fl_Group.
+
+  Each grid cell stores the indexes of all children that overlap the cell
+  in ascending order (i.e. in drawing order), hence the topmost child under
+  a given point can be found by walking a single cell backwards instead of
+  walking all children of the group. Likewise, drawing only needs to visit
+  the children in the cells that intersect the current clip region.
+
+  The index also keeps a list of children that called Fl_Widget::damage()
+  since the group was drawn last, so a group with FL_DAMAGE_CHILD set can
+  update these children without looking at all others.
+
+  The grid is built lazily by update() and must be invalidated whenever
+  children are added, removed, moved, or resized. Fl_Group does this in
+  init_sizes() and whenever a child calls Fl_Widget::resize().
+*/
+
+#ifndef FL_GROUP_INDEX_H
+#define FL_GROUP_INDEX_H
+
+class Fl_Group;
+class Fl_Widget;
+
+class Fl_Group_Index
+{
+public:
+  // Create an empty (invalid) index.
+  Fl_Group_Index();
+
+  // Destroy the index and free all memory.
+  ~Fl_Group_Index();
+
+  // Mark the index as invalid, it will be rebuilt by the next update().
+  void invalidate() { pValid = 0; }
+
+  // Rebuild the grid from the current children of the group if necessary.
+  void update(const Fl_Group *g);
+
+  // Return the number of children that may contain the point (X, Y) and
+  // set list to their indexes in ascending order. The list is valid until
+  // the next update().
+  int find(int X, int Y, const int *&list) const;
+
+  // Return the bounding box of all children in the grid.
+  void area(int &X, int &Y, int &W, int &H) const {
+    X = pX; Y = pY; W = pW; H = pH;
+  }
+
+  // Return the number of children that may intersect the rectangle
+  // (X, Y, W, H) or must always be drawn and set list to their indexes
+  // in ascending order. The list is valid until the next find() or update().
+  int find(int X, int Y, int W, int H, const int *&list);
+
+  // Add a child to the list of damaged children. The list overflows if it
+  // would get longer than max entries.
+  void damaged(Fl_Widget *o, int max);
+
+  // Return the number of damaged children and set list to their indexes
+  // in ascending order, or return -1 if the list overflowed and all
+  // children must be checked. The list is valid until the next find().
+  int damaged(const Fl_Group *g, const int *&list);
+
+  // Remove all children whose damage() is zero from the list of damaged
+  // children. If the list overflowed, rebuild it from all children.
+  void clear_damaged(const Fl_Group *g, int max);
+
+  // Forget all damaged children, e.g. because children were removed.
+  void reset_damaged() { pNumDamaged = 0; pDamagedOverflow = 1; }
+
+private:
+
+  // build the grid with the given number of columns and rows, returns 0
+  // if the number of entries would exceed max_entries
+  int build(const Fl_Group *g, int cols, int rows, int max_entries);
+
+  // update() sets this when the grid is valid
+  char pValid;
+  // origin and size of the area covered by the grid
+  int pX, pY, pW, pH;
+  // number of columns and rows of the grid
+  int pCols, pRows;
+  // size of one grid cell
+  int pCellW, pCellH;
+  // pCols * pRows + 1 offsets into pEntries, one per cell
+  int *pStart;
+  // indexes of the children that overlap each cell
+  int *pEntries;
+  // allocated sizes of pStart and pEntries
+  int pStartAlloc, pEntriesAlloc;
+  // children that are not in the grid but must always be drawn, i.e.
+  // children with outside labels or without a size
+  int *pExtra;
+  int pNumExtra;
+  // number of children and children sorted by address (for damaged())
+  int pNumChildren;
+  struct Child { Fl_Widget *w; int i; } *pChildren;
+  // result buffer for find() and damaged() and a mark per child
+  int *pFound;
+  unsigned *pMark, pMarkValue;
+  // list of damaged children, damaged() sets pDamagedOverflow if the
+  // list got too long
+  Fl_Widget **pDamaged;
+  int pNumDamaged, pDamagedAlloc;
+  char pDamagedOverflow;
+};
+
+#endif // FL_GROUP_INDEX_H
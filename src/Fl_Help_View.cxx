@@ -26,6 +26,7 @@
 //   Fl_Help_View::do_align()        - Compute the alignment for a line in
 //                                     a block.
 //   Fl_Help_View::draw()            - Draw the Fl_Help_View widget.
+//   Fl_Help_View::find_token()      - Find the token at a position.
 //   Fl_Help_View::format()          - Format the help text.
 //   Fl_Help_View::format_table()    - Format a table...
 //   Fl_Help_View::free_data()       - Free memory used for the document.
@@ -37,6 +38,8 @@
 //   Fl_Help_View::~Fl_Help_View()   - Destroy a Fl_Help_View widget.
 //   Fl_Help_View::load()            - Load the specified file.
 //   Fl_Help_View::resize()          - Resize the help widget.
+//   Fl_Help_View::token_width()     - Get the width of a word.
+//   Fl_Help_View::tokenize()        - Split the document into tokens.
 //   Fl_Help_View::topline()         - Set the top line to the named target.
 //   Fl_Help_View::topline()         - Set the top line by number.
 //   Fl_Help_View::value()           - Set the help text directly.
@@ -51,6 +54,8 @@
 #include <FL/Fl_Shared_Image.H>
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Pixmap.H>
+#include <FL/Fl_Graphics_Driver.H>
+#include <FL/Fl_Device.H>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -82,12 +87,6 @@ static int      quote_char(const char *);
 static void     scrollbar_callback(Fl_Widget *s, void *);
 static void     hscrollbar_callback(Fl_Widget *s, void *);
 
-//
-// global flag for image loading (see get_image).
-//
-
-static char initial_load = 0;
-
 //
 // Broken image...
 //
@@ -272,6 +271,213 @@ void Fl_Help_View::hv_draw(const char *t, int x, int y, int entity_extra_length)
 #endif
 
 
+/*
+  Cache of text widths for HV_Edit_Buffer::width().
+
+  Fl_Help_View::format() measures every word of the document, and the
+  document is formatted again whenever the widget is resized. Measuring
+  text is slow with some graphics drivers, hence the widths of short
+  strings are kept in a hash table keyed by font, size, and text. The
+  table is flushed when the display scale changes, when a new document
+  is loaded (fonts may have been redefined in between), or when it gets
+  too big.
+*/
+
+struct HV_Width_Entry {
+  unsigned      hash;                   // hash of font, size, and text
+  int           offset;                 // offset of the text in hv_width_text, -1 if unused
+  int           length;                 // length of the text
+  int           width;                  // width of the text
+  Fl_Font       font;                   // font of the text
+  Fl_Fontsize   size;                   // font size of the text
+};
+
+#define HV_WIDTH_MAX_LENGTH   64        // longer strings are not cached
+#define HV_WIDTH_MAX_ENTRIES  65536     // flush the cache when it gets bigger
+
+static HV_Width_Entry *hv_width_table = 0;
+static int hv_width_alloc = 0, hv_width_used = 0;
+static char *hv_width_text = 0;
+static int hv_width_text_used = 0;
+static float hv_width_scale = 0.0f;
+
+static void hv_flush_widths() {
+  for (int i = 0; i < hv_width_alloc; i++) hv_width_table[i].offset = -1;
+  hv_width_used = 0;
+  hv_width_text_used = 0;
+}
+
+// Return the width of the first n bytes of t in the current font.
+static int hv_width(const char *t, int n) {
+  if (n > HV_WIDTH_MAX_LENGTH) return (int)fl_width(t, n);
+
+  Fl_Font font = fl_font();
+  Fl_Fontsize size = fl_size();
+  float scale = fl_graphics_driver->scale();
+  if (scale != hv_width_scale) {
+    hv_flush_widths();
+    hv_width_scale = scale;
+  }
+
+  unsigned h = 2166136261U;             // FNV-1a
+  int i;
+  for (i = 0; i < n; i++) h = (h ^ (unsigned char)t[i]) * 16777619U;
+  h = (h ^ (unsigned)font) * 16777619U;
+  h = (h ^ (unsigned)size) * 16777619U;
+
+  HV_Width_Entry *e;
+  if (hv_width_alloc) {
+    for (i = h & (hv_width_alloc - 1); (e = hv_width_table + i)->offset >= 0;
+         i = (i + 1) & (hv_width_alloc - 1)) {
+      if (e->hash == h && e->length == n && e->font == font && e->size == size &&
+          !memcmp(hv_width_text + e->offset, t, n))
+        return e->width;
+    }
+  }
+
+  int width = (int)fl_width(t, n);
+
+  if (hv_width_used >= HV_WIDTH_MAX_ENTRIES) hv_flush_widths();
+  if (2 * (hv_width_used + 1) > hv_width_alloc) {
+    // Grow the table and the text buffer, then insert all entries again
+    int alloc = hv_width_alloc ? 2 * hv_width_alloc : 1024;
+    HV_Width_Entry *table = (HV_Width_Entry *)malloc(alloc * sizeof(HV_Width_Entry));
+    for (i = 0; i < alloc; i++) table[i].offset = -1;
+    for (int j = 0; j < hv_width_alloc; j++) {
+      if (hv_width_table[j].offset < 0) continue;
+      for (i = hv_width_table[j].hash & (alloc - 1); table[i].offset >= 0;
+           i = (i + 1) & (alloc - 1)) { /* empty */ }
+      table[i] = hv_width_table[j];
+    }
+    free(hv_width_table);
+    hv_width_table = table;
+    hv_width_alloc = alloc;
+    hv_width_text = (char *)realloc(hv_width_text, alloc / 2 * HV_WIDTH_MAX_LENGTH);
+  }
+  for (i = h & (hv_width_alloc - 1); hv_width_table[i].offset >= 0;
+       i = (i + 1) & (hv_width_alloc - 1)) { /* empty */ }
+
+  e = hv_width_table + i;
+  e->hash   = h;
+  e->offset = hv_width_text_used;
+  e->length = n;
+  e->width  = width;
+  e->font   = font;
+  e->size   = size;
+  memcpy(hv_width_text + hv_width_text_used, t, n);
+  hv_width_text_used += n;
+  hv_width_used ++;
+
+  return width;
+}
+
+// Return the width of a space in the current font.
+static int hv_space_width() {
+  return hv_width(" ", 1);
+}
+
+
+/*
+  Tokens of the document.
+
+  The document is split into words, tags, and comments once when it is
+  loaded. format(), format_table(), and draw() step from token to token
+  instead of parsing the HTML text again whenever the widget is resized
+  or scrolled, and only look at the white space between the tokens
+  themselves. Words keep their text with decoded HTML entities and the
+  width they had in the font they were last measured in, tags keep
+  their element and ALIGN attribute.
+*/
+
+// Token types
+enum {
+  HV_WORD,                      // text up to the next tag or white space
+  HV_TAG,                       // element with attributes
+  HV_COMMENT                    // comment, up to the end if unterminated
+};
+
+// Elements, in the order of hv_tag_names[]
+enum {
+  HV_UNKNOWN, HV_A, HV_B, HV_BODY, HV_BR, HV_CENTER, HV_CODE, HV_DD,
+  HV_DL, HV_DT, HV_EM, HV_FONT, HV_H1, HV_H2, HV_H3, HV_H4, HV_H5, HV_H6,
+  HV_HEAD, HV_HR, HV_I, HV_IMG, HV_KBD, HV_LI, HV_OL, HV_P, HV_PRE,
+  HV_STRONG, HV_TABLE, HV_TD, HV_TH, HV_TITLE, HV_TR, HV_TT, HV_U, HV_UL,
+  HV_VAR,
+  HV_END = 0x80                 // flag for end tags, e.g. (HV_END | HV_P) for </P>
+};
+
+static const char * const hv_tag_names[] = {
+  "", "A", "B", "BODY", "BR", "CENTER", "CODE", "DD",
+  "DL", "DT", "EM", "FONT", "H1", "H2", "H3", "H4", "H5", "H6",
+  "HEAD", "HR", "I", "IMG", "KBD", "LI", "OL", "P", "PRE",
+  "STRONG", "TABLE", "TD", "TH", "TITLE", "TR", "TT", "U", "UL",
+  "VAR"
+};
+
+#define HV_NO_ALIGN     2       // no ALIGN attribute, see get_align()
+
+struct Fl_Help_Token {
+  const char    *text;          // text of words, in value_ or token_text_
+  int           start,          // offset of the token in value_
+                end,            // offset of the end of the token in value_
+                attrs,          // offset of the attributes of tags in value_
+                length;         // length of the text of words
+  uchar         type,           // HV_WORD, HV_TAG, or HV_COMMENT
+                tag;            // element of tags
+  signed char   align;          // ALIGN attribute of tags or HV_NO_ALIGN
+  Fl_Font       font;           // font of width, -1 if not measured yet
+  Fl_Fontsize   size;           // font size of width
+  int           width;          // width of the text of words
+};
+
+// Return the ALIGN attribute of the tag t, or a if it has none.
+static int hv_align(const Fl_Help_Token *t, int a) {
+  return t->align == HV_NO_ALIGN ? a : t->align;
+}
+
+// Return the element of the tag name s with n characters.
+static uchar hv_tag(const char *s, int n) {
+  if (n > 0 && *s == '/') return HV_END | hv_tag(s + 1, n - 1);
+  for (int i = 1; i < (int)(sizeof(hv_tag_names) / sizeof(hv_tag_names[0])); i ++)
+    if (!strncasecmp(s, hv_tag_names[i], n) && !hv_tag_names[i][n])
+      return (uchar)i;
+  return HV_UNKNOWN;
+}
+
+// Return the level of headings, 0 for other elements.
+static int hv_heading(int tag) {
+  return (tag >= HV_H1 && tag <= HV_H6) ? tag - HV_H1 + 1 : 0;
+}
+
+// Return non-zero for elements that start a new paragraph.
+static int hv_paragraph(int tag) {
+  switch (tag) {
+    case HV_CENTER : case HV_P : case HV_UL : case HV_OL : case HV_DL :
+    case HV_LI : case HV_DD : case HV_DT : case HV_PRE :
+      return 1;
+    default :
+      return hv_heading(tag);
+  }
+}
+
+// Return non-zero for end tags that end a paragraph.
+static int hv_end_paragraph(int tag) {
+  return (tag & HV_END) && tag != (HV_END | HV_LI) && tag != (HV_END | HV_DD) &&
+         tag != (HV_END | HV_DT) && hv_paragraph(tag & ~HV_END);
+}
+
+// Return non-zero for end tags that restore the font of a text style.
+static int hv_end_style(int tag) {
+  switch (tag & ~HV_END) {
+    case HV_B : case HV_STRONG : case HV_I : case HV_EM :
+    case HV_CODE : case HV_TT : case HV_KBD : case HV_VAR :
+      return tag & HV_END;
+    default :
+      return 0;
+  }
+}
+
+
 /* ** Intentionally not Doxygen docs.
   HelpView Edit Buffer management class.
   <b>Internal use only.</b>
@@ -311,7 +517,7 @@ public:
   void add(int ucs);
 
   int cmp(const char * str) { return !strcasecmp(buf_, str); }
-  int width() { return (int)fl_width(buf_); }
+  int width() { return hv_width(buf_, size_); }
 
   char & operator[] (int idx) { return buf_[idx]; }
   char operator[] (int idx) const { return buf_[idx]; }
@@ -640,6 +846,10 @@ Fl_Help_View::draw()
   const Fl_Help_Block   *block;         // Pointer to current block
   const char            *ptr,           // Pointer to text in block
                         *attrs;         // Pointer to start of element attributes
+  Fl_Help_Token         *tok,           // Token at ptr
+                        *tend,          // End of tokens
+                        *word;          // Word in buf, if buf has only one
+  int                   tag;            // Element of tag
   HV_Edit_Buffer        buf;            // Text buffer
   char                  attr[1024];     // Attribute buffer
   int                   xx, yy, ww, hh; // Current positions and sizes
@@ -708,6 +918,7 @@ Fl_Help_View::draw()
   fl_color(textcolor_);
 
   // Draw all visible blocks...
+  tend = tokens_ + ntokens_;
   for (i = 0, block = blocks_; i < nblocks_; i ++, block ++)
     if ((block->y + block->h) >= topline_ && block->y < (topline_ + h()))
     {
@@ -724,17 +935,22 @@ Fl_Help_View::draw()
       // byte length difference between html entity (encoded by &...;) and
       // UTF-8 encoding of same character
       int entity_extra_length = 0;
-      for (ptr = block->start, buf.clear(); ptr < block->end;)
+      tok = find_token(block->start);
+      for (ptr = block->start, buf.clear(), word = 0; ptr < block->end;)
       {
+        // Find the token at ptr...
+        while (tok < tend && value_ + tok->start < ptr)
+          tok ++;
+
         if ((*ptr == '<' || isspace((*ptr)&255)) && buf.size() > 0)
         {
           if (!head && !pre)
           {
             // Check width...
-            ww = buf.width();
+            ww = word ? token_width(word) : buf.width();
 
             if (needspace && xx > block->x)
-              xx += (int)fl_width(' ');
+              xx += hv_space_width();
 
             if ((xx + ww) > block->w)
             {
@@ -747,9 +963,10 @@ Fl_Help_View::draw()
 
             hv_draw(buf.c_str(), xx + x() - leftline_, yy + y(), entity_extra_length);
             buf.clear();
+            word = 0;
             entity_extra_length = 0;
             if (underline) {
-              xtra_ww = isspace((*ptr)&255)?(int)fl_width(' '):0;
+              xtra_ww = isspace((*ptr)&255)?hv_space_width():0;
               fl_xyline(xx + x() - leftline_, yy + y() + 1,
                         xx + x() - leftline_ + ww + xtra_ww);
             }
@@ -771,6 +988,7 @@ Fl_Help_View::draw()
                 if (underline) fl_xyline(xx + x() - leftline_, yy + y() + 1,
                                          xx + x() - leftline_ + buf.width());
                 buf.clear();
+                word = 0;
                 current_pos = (int) (ptr-value_);
                 if (line < 31)
                   line ++;
@@ -784,9 +1002,11 @@ Fl_Help_View::draw()
                 buf.add(' '); // add at least one space
                 while (buf.size() & 7)
                   buf.add(' ');
+                word = 0;
               }
               else {
                 buf.add(' ');
+                word = 0;
               }
               if ((fsize + 2) > hh)
                 hh = fsize + 2;
@@ -797,8 +1017,9 @@ Fl_Help_View::draw()
             if (buf.size() > 0)
             {
               hv_draw(buf.c_str(), xx + x() - leftline_, yy + y());
-              ww = buf.width();
+              ww = word ? token_width(word) : buf.width();
               buf.clear();
+              word = 0;
               if (underline) fl_xyline(xx + x() - leftline_, yy + y() + 1,
                                        xx + x() - leftline_ + ww);
               xx += ww;
@@ -810,6 +1031,7 @@ Fl_Help_View::draw()
           else
           {
             buf.clear();
+            word = 0;
 
             while (isspace((*ptr)&255))
               ptr ++;
@@ -819,36 +1041,19 @@ Fl_Help_View::draw()
 
         if (*ptr == '<')
         {
-          ptr ++;
-
-          if (strncmp(ptr, "!--", 3) == 0)
-          {
-            // Comment...
-            ptr += 3;
-            if ((ptr = strstr(ptr, "-->")) != NULL)
-            {
-              ptr += 3;
-              continue;
-            }
-            else
-              break;
-          }
+          ptr = value_ + tok->end;
 
-          while (*ptr && *ptr != '>' && !isspace((*ptr)&255))
-            buf.add(*ptr++);
-
-          attrs = ptr;
-          while (*ptr && *ptr != '>')
-            ptr ++;
+          if (tok->type == HV_COMMENT)
+            continue;
 
-          if (*ptr == '>')
-            ptr ++;
+          attrs = value_ + tok->attrs;
+          tag   = tok->tag;
 
           // end of command reached, set the supposed start of printed eord here
           current_pos = (int) (ptr-value_);
-          if (buf.cmp("HEAD"))
+          if (tag == HV_HEAD)
             head = 1;
-          else if (buf.cmp("BR"))
+          else if (tag == HV_BR)
           {
             if (line < 31)
               line ++;
@@ -856,7 +1061,7 @@ Fl_Help_View::draw()
             yy += hh;
             hh = 0;
           }
-          else if (buf.cmp("HR"))
+          else if (tag == HV_HR)
           {
             fl_line(block->x + x(), yy + y(), block->w + x(),
                     yy + y());
@@ -867,40 +1072,26 @@ Fl_Help_View::draw()
             yy += 2 * fsize;//hh;
             hh = 0;
           }
-          else if (buf.cmp("CENTER") ||
-                   buf.cmp("P") ||
-                   buf.cmp("H1") ||
-                   buf.cmp("H2") ||
-                   buf.cmp("H3") ||
-                   buf.cmp("H4") ||
-                   buf.cmp("H5") ||
-                   buf.cmp("H6") ||
-                   buf.cmp("UL") ||
-                   buf.cmp("OL") ||
-                   buf.cmp("DL") ||
-                   buf.cmp("LI") ||
-                   buf.cmp("DD") ||
-                   buf.cmp("DT") ||
-                   buf.cmp("PRE"))
+          else if (hv_paragraph(tag))
           {
-            if (tolower(buf[0]) == 'h')
+            if (hv_heading(tag))
             {
               font  = FL_HELVETICA_BOLD;
-              fsize = textsize_ + '7' - buf[1];
+              fsize = textsize_ + 7 - hv_heading(tag);
             }
-            else if (buf.cmp("DT"))
+            else if (tag == HV_DT)
             {
               font  = textfont_ | FL_ITALIC;
               fsize = textsize_;
             }
-            else if (buf.cmp("PRE"))
+            else if (tag == HV_PRE)
             {
               font  = FL_COURIER;
               fsize = textsize_;
               pre   = 1;
             }
 
-            if (buf.cmp("LI"))
+            if (tag == HV_LI)
             {
               // draw bullet (&bull;) Unicode: U+2022, UTF-8 (hex): e2 80 a2
               unsigned char bullet[4] = { 0xe2, 0x80, 0xa2, 0x00 };
@@ -908,20 +1099,19 @@ Fl_Help_View::draw()
             }
 
             pushfont(font, fsize);
-            buf.clear();
           }
-          else if (buf.cmp("A") &&
+          else if (tag == HV_A &&
                    get_attr(attrs, "HREF", attr, sizeof(attr)) != NULL)
           {
             fl_color(linkcolor_);
             underline = 1;
           }
-          else if (buf.cmp("/A"))
+          else if (tag == (HV_END | HV_A))
           {
             fl_color(textcolor_);
             underline = 0;
           }
-          else if (buf.cmp("FONT"))
+          else if (tag == HV_FONT)
           {
             if (get_attr(attrs, "COLOR", attr, sizeof(attr)) != NULL) {
               textcolor_ = get_color(attr, textcolor_);
@@ -949,23 +1139,23 @@ Fl_Help_View::draw()
 
             pushfont(font, fsize);
           }
-          else if (buf.cmp("/FONT"))
+          else if (tag == (HV_END | HV_FONT))
           {
             popfont(font, fsize, textcolor_);
           }
-          else if (buf.cmp("U"))
+          else if (tag == HV_U)
             underline = 1;
-          else if (buf.cmp("/U"))
+          else if (tag == (HV_END | HV_U))
             underline = 0;
-          else if (buf.cmp("B") ||
-                   buf.cmp("STRONG"))
+          else if (tag == HV_B ||
+                   tag == HV_STRONG)
             pushfont(font |= FL_BOLD, fsize);
-          else if (buf.cmp("TD") ||
-                   buf.cmp("TH"))
+          else if (tag == HV_TD ||
+                   tag == HV_TH)
           {
             int tx, ty, tw, th;
 
-            if (tolower(buf[1]) == 'h')
+            if (tag == HV_TH)
               pushfont(font |= FL_BOLD, fsize);
             else
               pushfont(font = textfont_, fsize);
@@ -1000,39 +1190,28 @@ Fl_Help_View::draw()
             if (block->border)
               fl_rect(tx, ty, tw, th);
           }
-          else if (buf.cmp("I") ||
-                   buf.cmp("EM"))
+          else if (tag == HV_I ||
+                   tag == HV_EM)
             pushfont(font |= FL_ITALIC, fsize);
-          else if (buf.cmp("CODE") ||
-                   buf.cmp("TT"))
+          else if (tag == HV_CODE ||
+                   tag == HV_TT)
             pushfont(font = FL_COURIER, fsize);
-          else if (buf.cmp("KBD"))
+          else if (tag == HV_KBD)
             pushfont(font = FL_COURIER_BOLD, fsize);
-          else if (buf.cmp("VAR"))
+          else if (tag == HV_VAR)
             pushfont(font = FL_COURIER_ITALIC, fsize);
-          else if (buf.cmp("/HEAD"))
+          else if (tag == (HV_END | HV_HEAD))
             head = 0;
-          else if (buf.cmp("/H1") ||
-                   buf.cmp("/H2") ||
-                   buf.cmp("/H3") ||
-                   buf.cmp("/H4") ||
-                   buf.cmp("/H5") ||
-                   buf.cmp("/H6") ||
-                   buf.cmp("/B") ||
-                   buf.cmp("/STRONG") ||
-                   buf.cmp("/I") ||
-                   buf.cmp("/EM") ||
-                   buf.cmp("/CODE") ||
-                   buf.cmp("/TT") ||
-                   buf.cmp("/KBD") ||
-                   buf.cmp("/VAR"))
+          else if (hv_heading(tag & ~HV_END) && (tag & HV_END))
+            popfont(font, fsize, fcolor);
+          else if (hv_end_style(tag))
             popfont(font, fsize, fcolor);
-          else if (buf.cmp("/PRE"))
+          else if (tag == (HV_END | HV_PRE))
           {
             popfont(font, fsize, fcolor);
             pre = 0;
           }
-          else if (buf.cmp("IMG"))
+          else if (tag == HV_IMG)
           {
             Fl_Shared_Image *img = 0;
             int         width, height;
@@ -1044,10 +1223,15 @@ Fl_Help_View::draw()
             width  = get_length(wattr);
             height = get_length(hattr);
 
+            int lazy = 0;
             if (get_attr(attrs, "SRC", attr, sizeof(attr))) {
-              img = get_image(attr, width, height);
-              if (!width) width = img->w();
-              if (!height) height = img->h();
+              // Images with a known size are loaded after they were drawn
+              // once, so a page with many images shows up quickly...
+              lazy = width > 0 && height > 0 &&
+                     Fl_Surface_Device::surface() == Fl_Display_Device::display_device();
+              img = get_image(attr, width, height, lazy);
+              if (img && !width) width = img->w();
+              if (img && !height) height = img->h();
             }
 
             if (!width || !height) {
@@ -1059,7 +1243,7 @@ Fl_Help_View::draw()
             ww = width;
 
             if (needspace && xx > block->x)
-              xx += (int)fl_width(' ');
+              xx += hv_space_width();
 
             if ((xx + ww) > block->w)
             {
@@ -1074,6 +1258,13 @@ Fl_Help_View::draw()
             if (img) {
               img->draw(xx + x() - leftline_,
                         yy + y() - fl_height() + fl_descent() + 2);
+            } else if (lazy) {
+              // Draw a placeholder until the image is loaded
+              Fl_Color c = fl_color();
+              fl_color(FL_GRAY);
+              fl_rect(xx + x() - leftline_,
+                      yy + y() - fl_height() + fl_descent() + 2, width, height);
+              fl_color(c);
             }
 
             xx += ww;
@@ -1082,12 +1273,12 @@ Fl_Help_View::draw()
 
             needspace = 0;
           }
-          buf.clear();
         }
         else if (*ptr == '\n' && pre)
         {
           hv_draw(buf.c_str(), xx + x() - leftline_, yy + y());
           buf.clear();
+          word = 0;
 
           if (line < 31)
             line ++;
@@ -1112,35 +1303,21 @@ Fl_Help_View::draw()
               while (buf.size() & 7)
                 buf.add(' ');
             }
+            word = 0;
           }
 
           ptr ++;
           if (!pre) current_pos = (int) (ptr-value_);
           needspace = 1;
         }
-        else if (*ptr == '&') // process html entity
+        else if (*ptr)
         {
-          ptr ++;
-
-          int qch = quote_char(ptr);
-
-          if (qch < 0)
-            buf.add('&');
-          else {
-            int utf8l = buf.size();
-            buf.add(qch);
-            utf8l = buf.size() - utf8l; // length of added UTF-8 text
-            const char *oldptr = ptr;
-            ptr = strchr(ptr, ';') + 1;
-            entity_extra_length += ptr - (oldptr-1) - utf8l; // extra length between html entity and UTF-8
-          }
-
-          if ((fsize + 2) > hh)
-            hh = fsize + 2;
-        }
-        else
-        {
-          buf.add(*ptr++);
+          // Add a word...
+          word = buf.size() ? 0 : tok;
+          buf.add(tok->text, tok->length);
+          // extra length between html entities and UTF-8
+          entity_extra_length += tok->end - tok->start - tok->length;
+          ptr = value_ + tok->end;
 
           if ((fsize + 2) > hh)
             hh = fsize + 2;
@@ -1149,10 +1326,10 @@ Fl_Help_View::draw()
 
       if (buf.size() > 0 && !pre && !head)
       {
-        ww = buf.width();
+        ww = word ? token_width(word) : buf.width();
 
         if (needspace && xx > block->x)
-          xx += (int)fl_width(' ');
+          xx += hv_space_width();
 
         if ((xx + ww) > block->w)
         {
@@ -1261,7 +1438,10 @@ void Fl_Help_View::format() {
   const char    *ptr,           // Pointer into block
                 *start,         // Pointer to start of element
                 *attrs;         // Pointer to start of element attributes
-  HV_Edit_Buffer buf;           // Text buffer
+  Fl_Help_Token *tok,           // Token at ptr
+                *tend,          // End of tokens
+                *word;          // Current word
+  int           tag;            // Element of tag
   char          attr[1024],     // Attribute buffer
                 wattr[1024],    // Width attribute buffer
                 hattr[1024],    // Height attribute buffer
@@ -1293,6 +1473,10 @@ void Fl_Help_View::format() {
   // Reset document width...
   int scrollsize = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
   hsize_ = w() - scrollsize - Fl::box_dw(b);
+  format_width_ = hsize_;
+
+  // get_image() marks the images used with the new layout again
+  for (i = 0; i < nimages_; i ++) images_[i].used = 0;
 
   done = 0;
   while (!done)
@@ -1336,13 +1520,18 @@ void Fl_Help_View::format() {
     table_offset = 0;
 
     // Html text character loop
-    for (ptr = value_, buf.clear(); *ptr;)
+    tend = tokens_ + ntokens_;
+    for (ptr = value_, tok = tokens_, word = 0; *ptr;)
     {
+      // Find the token at ptr...
+      while (tok < tend && value_ + tok->start < ptr)
+        tok ++;
+
       // End of word?
-      if ((*ptr == '<' || isspace((*ptr)&255)) && buf.size() > 0)
+      if ((*ptr == '<' || isspace((*ptr)&255)) && word)
       {
         // Get width of word parsed so far...
-        ww = buf.width();
+        ww = token_width(word);
 
         if (!head && !pre)
         {
@@ -1354,7 +1543,7 @@ void Fl_Help_View::format() {
           }
 
           if (needspace && xx > block->x)
-            ww += (int)fl_width(' ');
+            ww += hv_space_width();
 
   //        printf("line = %d, xx = %d, ww = %d, block->x = %d, block->w = %d\n",
   //           line, xx, ww, block->x, block->w);
@@ -1401,7 +1590,7 @@ void Fl_Help_View::format() {
               hh       = fsize + 2;
             }
             else
-              xx += (int)fl_width(' ');
+              xx += hv_space_width();
 
             if ((fsize + 2) > hh)
               hh = fsize + 2;
@@ -1424,43 +1613,26 @@ void Fl_Help_View::format() {
             ptr ++;
         }
 
-        buf.clear();
+        word = 0;
       }
 
       if (*ptr == '<')
       {
         // Handle html tags..
         start = ptr;
-        ptr ++;
+        ptr   = value_ + tok->end;
 
-        if (strncmp(ptr, "!--", 3) == 0)
-        {
-          // Comment...
-          ptr += 3;
-          if ((ptr = strstr(ptr, "-->")) != NULL)
-          {
-            ptr += 3;
-            continue;
-          }
-          else
-            break;
-        }
+        if (tok->type == HV_COMMENT)
+          continue;
 
-        while (*ptr && *ptr != '>' && !isspace((*ptr)&255))
-          buf.add(*ptr++);
+        attrs = value_ + tok->attrs;
+        tag   = tok->tag;
 
-        attrs = ptr;
-        while (*ptr && *ptr != '>')
-          ptr ++;
-
-        if (*ptr == '>')
-          ptr ++;
-
-        if (buf.cmp("HEAD"))
+        if (tag == HV_HEAD)
           head = 1;
-        else if (buf.cmp("/HEAD"))
+        else if (tag == (HV_END | HV_HEAD))
           head = 0;
-        else if (buf.cmp("TITLE"))
+        else if (tag == HV_TITLE)
         {
           // Copy the title in the document...
           char *st;
@@ -1469,9 +1641,13 @@ void Fl_Help_View::format() {
                *st++ = *ptr++) {/*empty*/}
 
           *st = '\0';
-          buf.clear();
+
+          // Skip the rest of a word cut off by a long title...
+          tok = find_token(ptr);
+          if (tok > tokens_ && value_ + tok[-1].end > ptr)
+            ptr = value_ + tok[-1].end;
         }
-        else if (buf.cmp("A"))
+        else if (tag == HV_A)
         {
           if (get_attr(attrs, "NAME", attr, sizeof(attr)) != NULL)
             add_target(attr, yy - fsize - 2);
@@ -1479,9 +1655,9 @@ void Fl_Help_View::format() {
           if (get_attr(attrs, "HREF", attr, sizeof(attr)) != NULL)
             strlcpy(linkdest, attr, sizeof(linkdest));
         }
-        else if (buf.cmp("/A"))
+        else if (tag == (HV_END | HV_A))
           linkdest[0] = '\0';
-        else if (buf.cmp("BODY"))
+        else if (tag == HV_BODY)
         {
           bgcolor_   = get_color(get_attr(attrs, "BGCOLOR", attr, sizeof(attr)),
                                  color());
@@ -1490,7 +1666,7 @@ void Fl_Help_View::format() {
           linkcolor_ = get_color(get_attr(attrs, "LINK", attr, sizeof(attr)),
                                  fl_contrast(FL_BLUE, color()));
         }
-        else if (buf.cmp("BR"))
+        else if (tag == HV_BR)
         {
           line     = do_align(block, line, xx, newalign, links);
           xx       = block->x;
@@ -1498,38 +1674,24 @@ void Fl_Help_View::format() {
           yy       += hh;
           hh       = 0;
         }
-        else if (buf.cmp("CENTER") ||
-                 buf.cmp("P") ||
-                 buf.cmp("H1") ||
-                 buf.cmp("H2") ||
-                 buf.cmp("H3") ||
-                 buf.cmp("H4") ||
-                 buf.cmp("H5") ||
-                 buf.cmp("H6") ||
-                 buf.cmp("UL") ||
-                 buf.cmp("OL") ||
-                 buf.cmp("DL") ||
-                 buf.cmp("LI") ||
-                 buf.cmp("DD") ||
-                 buf.cmp("DT") ||
-                 buf.cmp("HR") ||
-                 buf.cmp("PRE") ||
-                 buf.cmp("TABLE"))
+        else if (hv_paragraph(tag) ||
+                 tag == HV_HR ||
+                 tag == HV_TABLE)
         {
           block->end = start;
           line       = do_align(block, line, xx, newalign, links);
-          newalign   = buf.cmp("CENTER") ? CENTER : LEFT;
+          newalign   = tag == HV_CENTER ? CENTER : LEFT;
           xx         = block->x;
           block->h   += hh;
 
-          if (buf.cmp("UL") ||
-              buf.cmp("OL") ||
-              buf.cmp("DL"))
+          if (tag == HV_UL ||
+              tag == HV_OL ||
+              tag == HV_DL)
           {
             block->h += fsize + 2;
             xx       = margins.push(4 * fsize);
           }
-          else if (buf.cmp("TABLE"))
+          else if (tag == HV_TABLE)
           {
             if (get_attr(attrs, "BORDER", attr, sizeof(attr)))
               border = (uchar)atoi(attr);
@@ -1552,7 +1714,7 @@ void Fl_Help_View::format() {
               break;
             }
 
-            switch (get_align(attrs, talign))
+            switch (hv_align(tok, talign))
             {
               default :
                   table_offset = 0;
@@ -1570,17 +1732,17 @@ void Fl_Help_View::format() {
             column = 0;
           }
 
-          if (tolower(buf[0]) == 'h' && isdigit(buf[1]))
+          if (hv_heading(tag))
           {
             font  = FL_HELVETICA_BOLD;
-            fsize = textsize_ + '7' - buf[1];
+            fsize = textsize_ + 7 - hv_heading(tag);
           }
-          else if (buf.cmp("DT"))
+          else if (tag == HV_DT)
           {
             font  = textfont_ | FL_ITALIC;
             fsize = textsize_;
           }
-          else if (buf.cmp("PRE"))
+          else if (tag == HV_PRE)
           {
             font  = FL_COURIER;
             fsize = textsize_;
@@ -1597,12 +1759,12 @@ void Fl_Help_View::format() {
           yy = block->y + block->h;
           hh = 0;
 
-          if ((tolower(buf[0]) == 'h' && isdigit(buf[1])) ||
-              buf.cmp("DD") ||
-              buf.cmp("DT") ||
-              buf.cmp("P"))
+          if (hv_heading(tag) ||
+              tag == HV_DD ||
+              tag == HV_DT ||
+              tag == HV_P)
             yy += fsize + 2;
-          else if (buf.cmp("HR"))
+          else if (tag == HV_HR)
           {
             hh += 2 * fsize;
             yy += fsize;
@@ -1616,47 +1778,36 @@ void Fl_Help_View::format() {
           needspace = 0;
           line      = 0;
 
-          if (buf.cmp("CENTER"))
+          if (tag == HV_CENTER)
             newalign = talign = CENTER;
           else
-            newalign = get_align(attrs, talign);
+            newalign = hv_align(tok, talign);
         }
-        else if (buf.cmp("/CENTER") ||
-                 buf.cmp("/P") ||
-                 buf.cmp("/H1") ||
-                 buf.cmp("/H2") ||
-                 buf.cmp("/H3") ||
-                 buf.cmp("/H4") ||
-                 buf.cmp("/H5") ||
-                 buf.cmp("/H6") ||
-                 buf.cmp("/PRE") ||
-                 buf.cmp("/UL") ||
-                 buf.cmp("/OL") ||
-                 buf.cmp("/DL") ||
-                 buf.cmp("/TABLE"))
+        else if (hv_end_paragraph(tag) ||
+                 tag == (HV_END | HV_TABLE))
         {
           line       = do_align(block, line, xx, newalign, links);
           xx         = block->x;
           block->end = ptr;
 
-          if (buf.cmp("/UL") ||
-              buf.cmp("/OL") ||
-              buf.cmp("/DL"))
+          if (tag == (HV_END | HV_UL) ||
+              tag == (HV_END | HV_OL) ||
+              tag == (HV_END | HV_DL))
           {
             xx       = margins.pop();
             block->h += fsize + 2;
           }
-          else if (buf.cmp("/TABLE"))
+          else if (tag == (HV_END | HV_TABLE))
           {
             block->h += fsize + 2;
             xx       = margins.current();
           }
-          else if (buf.cmp("/PRE"))
+          else if (tag == (HV_END | HV_PRE))
           {
             pre = 0;
             hh  = 0;
           }
-          else if (buf.cmp("/CENTER"))
+          else if (tag == (HV_END | HV_CENTER))
             talign = LEFT;
 
           popfont(font, fsize, fcolor);
@@ -1670,7 +1821,9 @@ void Fl_Help_View::format() {
           block->h += hh;
           yy       += hh;
 
-          if (tolower(buf[2]) == 'l')
+          if (tag == (HV_END | HV_UL) ||
+              tag == (HV_END | HV_OL) ||
+              tag == (HV_END | HV_DL))
             yy += fsize + 2;
 
           if (row)
@@ -1683,7 +1836,7 @@ void Fl_Help_View::format() {
           line      = 0;
           newalign  = talign;
         }
-        else if (buf.cmp("TR"))
+        else if (tag == HV_TR)
         {
           block->end = start;
           line       = do_align(block, line, xx, newalign, links);
@@ -1722,7 +1875,7 @@ void Fl_Help_View::format() {
 
           rc = get_color(get_attr(attrs, "BGCOLOR", attr, sizeof(attr)), tc);
         }
-        else if (buf.cmp("/TR") && row)
+        else if (tag == (HV_END | HV_TR) && row)
         {
           line       = do_align(block, line, xx, newalign, links);
           block->end = start;
@@ -1753,8 +1906,8 @@ void Fl_Help_View::format() {
           row       = 0;
           line      = 0;
         }
-        else if ((buf.cmp("TD") ||
-                  buf.cmp("TH")) && row)
+        else if ((tag == HV_TD ||
+                  tag == HV_TH) && row)
         {
           int   colspan;                // COLSPAN attribute
 
@@ -1763,7 +1916,7 @@ void Fl_Help_View::format() {
           block->end = start;
           block->h   += hh;
 
-          if (buf.cmp("TH"))
+          if (tag == HV_TH)
             font = textfont_ | FL_BOLD;
           else
             font = textfont_;
@@ -1797,7 +1950,7 @@ void Fl_Help_View::format() {
           block     = add_block(start, xx, yy, xx + ww, 0, border);
           needspace = 0;
           line      = 0;
-          newalign  = get_align(attrs, tolower(buf[1]) == 'h' ? CENTER : LEFT);
+          newalign  = hv_align(tok, tag == HV_TH ? CENTER : LEFT);
           talign    = newalign;
 
           cells[column] = (int) (block - blocks_);
@@ -1807,15 +1960,15 @@ void Fl_Help_View::format() {
           block->bgcolor = get_color(get_attr(attrs, "BGCOLOR", attr,
                                               sizeof(attr)), rc);
         }
-        else if ((buf.cmp("/TD") ||
-                  buf.cmp("/TH")) && row)
+        else if ((tag == (HV_END | HV_TD) ||
+                  tag == (HV_END | HV_TH)) && row)
         {
           line = do_align(block, line, xx, newalign, links);
           popfont(font, fsize, fcolor);
           xx = margins.pop();
           talign = LEFT;
         }
-        else if (buf.cmp("FONT"))
+        else if (tag == HV_FONT)
         {
           if (get_attr(attrs, "FACE", attr, sizeof(attr)) != NULL) {
             if (!strncasecmp(attr, "helvetica", 9) ||
@@ -1839,31 +1992,24 @@ void Fl_Help_View::format() {
 
           pushfont(font, fsize);
         }
-        else if (buf.cmp("/FONT"))
+        else if (tag == (HV_END | HV_FONT))
           popfont(font, fsize, fcolor);
-        else if (buf.cmp("B") ||
-                 buf.cmp("STRONG"))
+        else if (tag == HV_B ||
+                 tag == HV_STRONG)
           pushfont(font |= FL_BOLD, fsize);
-        else if (buf.cmp("I") ||
-                 buf.cmp("EM"))
+        else if (tag == HV_I ||
+                 tag == HV_EM)
           pushfont(font |= FL_ITALIC, fsize);
-        else if (buf.cmp("CODE") ||
-                 buf.cmp("TT"))
+        else if (tag == HV_CODE ||
+                 tag == HV_TT)
           pushfont(font = FL_COURIER, fsize);
-        else if (buf.cmp("KBD"))
+        else if (tag == HV_KBD)
           pushfont(font = FL_COURIER_BOLD, fsize);
-        else if (buf.cmp("VAR"))
+        else if (tag == HV_VAR)
           pushfont(font = FL_COURIER_ITALIC, fsize);
-        else if (buf.cmp("/B") ||
-                 buf.cmp("/STRONG") ||
-                 buf.cmp("/I") ||
-                 buf.cmp("/EM") ||
-                 buf.cmp("/CODE") ||
-                 buf.cmp("/TT") ||
-                 buf.cmp("/KBD") ||
-                 buf.cmp("/VAR"))
+        else if (hv_end_style(tag))
           popfont(font, fsize, fcolor);
-        else if (buf.cmp("IMG"))
+        else if (tag == HV_IMG)
         {
           Fl_Shared_Image       *img = 0;
           int           width;
@@ -1875,7 +2021,9 @@ void Fl_Help_View::format() {
           width  = get_length(wattr);
           height = get_length(hattr);
 
-          if (get_attr(attrs, "SRC", attr, sizeof(attr))) {
+          // Images with WIDTH and HEIGHT are loaded when they are drawn
+          if ((width <= 0 || height <= 0) &&
+              get_attr(attrs, "SRC", attr, sizeof(attr))) {
             img    = get_image(attr, width, height);
             width  = img->w();
             height = img->h();
@@ -1890,7 +2038,7 @@ void Fl_Help_View::format() {
           }
 
           if (needspace && xx > block->x)
-            ww += (int)fl_width(' ');
+            ww += hv_space_width();
 
           if ((xx + ww) > block->w)
           {
@@ -1910,7 +2058,6 @@ void Fl_Help_View::format() {
 
           needspace = 0;
         }
-        buf.clear();
       }
       else if (*ptr == '\n' && pre)
       {
@@ -1934,39 +2081,24 @@ void Fl_Help_View::format() {
       {
         needspace = 1;
         if ( pre ) {
-          xx += (int)fl_width(' ');
+          xx += hv_space_width();
         }
         ptr ++;
       }
-      else if (*ptr == '&')
+      else if (*ptr)
       {
-        // Handle html '&' codes, eg. "&amp;"
-        ptr ++;
-
-        int qch = quote_char(ptr);
-
-        if (qch < 0)
-          buf.add('&');
-        else {
-          buf.add(qch);
-          ptr = strchr(ptr, ';') + 1;
-        }
-
-        if ((fsize + 2) > hh)
-          hh = fsize + 2;
-      }
-      else
-      {
-        buf.add(*ptr++);
+        // Add a word, with html '&' codes decoded, eg. "&amp;"
+        word = tok;
+        ptr  = value_ + tok->end;
 
         if ((fsize + 2) > hh)
           hh = fsize + 2;
       }
     }
 
-    if (buf.size() > 0 && !head)
+    if (word && !head)
     {
-      ww = buf.width();
+      ww = token_width(word);
 
   //    printf("line = %d, xx = %d, ww = %d, block->x = %d, block->w = %d\n",
   //       line, xx, ww, block->x, block->w);
@@ -1978,7 +2110,7 @@ void Fl_Help_View::format() {
       }
 
       if (needspace && xx > block->x)
-        ww += (int)fl_width(' ');
+        ww += hv_space_width();
 
       if ((xx + ww) > block->w)
       {
@@ -2007,6 +2139,14 @@ void Fl_Help_View::format() {
     qsort(targets_, ntargets_, sizeof(Fl_Help_Target),
           (compare_func_t)compare_targets);
 
+  format_scrollbars();
+}
+
+
+/** Shows or hides the scrollbars for the formatted document. */
+void Fl_Help_View::format_scrollbars() {
+  Fl_Boxtype    b = box() ? box() : FL_DOWN_BOX;
+                                // Box to draw...
   int dx = Fl::box_dw(b) - Fl::box_dx(b);
   int dy = Fl::box_dh(b) - Fl::box_dy(b);
   int ss = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
@@ -2078,6 +2218,10 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
   const char    *ptr,                                   // Pointer into table
                 *attrs,                                 // Pointer to attributes
                 *start;                                 // Start of element
+  Fl_Help_Token *tok,                                   // Token at ptr
+                *tend,                                  // End of tokens
+                *word;                                  // Word in buf, if buf has only one
+  int           tag;                                    // Element of tag
   int           minwidths[MAX_COLUMNS];                 // Minimum widths for each column
   Fl_Font       font;
   Fl_Fontsize   fsize;                                  // Current font and size
@@ -2101,8 +2245,15 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
   fstack_.top(font, fsize, fcolor);
 
   // Scan the table...
+  tok  = find_token(table);
+  tend = tokens_ + ntokens_;
+  word = 0;
   for (ptr = table, column = -1, width = 0, incell = 0; *ptr;)
   {
+    // Find the token at ptr...
+    while (tok < tend && value_ + tok->start < ptr)
+      tok ++;
+
     if ((*ptr == '<' || isspace((*ptr)&255)) && buf.size() > 0 && incell)
     {
       // Check width...
@@ -2110,10 +2261,12 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
       {
         buf.add(' ');
         needspace = 0;
+        word      = 0;
       }
 
-      temp_width = buf.width();
+      temp_width = word ? token_width(word) : buf.width();
       buf.clear();
+      word = 0;
 
       if (temp_width > minwidths[column])
         minwidths[column] = temp_width;
@@ -2127,61 +2280,46 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
     if (*ptr == '<')
     {
       start = ptr;
+      ptr   = value_ + tok->end;
+      buf.clear();
+      word  = 0;
 
-      for (buf.clear(), ptr ++; *ptr && *ptr != '>' && !isspace((*ptr)&255);)
-        buf.add(*ptr++);
-
-      attrs = ptr;
-      while (*ptr && *ptr != '>')
-        ptr ++;
+      if (tok->type == HV_COMMENT)
+        continue;
 
-      if (*ptr == '>')
-        ptr ++;
+      attrs = value_ + tok->attrs;
+      tag   = tok->tag;
 
-      if (buf.cmp("BR") ||
-          buf.cmp("HR"))
+      if (tag == HV_BR ||
+          tag == HV_HR)
       {
         width     = 0;
         needspace = 0;
       }
-      else if (buf.cmp("TABLE") && start > table)
+      else if (tag == HV_TABLE && start > table)
         break;
-      else if (buf.cmp("CENTER") ||
-               buf.cmp("P") ||
-               buf.cmp("H1") ||
-               buf.cmp("H2") ||
-               buf.cmp("H3") ||
-               buf.cmp("H4") ||
-               buf.cmp("H5") ||
-               buf.cmp("H6") ||
-               buf.cmp("UL") ||
-               buf.cmp("OL") ||
-               buf.cmp("DL") ||
-               buf.cmp("LI") ||
-               buf.cmp("DD") ||
-               buf.cmp("DT") ||
-               buf.cmp("PRE"))
+      else if (hv_paragraph(tag))
       {
         width     = 0;
         needspace = 0;
 
-        if (tolower(buf[0]) == 'h' && isdigit(buf[1]))
+        if (hv_heading(tag))
         {
           font  = FL_HELVETICA_BOLD;
-          fsize = textsize_ + '7' - buf[1];
+          fsize = textsize_ + 7 - hv_heading(tag);
         }
-        else if (buf.cmp("DT"))
+        else if (tag == HV_DT)
         {
           font  = textfont_ | FL_ITALIC;
           fsize = textsize_;
         }
-        else if (buf.cmp("PRE"))
+        else if (tag == HV_PRE)
         {
           font  = FL_COURIER;
           fsize = textsize_;
           pre   = 1;
         }
-        else if (buf.cmp("LI"))
+        else if (tag == HV_LI)
         {
           width  += 4 * fsize;
           font   = textfont_;
@@ -2195,29 +2333,18 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
 
         pushfont(font, fsize);
       }
-      else if (buf.cmp("/CENTER") ||
-               buf.cmp("/P") ||
-               buf.cmp("/H1") ||
-               buf.cmp("/H2") ||
-               buf.cmp("/H3") ||
-               buf.cmp("/H4") ||
-               buf.cmp("/H5") ||
-               buf.cmp("/H6") ||
-               buf.cmp("/PRE") ||
-               buf.cmp("/UL") ||
-               buf.cmp("/OL") ||
-               buf.cmp("/DL"))
+      else if (hv_end_paragraph(tag))
       {
         width     = 0;
         needspace = 0;
 
         popfont(font, fsize, fcolor);
       }
-      else if (buf.cmp("TR") || buf.cmp("/TR") ||
-               buf.cmp("/TABLE"))
+      else if (tag == HV_TR || tag == (HV_END | HV_TR) ||
+               tag == (HV_END | HV_TABLE))
       {
 //        printf("%s column = %d, colspan = %d, num_columns = %d\n",
-//             buf.c_str(), column, colspan, num_columns);
+//             hv_tag_names[tag & ~HV_END], column, colspan, num_columns);
 
         if (column >= 0)
         {
@@ -2234,7 +2361,7 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
           }
         }
 
-        if (buf.cmp("/TABLE"))
+        if (tag == (HV_END | HV_TABLE))
           break;
 
         needspace = 0;
@@ -2243,8 +2370,8 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
         max_width = 0;
         incell    = 0;
       }
-      else if (buf.cmp("TD") ||
-               buf.cmp("TH"))
+      else if (tag == HV_TD ||
+               tag == HV_TH)
       {
 //        printf("BEFORE column = %d, colspan = %d, num_columns = %d\n",
 //             column, colspan, num_columns);
@@ -2281,7 +2408,7 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
         width     = 0;
         incell    = 1;
 
-        if (buf.cmp("TH"))
+        if (tag == HV_TH)
           font = textfont_ | FL_BOLD;
         else
           font = textfont_;
@@ -2297,35 +2424,28 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
 
 //        printf("max_width = %d\n", max_width);
       }
-      else if (buf.cmp("/TD") ||
-               buf.cmp("/TH"))
+      else if (tag == (HV_END | HV_TD) ||
+               tag == (HV_END | HV_TH))
       {
         incell = 0;
         popfont(font, fsize, fcolor);
       }
-      else if (buf.cmp("B") ||
-               buf.cmp("STRONG"))
+      else if (tag == HV_B ||
+               tag == HV_STRONG)
         pushfont(font |= FL_BOLD, fsize);
-      else if (buf.cmp("I") ||
-               buf.cmp("EM"))
+      else if (tag == HV_I ||
+               tag == HV_EM)
         pushfont(font |= FL_ITALIC, fsize);
-      else if (buf.cmp("CODE") ||
-               buf.cmp("TT"))
+      else if (tag == HV_CODE ||
+               tag == HV_TT)
         pushfont(font = FL_COURIER, fsize);
-      else if (buf.cmp("KBD"))
+      else if (tag == HV_KBD)
         pushfont(font = FL_COURIER_BOLD, fsize);
-      else if (buf.cmp("VAR"))
+      else if (tag == HV_VAR)
         pushfont(font = FL_COURIER_ITALIC, fsize);
-      else if (buf.cmp("/B") ||
-               buf.cmp("/STRONG") ||
-               buf.cmp("/I") ||
-               buf.cmp("/EM") ||
-               buf.cmp("/CODE") ||
-               buf.cmp("/TT") ||
-               buf.cmp("/KBD") ||
-               buf.cmp("/VAR"))
+      else if (hv_end_style(tag))
         popfont(font, fsize, fcolor);
-      else if (buf.cmp("IMG") && incell)
+      else if (tag == HV_IMG && incell)
       {
         Fl_Shared_Image *img = 0;
         int             iwidth, iheight;
@@ -2336,7 +2456,8 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
         iwidth  = get_length(wattr);
         iheight = get_length(hattr);
 
-        if (get_attr(attrs, "SRC", attr, sizeof(attr))) {
+        if ((iwidth <= 0 || iheight <= 0) &&
+            get_attr(attrs, "SRC", attr, sizeof(attr))) {
           img     = get_image(attr, iwidth, iheight);
           iwidth  = img->w();
           iheight = img->h();
@@ -2347,14 +2468,13 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
 
         width += iwidth;
         if (needspace)
-          width += (int)fl_width(' ');
+          width += hv_space_width();
 
         if (width > max_width)
           max_width = width;
 
         needspace = 0;
       }
-      buf.clear();
     }
     else if (*ptr == '\n' && pre)
     {
@@ -2368,22 +2488,12 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
 
       ptr ++;
     }
-    else if (*ptr == '&' )
-    {
-      ptr ++;
-
-      int qch = quote_char(ptr);
-
-      if (qch < 0)
-        buf.add('&');
-      else {
-        buf.add(qch);
-        ptr = strchr(ptr, ';') + 1;
-      }
-    }
     else
     {
-      buf.add(*ptr++);
+      // Add a word...
+      word = buf.size() ? 0 : tok;
+      buf.add(tok->text, tok->length);
+      ptr = value_ + tok->end;
     }
   }
 
@@ -2482,71 +2592,22 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
 void
 Fl_Help_View::free_data() {
   // Release all images...
-  if (value_) {
-    const char  *ptr,           // Pointer into block
-                *attrs;         // Pointer to start of element attributes
-    HV_Edit_Buffer buf;         // Text buffer
-    char        attr[1024],     // Attribute buffer
-                wattr[1024],    // Width attribute buffer
-                hattr[1024];    // Height attribute buffer
-
-    DEBUG_FUNCTION(__LINE__,__FUNCTION__);
-
-    for (ptr = value_; *ptr;)
-    {
-      if (*ptr == '<')
-      {
-        ptr ++;
-
-        if (strncmp(ptr, "!--", 3) == 0)
-        {
-          // Comment...
-          ptr += 3;
-          if ((ptr = strstr(ptr, "-->")) != NULL)
-          {
-            ptr += 3;
-            continue;
-          }
-          else
-            break;
-        }
-
-        buf.clear();
-
-        while (*ptr && *ptr != '>' && !isspace((*ptr)&255))
-          buf.add(*ptr++);
-
-        attrs = ptr;
-        while (*ptr && *ptr != '>')
-          ptr ++;
-
-        if (*ptr == '>')
-          ptr ++;
-
-        if (buf.cmp("IMG"))
-        {
-          Fl_Shared_Image       *img;
-          int           width;
-          int           height;
-
-          get_attr(attrs, "WIDTH", wattr, sizeof(wattr));
-          get_attr(attrs, "HEIGHT", hattr, sizeof(hattr));
-          width  = get_length(wattr);
-          height = get_length(hattr);
-
-          if (get_attr(attrs, "SRC", attr, sizeof(attr))) {
-            // Get and release the image to free it from memory...
-            img = get_image(attr, width, height);
-            if ((void*)img != &broken_image) {
-              img->release();
-            }
-          }
-        }
-      }
-      else
-        ptr ++;
+  if (nimages_) {
+    for (int i = 0; i < nimages_; i ++) {
+      Fl_Shared_Image *img = images_[i].image;
+      if (img && (void*)img != &broken_image)
+        img->release();
+      free(images_[i].name);
     }
+    free(images_);
+
+    aimages_ = 0;
+    nimages_ = 0;
+    images_  = 0;
+  }
+  Fl::remove_timeout(load_images_cb, this);
 
+  if (value_) {
     free((void *)value_);
     value_ = 0;
   }
@@ -2575,6 +2636,15 @@ Fl_Help_View::free_data() {
     ntargets_ = 0;
     targets_  = 0;
   }
+
+  if (tokens_) {
+    free(tokens_);
+    free(token_text_);
+
+    ntokens_    = 0;
+    tokens_     = 0;
+    token_text_ = 0;
+  }
 } // free_data()
 
 /** Gets an alignment attribute. */
@@ -2730,48 +2800,29 @@ Fl_Help_View::get_color(const char *n,  // I - Color name
 
 /** Gets an inline image.
 
-  The image reference count is maintained accordingly, such that
-  the image can be released exactly once when the document is closed.
+  All images of a document are kept in the images_ array, such that
+  every image is loaded and referenced only once, and released exactly
+  once when the document is closed (see free_data()). Images with a size
+  relative to the widget width get a new size whenever the widget is
+  resized, hence a new size of an image replaces the sizes of the same
+  image that were not used since the document was last formatted.
+
+  If \p lazy is non-zero and the image was not loaded yet, the image is
+  loaded later by a timeout and NULL is returned, so the caller can draw
+  a placeholder. This is used by draw() for images with a known size,
+  hence only the images that are actually shown are loaded, and the
+  document is shown before all of its images are loaded.
 
   \return a pointer to a cached Fl_Shared_Image, if the image can be loaded,
-          otherwise a pointer to an internal Fl_Pixmap (broken_image).
+          otherwise a pointer to an internal Fl_Pixmap (broken_image),
+          or NULL if the image will be loaded later.
 
   \todo Fl_Help_View::get_image() returns a pointer to the internal
   Fl_Pixmap broken_image, but this is _not_ compatible with the
   return type Fl_Shared_Image (release() must not be called).
 */
-
-/* Implementation note: (A.S. Apr 05, 2009)
-
-  Fl_Help_View::get_image() uses a static global flag (initial_load)
-  to determine, if it is called from the initial loading of a document
-  (load() or value()), or from resize() or draw().
-
-  A better solution would be to manage all loaded images in an own
-  structure like Fl_Help_Target (Fl_Help_Image ?) to avoid using this
-  global flag, but this would break the ABI !
-
-  This should be fixed in FLTK 1.3 !
-
-
-  If initial_load is true, then Fl_Shared_Image::get() is called to
-  load the image, and the reference count of the shared image is
-  increased by one.
-
-  If initial_load is false, then Fl_Shared_Image::find() is called to
-  load the image, and the image is released immediately. This avoids
-  increasing the reference count when calling get_image() from draw()
-  or resize().
-
-  Calling Fl_Shared_Image::find() instead of Fl_Shared_Image::get() avoids
-  doing unnecessary i/o for "broken images" within each resize/redraw.
-
-  Each image must be released exactly once in the destructor or before
-  a new document is loaded: see free_data().
-*/
-
 Fl_Shared_Image *
-Fl_Help_View::get_image(const char *name, int W, int H) {
+Fl_Help_View::get_image(const char *name, int W, int H, int lazy) {
   const char    *localname;             // Local filename
   char          dir[FL_PATH_MAX];       // Current directory
   char          temp[2 * FL_PATH_MAX],  // Temporary filename
@@ -2810,19 +2861,62 @@ Fl_Help_View::get_image(const char *name, int W, int H) {
 
   if (strncmp(localname, "file:", 5) == 0) localname += 5;
 
-  if (initial_load) {
-    if ((ip = Fl_Shared_Image::get(localname, W, H)) == NULL) {
-      ip = (Fl_Shared_Image *)&broken_image;
+  // See if the image was used before...
+  Fl_Help_Image *im = images_;
+  int i;
+  for (i = nimages_; i > 0; i --, im ++)
+    if (im->w == W && im->h == H && !strcmp(im->name, localname)) break;
+
+  if (!i) {
+    // Release the other sizes of the image not used by the current layout
+    for (i = 0; i < nimages_; ) {
+      im = images_ + i;
+      if (im->used || strcmp(im->name, localname)) { i ++; continue; }
+      if (im->image && (void*)im->image != &broken_image)
+        im->image->release();
+      free(im->name);
+      *im = images_[--nimages_];
+    }
+    if (nimages_ >= aimages_) {
+      aimages_ += 16;
+      images_  = (Fl_Help_Image *)realloc(images_, aimages_ * sizeof(Fl_Help_Image));
     }
-  } else { // draw or resize
-    if ((ip = Fl_Shared_Image::find(localname, W, H)) == NULL) {
+    im        = images_ + nimages_;
+    im->name  = fl_strdup(localname);
+    im->w     = W;
+    im->h     = H;
+    im->image = 0;
+    nimages_ ++;
+  }
+  im->used = 1;
+
+  if (!im->image) {
+    if (lazy) {
+      if (!Fl::has_timeout(load_images_cb, this))
+        Fl::add_timeout(0.0, load_images_cb, this);
+      return 0;
+    }
+    if ((ip = Fl_Shared_Image::get(localname, W, H)) == NULL) {
       ip = (Fl_Shared_Image *)&broken_image;
-    } else {
-      ip->release();
     }
+    im->image = ip;
   }
 
-  return ip;
+  return im->image;
+}
+
+
+/* Loads the images that were drawn as placeholders. */
+void
+Fl_Help_View::load_images_cb(void *v) {
+  Fl_Help_View *view = (Fl_Help_View *)v;
+  Fl_Help_Image *im = view->images_;
+  for (int i = view->nimages_; i > 0; i --, im ++) {
+    if (im->image) continue;
+    if ((im->image = Fl_Shared_Image::get(im->name, im->w, im->h)) == NULL)
+      im->image = (Fl_Shared_Image *)&broken_image;
+  }
+  view->redraw();
 }
 
 
@@ -3241,6 +3335,15 @@ Fl_Help_View::Fl_Help_View(int        xx,       // I - Left position
   ntargets_     = 0;
   targets_      = (Fl_Help_Target *)0;
 
+  aimages_      = 0;
+  nimages_      = 0;
+  images_       = (Fl_Help_Image *)0;
+
+  ntokens_      = 0;
+  tokens_       = (Fl_Help_Token *)0;
+  token_text_   = (char *)0;
+  token_scale_  = 0.0f;
+
   directory_[0] = '\0';
   filename_[0]  = '\0';
 
@@ -3248,6 +3351,7 @@ Fl_Help_View::Fl_Help_View(int        xx,       // I - Left position
   leftline_     = 0;
   size_         = 0;
   hsize_        = 0;
+  format_width_ = -1;
   scrollbar_size_ = 0;
 
   scrollbar_.value(0, hh, 0, 1);
@@ -3409,9 +3513,9 @@ int Fl_Help_View::load(const char *f)
     ret = -1;
   }
 
-  initial_load = 1;
+  tokenize();
+  hv_flush_widths();
   format();
-  initial_load = 0;
 
   if (target)
     topline(target);
@@ -3443,7 +3547,12 @@ Fl_Help_View::resize(int xx,    // I - New left position
                      y() + h() - scrollsize - Fl::box_dh(b) + Fl::box_dy(b),
                      w() - scrollsize - Fl::box_dw(b), scrollsize);
 
-  format();
+  // The layout of the text depends only on the width, so don't format
+  // a (maybe huge) document again if only the height changed...
+  if (value_ && format_width_ == w() - scrollsize - Fl::box_dw(b))
+    format_scrollbars();
+  else
+    format();
 }
 
 
@@ -3546,15 +3655,186 @@ Fl_Help_View::value(const char *val)    // I - Text to view
 
   value_ = fl_strdup(val);
 
-  initial_load = 1;
+  tokenize();
+  hv_flush_widths();
   format();
-  initial_load = 0;
 
   topline(0);
   leftline(0);
 }
 
 
+/** Splits the document into words, tags, and comments. */
+void
+Fl_Help_View::tokenize()
+{
+  const char    *ptr,           // Pointer into document
+                *s;             // Start of word or tag name
+  Fl_Help_Token *t;             // Current token
+  int           atokens = 0,    // Allocated tokens
+                ntext = 0,      // Used bytes in token_text_
+                atext = 0,      // Allocated bytes in token_text_
+                qch,            // Character of HTML entity
+                i;              // Looping var
+
+
+  ntokens_     = 0;
+  token_scale_ = 0.0f;
+
+  if (!value_)
+    return;
+
+  for (ptr = value_; *ptr;)
+  {
+    if (isspace((*ptr)&255))
+    {
+      ptr ++;
+      continue;
+    }
+
+    if (ntokens_ >= atokens)
+    {
+      atokens = atokens ? 2 * atokens : 1024;
+      tokens_ = (Fl_Help_Token *)realloc(tokens_, atokens * sizeof(Fl_Help_Token));
+    }
+
+    t         = tokens_ + ntokens_ ++;
+    t->text   = 0;
+    t->start  = (int)(ptr - value_);
+    t->attrs  = t->start;
+    t->length = 0;
+    t->tag    = HV_UNKNOWN;
+    t->align  = HV_NO_ALIGN;
+    t->font   = -1;
+    t->size   = 0;
+    t->width  = 0;
+
+    if (*ptr == '<' && strncmp(ptr + 1, "!--", 3) == 0)
+    {
+      // Comment...
+      t->type = HV_COMMENT;
+      if ((s = strstr(ptr + 4, "-->")) != NULL)
+        ptr = s + 3;
+      else
+        ptr += strlen(ptr);
+    }
+    else if (*ptr == '<')
+    {
+      // Tag...
+      t->type = HV_TAG;
+      for (s = ++ptr; *ptr && *ptr != '>' && !isspace((*ptr)&255); ptr ++) {/*empty*/}
+
+      t->tag   = hv_tag(s, (int)(ptr - s));
+      t->attrs = (int)(ptr - value_);
+      t->align = (signed char)get_align(ptr, HV_NO_ALIGN);
+
+      while (*ptr && *ptr != '>')
+        ptr ++;
+
+      if (*ptr == '>')
+        ptr ++;
+    }
+    else
+    {
+      // Word, with its text in the document unless it has HTML entities...
+      t->type = HV_WORD;
+      for (s = ptr; *ptr && *ptr != '<' && !isspace((*ptr)&255); ptr ++)
+        if (*ptr == '&' && quote_char(ptr + 1) >= 0)
+          break;
+
+      if (*ptr != '&')
+      {
+        t->text   = s;
+        t->length = (int)(ptr - s);
+      }
+      else
+      {
+        // Decode the word into token_text_, keeping the offset of the text
+        // in attrs until token_text_ has its final address...
+        t->attrs = ntext;
+        for (ptr = s; *ptr && *ptr != '<' && !isspace((*ptr)&255);)
+        {
+          if ((ntext + 8) > atext)
+          {
+            atext       = atext ? 2 * atext : 1024;
+            token_text_ = (char *)realloc(token_text_, atext);
+          }
+
+          if (*ptr == '&' && (qch = quote_char(ptr + 1)) >= 0)
+          {
+            i = fl_utf8encode((unsigned int)qch, token_text_ + ntext);
+            ntext += i < 1 ? 1 : i;
+            ptr = strchr(ptr + 1, ';') + 1;
+          }
+          else
+            token_text_[ntext ++] = *ptr++;
+        }
+
+        t->length = ntext - t->attrs;
+        token_text_[ntext ++] = '\0';
+      }
+    }
+
+    t->end = (int)(ptr - value_);
+  }
+
+  for (i = 0, t = tokens_; i < ntokens_; i ++, t ++)
+    if (t->type == HV_WORD && !t->text)
+    {
+      t->text  = token_text_ + t->attrs;
+      t->attrs = t->start;
+    }
+}
+
+
+/** Returns the first token that starts at or after \p p. */
+Fl_Help_Token *
+Fl_Help_View::find_token(const char *p)
+{
+  int   lo = 0, hi = ntokens_, mid;     // Binary search range
+
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2;
+    if (value_ + tokens_[mid].start < p)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return tokens_ + lo;
+}
+
+
+/** Returns the width of the word \p t in the current font. */
+int
+Fl_Help_View::token_width(Fl_Help_Token *t)
+{
+  // Widths on other surfaces may differ, e.g. when printing...
+  if (Fl_Surface_Device::surface() != Fl_Display_Device::display_device())
+    return hv_width(t->text, t->length);
+
+  float scale = fl_graphics_driver->scale();
+  if (scale != token_scale_)
+  {
+    for (int i = 0; i < ntokens_; i ++)
+      tokens_[i].font = -1;
+
+    token_scale_ = scale;
+  }
+
+  if (t->font != fl_font() || t->size != fl_size())
+  {
+    t->width = hv_width(t->text, t->length);
+    t->font  = fl_font();
+    t->size  = fl_size();
+  }
+
+  return t->width;
+}
+
+
 /*  Returns the Unicode Code Point associated with a quoted character
     (aka "HTML Entity").
 
@@ -3696,14 +3976,25 @@ quote_char(const char *p) {     // I - Quoted string
     { "yuml;",   5, 255 }
   };
 
-  if (!strchr(p, ';')) return -1;
+  // Don't search the whole (maybe huge) document for the ';'...
+  for (i = 0; p[i] != ';'; i ++)
+    if (!p[i] || i >= 32) return -1;
   if (*p == '#') {
     if (*(p+1) == 'x' || *(p+1) == 'X') return strtol(p+2, NULL, 16);
     else return atoi(p+1);
   }
-  for (i = (int)(sizeof(names) / sizeof(names[0])), nameptr = names; i > 0; i --, nameptr ++)
-    if (strncmp(p, nameptr->name, nameptr->namelen) == 0)
-      return nameptr->code;
+
+  // The names are sorted case-insensitively, with uppercase names first
+  int len = i + 1, lo = 0, hi = (int)(sizeof(names) / sizeof(names[0])) - 1;
+  while (lo <= hi) {
+    i = (lo + hi) / 2;
+    nameptr = names + i;
+    int c = strncasecmp(p, nameptr->name, len);
+    if (!c) c = strncmp(p, nameptr->name, len);
+    if (!c) return nameptr->code;
+    if (c < 0) hi = i - 1;
+    else lo = i + 1;
+  }
 
   return -1;
 }
@@ -26,10 +26,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+// Size of the buffer for file reads, smaller files are not memory mapped
+#define BUFFER_SIZE 8192
+
 /*
   This internal (undocumented) class reads data chunks from a file or from
   memory in LSB-first byte order.
 
+  Files are memory mapped if possible and are otherwise read through a
+  buffer. Memory can be bounded by a size; reads past the end of the data
+  return 0 and set the eof() flag instead of running past the buffer.
+
   This class is used in Fl_GIF_Image and Fl_BMP_Image to avoid code
   duplication and may be extended to be used in similar cases. Future
   options might be to read data in MSB-first byte order or to add more
@@ -45,6 +57,26 @@ int Fl_Image_Reader::open(const char *filename) {
   if ( (pFile = fl_fopen(filename, "rb")) == NULL ) {
     return -1;
   }
+#ifndef _WIN32
+  // map the file and read it like memory, fall back to buffered reads
+  struct stat st;
+  if (fstat(fileno(pFile), &st) == 0 && S_ISREG(st.st_mode) &&
+      st.st_size >= BUFFER_SIZE && st.st_size <= 0x7fffffff) {
+    void *map = mmap(0L, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(pFile), 0);
+    if (map != MAP_FAILED) {
+      fclose(pFile);
+      pFile = 0L;
+      pMap = map;
+      pMapSize = (size_t)st.st_size;
+      pStart = pData = (const unsigned char *)map;
+      pEnd = pStart + pMapSize;
+      pIsData = 1;
+      return 0;
+    }
+  }
+#endif
+  pBuffer = (unsigned char *)malloc(BUFFER_SIZE);
+  pBufPos = pBufEnd = pBuffer;
   pIsFile = 1;
   return 0;
 }
@@ -62,60 +94,117 @@ int Fl_Image_Reader::open(const char *imagename, const unsigned char *data) {
   }
 }
 
+// Initialize the reader for access to datasize bytes of memory, name is
+// copied and stored
+int Fl_Image_Reader::open(const char *imagename, const unsigned char *data, int datasize) {
+  int ret = open(imagename, data);
+  if (ret == 0 && datasize >= 0)
+    pEnd = pStart + datasize;
+  return ret;
+}
+
 // Close and destroy the reader
 Fl_Image_Reader::~Fl_Image_Reader() {
   if (pIsFile && pFile) {
     fclose(pFile);
   }
+#ifndef _WIN32
+  if (pMap)
+    munmap(pMap, pMapSize);
+#endif
   if (pName)
     ::free(pName);
+  if (pBuffer)
+    ::free(pBuffer);
 }
 
-// Read a single byte from memory or a file
-uchar Fl_Image_Reader::read_byte() {
-  if (pIsFile) {
-    return getc(pFile);
-  } else if (pIsData) {
-    return *pData++;
-  } else {
+// Refill the file buffer and return its first byte
+uchar Fl_Image_Reader::fill_buffer() {
+  if (!pIsFile || !pBuffer) {
+    pEOF = 1;
+    return 0;
+  }
+  size_t n = fread(pBuffer, 1, BUFFER_SIZE, pFile);
+  pBufPos = pBuffer;
+  pBufEnd = pBuffer + n;
+  if (!n) {
+    pEOF = 1;
     return 0;
   }
+  return *pBufPos++;
+}
+
+// Read up to n bytes into buf, returns the number of bytes read
+int Fl_Image_Reader::read_bytes(uchar *buf, int n) {
+  if (n <= 0)
+    return 0;
+  if (pIsData) {
+    if (pEnd && n > pEnd - pData) {
+      n = (int)(pEnd - pData);
+      pEOF = 1;
+    }
+    memcpy(buf, pData, n);
+    pData += n;
+    return n;
+  }
+  if (!pIsFile) {
+    pEOF = 1;
+    return 0;
+  }
+  int done = 0;
+  while (done < n) {
+    if (pBufPos >= pBufEnd) {
+      fill_buffer();
+      if (pEOF)
+        break;
+      pBufPos--; // fill_buffer() returned the first byte
+    }
+    int k = (int)(pBufEnd - pBufPos);
+    if (k > n - done)
+      k = n - done;
+    memcpy(buf + done, pBufPos, k);
+    pBufPos += k;
+    done += k;
+  }
+  return done;
+}
+
+// Skip n bytes
+void Fl_Image_Reader::skip(unsigned int n) {
+  if (pIsData) {
+    if (pEnd && n > (unsigned int)(pEnd - pData)) {
+      pData = pEnd;
+      pEOF = 1;
+    } else {
+      pData += n;
+    }
+  } else if (pIsFile) {
+    unsigned int k = (unsigned int)(pBufEnd - pBufPos);
+    if (n <= k) {
+      pBufPos += n;
+    } else {
+      fseek(pFile, n - k, SEEK_CUR);
+      pBufPos = pBufEnd = pBuffer;
+    }
+  }
 }
 
 // Read a 16-bit unsigned integer, LSB-first
 unsigned short Fl_Image_Reader::read_word() {
   unsigned char b0, b1;  // Bytes from file
-  if (pIsFile) {
-    b0 = (uchar)getc(pFile);
-    b1 = (uchar)getc(pFile);
-    return ((b1 << 8) | b0);
-  } else if (pIsData) {
-    b0 = *pData++;
-    b1 = *pData++;
-    return ((b1 << 8) | b0);
-  } else {
-    return 0;
-  }
+  b0 = read_byte();
+  b1 = read_byte();
+  return ((b1 << 8) | b0);
 }
 
 // Read a 32-bit unsigned integer, LSB-first
 unsigned int Fl_Image_Reader::read_dword() {
   unsigned char b0, b1, b2, b3;  // Bytes from file
-  if (pIsFile) {
-    b0 = (uchar)getc(pFile);
-    b1 = (uchar)getc(pFile);
-    b2 = (uchar)getc(pFile);
-    b3 = (uchar)getc(pFile);
-    return ((((((b3 << 8) | b2) << 8) | b1) << 8) | b0);
-  } else if (pIsData) {
-    b0 = *pData++;
-    b1 = *pData++;
-    b2 = *pData++;
-    b3 = *pData++;
-    return ((((((b3 << 8) | b2) << 8) | b1) << 8) | b0);
-  } else {
-    return 0;
-  }
+  b0 = read_byte();
+  b1 = read_byte();
+  b2 = read_byte();
+  b3 = read_byte();
+  return ((((((b3 << 8) | b2) << 8) | b1) << 8) | b0);
 }
 
 // Read a 32-bit signed integer, LSB-first
@@ -126,7 +215,15 @@ unsigned int Fl_Image_Reader::read_dword() {
 void Fl_Image_Reader::seek(unsigned int n) {
   if (pIsFile) {
     fseek(pFile, n , SEEK_SET);
+    pBufPos = pBufEnd = pBuffer;
+    pEOF = 0;
   } else if (pIsData) {
-    pData = pStart + n;
+    if (pEnd && n > (unsigned int)(pEnd - pStart)) {
+      pData = pEnd;
+      pEOF = 1;
+    } else {
+      pData = pStart + n;
+      pEOF = 0;
+    }
   }
 }
@@ -18,6 +18,10 @@
   This internal (undocumented) class reads data chunks from a file or from
   memory in LSB-first byte order.
 
+  Files are memory mapped if possible and are otherwise read through a
+  buffer. Memory can be bounded by a size; reads past the end of the data
+  return 0 and set the eof() flag instead of running past the buffer.
+
   This class is used in Fl_GIF_Image and Fl_BMP_Image to avoid code
   duplication and may be extended to be used in similar cases. Future
   options might be to read data in MSB-first byte order or to add more
@@ -34,9 +38,11 @@ class Fl_Image_Reader
 public:
   // Create the reader.
   Fl_Image_Reader() :
-  pIsFile(0), pIsData(0),
+  pIsFile(0), pIsData(0), pEOF(0),
   pFile(0L), pData(0L),
-  pStart(0L),
+  pStart(0L), pEnd(0L),
+  pMap(0L), pMapSize(0),
+  pBuffer(0L), pBufPos(0L), pBufEnd(0L),
   pName(0L)
   {}
 
@@ -47,11 +53,31 @@ public:
   // Initialize the reader for memory access, name is copied and stored
   int open(const char *imagename, const unsigned char *data);
 
+  // Initialize the reader for access to datasize bytes of memory, name is
+  // copied and stored. A negative datasize means that the size is unknown.
+  int open(const char *imagename, const unsigned char *data, int datasize);
+
   // Close and destroy the reader
   ~Fl_Image_Reader();
 
   // Read a single byte from memory or a file
-  unsigned char read_byte();
+  unsigned char read_byte() {
+    if (pIsData) {
+      if (pData < pEnd || !pEnd)
+        return *pData++;
+      pEOF = 1;
+      return 0;
+    }
+    if (pBufPos < pBufEnd)
+      return *pBufPos++;
+    return fill_buffer();
+  }
+
+  // Read up to n bytes into buf, returns the number of bytes read
+  int read_bytes(unsigned char *buf, int n);
+
+  // Skip n bytes
+  void skip(unsigned int n);
 
   // Read a 16-bit unsigned integer, LSB-first
   unsigned short read_word();
@@ -71,18 +97,36 @@ public:
   // return the name or filename for this reader
   const char *name() { return pName; }
 
+  // return 1 if a read went past the end of the file
+  int eof() const { return pEOF; }
+
 private:
 
+  // refill the file buffer and return its first byte, or set pEOF and
+  // return 0 at the end of the file
+  unsigned char fill_buffer();
+
   // open() sets this if we read from a file
   char pIsFile;
   // open() sets this if we read from memory
   char pIsData;
+  // set if a read went past the end of the file
+  char pEOF;
   // a pointer to the opened file
   FILE *pFile;
   // a pointer to the current byte in memory
   const unsigned char *pData;
   // a pointer to the start of the image data
   const unsigned char *pStart;
+  // a pointer past the end of the image data or NULL if the size is unknown
+  const unsigned char *pEnd;
+  // the memory mapped file and its size
+  void *pMap;
+  size_t pMapSize;
+  // buffer for file reads, reading byte by byte with getc() is slow
+  unsigned char *pBuffer;
+  // current read position and end of valid data in pBuffer
+  const unsigned char *pBufPos, *pBufEnd;
   // a copy of the name associated with this reader
   char *pName;
 };
@@ -102,6 +102,34 @@ Fl_JPEG_Image::Fl_JPEG_Image(const char *filename)
   load_jpg_(filename, 0L, 0L);
 }
 
+/**
+ \brief The constructor loads a JPEG image file at reduced resolution.
+
+ Large JPEG images can be decoded at 1/2, 1/4, or 1/8 of their resolution
+ much faster and with much less memory than at full resolution. This
+ constructor uses the smallest of these scales that still yields at least
+ \p W x \p H pixels, which is useful if the image is only shown as a
+ thumbnail, for instance after copy(W, H).
+
+ The image data is stored at the reduced resolution, i.e. data_w() and
+ data_h() are the decoded size, whereas w() and h() are the full size of the
+ image as if it had been loaded with Fl_JPEG_Image(const char *filename)
+ (see Fl_Image::scale()). If \p W or \p H is 0 or the image is not larger
+ than twice the requested size, the image is loaded at full resolution.
+
+ \param[in] filename a full path and name pointing to a valid jpeg file.
+ \param[in] W, H     minimum size of the decoded image data in pixels
+
+ \see Fl_JPEG_Image::Fl_JPEG_Image(const char *filename)
+ \see Fl_Shared_Image::get(const char *name, int W, int H)
+ \since 1.4.0
+ */
+Fl_JPEG_Image::Fl_JPEG_Image(const char *filename, int W, int H)
+: Fl_RGB_Image(0,0,0)
+{
+  load_jpg_(filename, 0L, 0L, W, H);
+}
+
 /**
  \brief The constructor loads the JPEG image from memory.
 
@@ -131,6 +159,26 @@ Fl_JPEG_Image::Fl_JPEG_Image(const char *name, const unsigned char *data)
   load_jpg_(0L, name, data);
 }
 
+/**
+ \brief The constructor loads a JPEG image of known size from memory.
+
+ Unlike Fl_JPEG_Image(const char *name, const unsigned char *data) this
+ constructor never reads beyond the given \p datasize. A truncated image is
+ decoded as far as the data goes.
+
+ \param name A unique name or NULL
+ \param data A pointer to the memory location of the JPEG image
+ \param datasize Size of the JPEG image in memory in bytes
+
+ \see Fl_JPEG_Image::Fl_JPEG_Image(const char *name, const unsigned char *data)
+ \since 1.4.0
+ */
+Fl_JPEG_Image::Fl_JPEG_Image(const char *name, const unsigned char *data, int datasize)
+: Fl_RGB_Image(0,0,0)
+{
+  load_jpg_(0L, name, data, 0, 0, datasize);
+}
+
 
 // data source manager for reading jpegs from memory
 // init_source (j_decompress_ptr cinfo)
@@ -145,6 +193,7 @@ Fl_JPEG_Image::Fl_JPEG_Image(const char *name, const unsigned char *data)
 typedef struct {
   struct jpeg_source_mgr pub;
   const unsigned char *data, *s;
+  const unsigned char *end;     // end of data or NULL if the size is unknown
   // JOCTET * buffer;              /* start of buffer */
   // boolean start_of_file;        /* have we gotten any data yet? */
 } my_source_mgr;
@@ -162,6 +211,17 @@ extern "C" {
   static boolean fill_input_buffer(j_decompress_ptr cinfo) {
     my_src_ptr src = (my_src_ptr)cinfo->src;
     size_t nbytes = 4096;
+    if (src->end) {
+      if (src->s >= src->end) {
+        // insert a fake EOI marker at the end of the data, like libjpeg does
+        static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+        src->pub.next_input_byte = eoi;
+        src->pub.bytes_in_buffer = 2;
+        return TRUE;
+      }
+      if (nbytes > (size_t)(src->end - src->s))
+        nbytes = (size_t)(src->end - src->s);
+    }
     src->pub.next_input_byte = src->s;
     src->pub.bytes_in_buffer = nbytes;
     src->s += nbytes;
@@ -186,9 +246,11 @@ extern "C" {
 
 } // extern "C"
 
-static void jpeg_mem_src(j_decompress_ptr cinfo, const unsigned char *data)
+static void jpeg_mem_src(j_decompress_ptr cinfo, const unsigned char *data, int datasize)
 {
-  my_src_ptr src = (my_source_mgr*)malloc(sizeof(my_source_mgr));
+  // allocated in the permanent pool, jpeg_destroy_decompress() frees it
+  my_src_ptr src = (my_src_ptr)(*cinfo->mem->alloc_small)((j_common_ptr)cinfo,
+                                   JPOOL_PERMANENT, sizeof(my_source_mgr));
   cinfo->src = &(src->pub);
   src->pub.init_source = init_source;
   src->pub.fill_input_buffer = fill_input_buffer;
@@ -199,6 +261,7 @@ static void jpeg_mem_src(j_decompress_ptr cinfo, const unsigned char *data)
   src->pub.next_input_byte = NULL; /* until buffer loaded */
   src->data = data;
   src->s = data;
+  src->end = datasize >= 0 ? data + datasize : 0L;
 }
 #endif // HAVE_LIBJPEG
 
@@ -207,15 +270,19 @@ static void jpeg_mem_src(j_decompress_ptr cinfo, const unsigned char *data)
  This method reads JPEG image data and creates an RGB or grayscale image.
  To avoid code duplication, we set filename if we want to read form a file or
  data to read from memory instead. Sharename can be set if the image is
- supposed to be added to teh Fl_Shared_Image list.
+ supposed to be added to teh Fl_Shared_Image list. If W and H are given, the
+ image data is decoded at the smallest DCT scale that yields at least W x H
+ pixels. A datasize of -1 means that the size of the data in memory is unknown.
  */
-void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const unsigned char *data)
+void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const unsigned char *data,
+                              int W, int H, int datasize)
 {
 #ifdef HAVE_LIBJPEG
   FILE                   *fp = 0L;  // File pointer
   jpeg_decompress_struct  dinfo;    // Decompressor info
   fl_jpeg_error_mgr       jerr;     // Error handler info
-  JSAMPROW                row;      // Sample row pointer
+  JSAMPROW                rows[16]; // Sample row pointers
+  int                     full_w, full_h; // Size of the image at full resolution
 
   // the following variables are pointers allocating some private space that
   // is not reset by 'setjmp()'
@@ -288,7 +355,7 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
   if (fp) {
     jpeg_stdio_src(&dinfo, fp);
   } else {
-    jpeg_mem_src(&dinfo, data);
+    jpeg_mem_src(&dinfo, data, datasize);
   }
   jpeg_read_header(&dinfo, TRUE);
 
@@ -297,6 +364,19 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
   dinfo.out_color_components = 3;
   dinfo.output_components    = 3;
 
+  // libjpeg can scale the image down by 1/2, 1/4, or 1/8 while decoding,
+  // which skips most of the inverse DCT work for the omitted pixels
+  full_w = dinfo.image_width;
+  full_h = dinfo.image_height;
+  if (W > 0 && H > 0) {
+    unsigned denom = 8;
+    while (denom > 1 && ((full_w + denom - 1) / denom < (unsigned)W ||
+                         (full_h + denom - 1) / denom < (unsigned)H))
+      denom /= 2;
+    dinfo.scale_num   = 1;
+    dinfo.scale_denom = denom;
+  }
+
   jpeg_calc_output_dimensions(&dinfo);
 
   w(dinfo.output_width);
@@ -309,11 +389,16 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
 
   jpeg_start_decompress(&dinfo);
 
+  // read as many scanlines per call as possible, libjpeg returns up to
+  // dinfo.rec_outbuf_height rows at once
   while (dinfo.output_scanline < dinfo.output_height) {
-    row = (JSAMPROW)(array +
-                     dinfo.output_scanline * dinfo.output_width *
-                     dinfo.output_components);
-    jpeg_read_scanlines(&dinfo, &row, (JDIMENSION)1);
+    int n = dinfo.output_height - dinfo.output_scanline;
+    if (n > 16) n = 16;
+    for (int i = 0; i < n; i++)
+      rows[i] = (JSAMPROW)(array +
+                           (dinfo.output_scanline + i) * dinfo.output_width *
+                           dinfo.output_components);
+    jpeg_read_scanlines(&dinfo, rows, (JDIMENSION)n);
   }
 
   jpeg_finish_decompress(&dinfo);
@@ -325,6 +410,10 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
   if (fp)
     fclose(fp);
 
+  // keep the full size as the drawing size of a reduced image
+  if (w() != full_w || h() != full_h)
+    scale(full_w, full_h, 0, 1);
+
   if (sharename && w() && h()) {
     Fl_Shared_Image *si = new Fl_Shared_Image(sharename, this);
     si->add();
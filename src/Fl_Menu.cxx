@@ -25,6 +25,7 @@
 #include <FL/Fl_Menu_Window.H>
 #include <FL/Fl_Menu_.H>
 #include <FL/fl_draw.H>
+#include <FL/Fl_Graphics_Driver.H>
 #include <stdio.h>
 #include "flstring.h"
 
@@ -137,6 +138,7 @@ public:
   int find_selected(int mx, int my);
   int titlex(int);
   void autoscroll(int);
+  void visible_items(int &first, int &last);
   void position(int x, int y);
   int is_inside(int x, int y);
 };
@@ -286,6 +288,117 @@ menutitle::menutitle(int X, int Y, int W, int H, const Fl_Menu_Item* L) :
   if (L->labelcolor_ || Fl::scheme() || L->labeltype_ > FL_NO_LABEL) clear_overlay();
 }
 
+// The measurements of all items of a menu that are needed to size a
+// menuwindow. Measuring the labels of a large menu takes a long time,
+// hence the measurements of the last few menus are kept and reused
+// while the items, their labels, and the fonts don't change.
+struct menu_measure {
+  const Fl_Menu_Item *menu;     // first item of the menu
+  unsigned hash;                // hash of everything the measurements depend on
+  int itemheight;               // height of an item including line spacing
+  int W;                        // width of the widest item
+  int hotKeysw, hotModsw;       // width of the widest shortcut key and modifiers
+  int overlay;                  // whether the menu can be drawn in an overlay
+  unsigned long stamp;          // last use, for replacing the oldest entry
+};
+
+#define MEASURE_CACHE_SIZE 8
+static menu_measure measure_cache[MEASURE_CACHE_SIZE];
+static unsigned long measure_stamp = 0;
+
+static unsigned hash_int(unsigned h, int v) {
+  for (int i = 0; i < 4; i++, v >>= 8) h = (h ^ (v & 0xff)) * 16777619U;
+  return h;
+}
+
+// Return a hash of the visible items of a menu and the settings of the
+// current button that affect their measurements, or 0 if the menu can't
+// be cached because a label is not a text.
+static unsigned hash_menu(const Fl_Menu_Item *m) {
+  unsigned h = 2166136261U;
+  h = hash_int(h, button ? button->textfont() : -1);
+  h = hash_int(h, button ? button->textsize() : -1);
+  h = hash_int(h, FL_NORMAL_SIZE);
+  h = hash_int(h, Fl::menu_linespacing());
+  h = hash_int(h, (int)(fl_intptr_t)Fl::scheme());
+  h = hash_int(h, int(fl_graphics_driver->scale() * 100));
+  for (; m && m->text; m = m->next()) {
+    if (m->labeltype_ > _FL_EMBOSSED_LABEL) return 0;
+    h = hash_int(h, m->labeltype_ | (m->labelcolor_ ? 0x100 : 0) |
+                 (m->flags & (FL_MENU_TOGGLE|FL_MENU_RADIO|FL_SUBMENU|FL_SUBMENU_POINTER)) << 16);
+    h = hash_int(h, m->labelfont_);
+    h = hash_int(h, m->labelsize_);
+    h = hash_int(h, m->shortcut_);
+    for (const char *s = m->text; *s; s++) h = (h ^ (unsigned char)*s) * 16777619U;
+    h = (h ^ 0xff) * 16777619U;
+  }
+  return h ? h : 1;
+}
+
+// Measure the visible items of a menu, or return the cached measurements.
+static const menu_measure *measure_menu(const Fl_Menu_Item *m) {
+  static menu_measure uncached;
+  unsigned h = hash_menu(m);
+  menu_measure *e = &uncached;
+  if (h) {
+    int i;
+    for (i = 0; i < MEASURE_CACHE_SIZE; i++) {
+      e = measure_cache + i;
+      if (e->menu == m && e->hash == h) {
+        e->stamp = ++measure_stamp;
+        return e;
+      }
+    }
+    // replace the oldest entry
+    e = measure_cache;
+    for (i = 1; i < MEASURE_CACHE_SIZE; i++)
+      if (measure_cache[i].stamp < e->stamp) e = measure_cache + i;
+  }
+  e->menu = m;
+  e->hash = h;
+  e->stamp = ++measure_stamp;
+
+  int itemheight = 1;
+  int hotKeysw = 0;
+  int hotModsw = 0;
+  int W = 0;
+  int overlay = 1;
+  if (m) for (; m->text; m = m->next()) {
+    int hh;
+    int w1 = m->measure(&hh, button);
+    if (hh+Fl::menu_linespacing()>itemheight) itemheight = hh+Fl::menu_linespacing();
+    if (m->flags&(FL_SUBMENU|FL_SUBMENU_POINTER))
+      w1 += FL_NORMAL_SIZE;
+    if (w1 > W) W = w1;
+    // calculate the maximum width of all shortcuts
+    if (m->shortcut_) {
+      // s is a pointer to the UTF-8 string for the entire shortcut
+      // k points only to the key part (minus the modifier keys)
+      const char *k, *s = fl_shortcut_label(m->shortcut_, &k);
+      if (fl_utf_nb_char((const unsigned char*)k, (int) strlen(k))<=4) {
+        // a regular shortcut has a right-justified modifier followed by a left-justified key
+        w1 = int(fl_width(s, (int) (k-s)));
+        if (w1 > hotModsw) hotModsw = w1;
+        w1 = int(fl_width(k))+4;
+        if (w1 > hotKeysw) hotKeysw = w1;
+      } else {
+        // a shortcut with a long modifier is right-justified to the menu
+        w1 = int(fl_width(s))+4;
+        if (w1 > (hotModsw+hotKeysw)) {
+          hotModsw = w1-hotKeysw;
+        }
+      }
+    }
+    if (m->labelcolor_ || Fl::scheme() || m->labeltype_ > FL_NO_LABEL) overlay = 0;
+  }
+  e->itemheight = itemheight;
+  e->W = W;
+  e->hotKeysw = hotKeysw;
+  e->hotModsw = hotModsw;
+  e->overlay = overlay;
+  return e;
+}
+
 menuwindow::menuwindow(const Fl_Menu_Item* m, int X, int Y, int Wp, int Hp,
                        const Fl_Menu_Item* picked, const Fl_Menu_Item* t,
                        int menubar, int menubar_title, int right_edge)
@@ -329,42 +442,15 @@ menuwindow::menuwindow(const Fl_Menu_Item* m, int X, int Y, int Wp, int Hp,
     return;
   }
 
-  itemheight = 1;
-
-  int hotKeysw = 0;
-  int hotModsw = 0;
   int Wtitle = 0;
   int Htitle = 0;
   if (t) Wtitle = t->measure(&Htitle, button) + 12;
-  int W = 0;
-  if (m) for (; m->text; m = m->next()) {
-    int hh;
-    int w1 = m->measure(&hh, button);
-    if (hh+Fl::menu_linespacing()>itemheight) itemheight = hh+Fl::menu_linespacing();
-    if (m->flags&(FL_SUBMENU|FL_SUBMENU_POINTER))
-      w1 += FL_NORMAL_SIZE;
-    if (w1 > W) W = w1;
-    // calculate the maximum width of all shortcuts
-    if (m->shortcut_) {
-      // s is a pointer to the UTF-8 string for the entire shortcut
-      // k points only to the key part (minus the modifier keys)
-      const char *k, *s = fl_shortcut_label(m->shortcut_, &k);
-      if (fl_utf_nb_char((const unsigned char*)k, (int) strlen(k))<=4) {
-        // a regular shortcut has a right-justified modifier followed by a left-justified key
-        w1 = int(fl_width(s, (int) (k-s)));
-        if (w1 > hotModsw) hotModsw = w1;
-        w1 = int(fl_width(k))+4;
-        if (w1 > hotKeysw) hotKeysw = w1;
-      } else {
-        // a shortcut with a long modifier is right-justified to the menu
-        w1 = int(fl_width(s))+4;
-        if (w1 > (hotModsw+hotKeysw)) {
-          hotModsw = w1-hotKeysw;
-        }
-      }
-    }
-    if (m->labelcolor_ || Fl::scheme() || m->labeltype_ > FL_NO_LABEL) clear_overlay();
-  }
+  const menu_measure *mm = measure_menu(m);
+  itemheight = mm->itemheight;
+  int W = mm->W;
+  int hotKeysw = mm->hotKeysw;
+  int hotModsw = mm->hotModsw;
+  if (!mm->overlay) clear_overlay();
   shortcutWidth = hotKeysw;
   if (selected >= 0 && !Wp) X -= W/2;
   int BW = Fl::box_dx(box());
@@ -450,6 +536,8 @@ void menuwindow::autoscroll(int n) {
   }
   Fl_Menu_Window::position(x(), y()+Y);
   // y(y()+Y); // don't wait for response from X
+  // draw() skipped the items that were off screen:
+  redraw();
 }
 
 ////////////////////////////////////////////////////////////////
@@ -513,8 +601,13 @@ void menuwindow::draw() {
   if (damage() != FL_DAMAGE_CHILD) {    // complete redraw
     fl_draw_box(box(), 0, 0, w(), h(), button ? button->color() : color());
     if (menu) {
+      // large menus can be much higher than the screen, draw only the
+      // items in the visible part of the window
+      int first, last;
+      visible_items(first, last);
       const Fl_Menu_Item* m; int j;
-      for (m=menu->first(), j=0; m->text; j++, m = m->next()) drawentry(m, j, 0);
+      for (m=menu->first(), j=0; m->text && j <= last; j++, m = m->next())
+        if (j >= first) drawentry(m, j, 0);
     }
   } else {
     if (damage() & FL_DAMAGE_CHILD && selected!=drawn_selected) { // change selection
@@ -525,6 +618,34 @@ void menuwindow::draw() {
   drawn_selected = selected;
 }
 
+// Find the first and last item in the part of the window that is on
+// any screen and inside the current clip region.
+void menuwindow::visible_items(int &first, int &last) {
+  first = 0;
+  last = numitems - 1;
+  if (!itemheight) return; // menubar
+  int top = h(), bottom = 0;
+  for (int i = 0; i < Fl::screen_count(); i++) {
+    int sx, sy, sw, sh;
+    Fl::screen_xywh(sx, sy, sw, sh, i);
+    if (sx >= x() + w() || sx + sw <= x()) continue;
+    if (sy - y() < top) top = sy - y();
+    if (sy + sh - y() > bottom) bottom = sy + sh - y();
+  }
+  if (top < 0) top = 0;
+  if (bottom > h()) bottom = h();
+  if (bottom <= top) return; // unknown screen layout, draw all items
+  int X, Y, W, H;
+  fl_clip_box(0, top, w(), bottom - top, X, Y, W, H);
+  if (H <= 0) { last = -1; return; }
+  // dividers and the selection box may extend into the neighbor items
+  int BW = Fl::box_dx(box());
+  int f = (Y - BW - 1) / itemheight - 1;
+  int l = (Y + H - BW - 1) / itemheight + 1;
+  if (f > first) first = f;
+  if (l < last) last = l;
+}
+
 void menuwindow::set_selected(int n) {
   if (n != selected) {selected = n; damage(FL_DAMAGE_CHILD);}
 }
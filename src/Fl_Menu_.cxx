@@ -23,12 +23,282 @@
 
 #include <FL/Fl.H>
 #include <FL/Fl_Menu_.H>
+#include <FL/fl_utf8.h>
 #include "flstring.h"
 #include <stdio.h>
 #include <stdlib.h>
 
 #define SAFE_STRCAT(s) { len += (int) strlen(s); if ( len >= namelen ) { *name='\0'; return(-2); } else strcat(name,(s)); }
 
+////////////////////////////////////////////////////////////////
+// Shortcut table
+
+// The table holds all items with a shortcut, sorted by their key (without
+// modifiers) and then by the order in which Fl_Menu_Item::test_shortcut()
+// would find them: the items of a (sub)menu come first, followed by the
+// items of its submenus in the order of the submenus.
+class Fl_Menu_Shortcuts {
+public:
+  struct Entry {
+    unsigned key;               // shortcut & FL_KEY_MASK
+    int rank;                   // search order of Fl_Menu_Item::test_shortcut()
+    int parent;                 // index of the submenu in submenus or -1
+    const Fl_Menu_Item *item;
+  };
+  struct Submenu {
+    int parent;                 // index of the parent submenu or -1
+    const Fl_Menu_Item *item;
+  };
+  const Fl_Menu_Item *menu;     // menu() the table was built for or NULL
+  Entry *entries;
+  int num_entries, alloc_entries;
+  Submenu *submenus;
+  int num_submenus, alloc_submenus;
+
+  Fl_Menu_Shortcuts() :
+    menu(0),
+    entries(0), num_entries(0), alloc_entries(0),
+    submenus(0), num_submenus(0), alloc_submenus(0) {}
+  ~Fl_Menu_Shortcuts() {
+    free(entries);
+    free(submenus);
+  }
+  void build(const Fl_Menu_Item *m);
+  const Fl_Menu_Item *find() const;
+
+private:
+  void add_level(const Fl_Menu_Item *m, int parent, int depth);
+  int find(unsigned key) const;
+  int active(int parent) const;
+};
+
+// Advance to the next item of a menu array, skipping the contents of
+// submenus (same as next_visible_or_not() in Fl_Menu.cxx).
+static const Fl_Menu_Item *next_item(const Fl_Menu_Item *m) {
+  int nest = 0;
+  do {
+    if (!m->text) {
+      if (!nest) return m;
+      nest--;
+    } else if (m->flags & FL_SUBMENU) {
+      nest++;
+    }
+    m++;
+  } while (nest);
+  return m;
+}
+
+static int compare_entries(const void *a, const void *b) {
+  const Fl_Menu_Shortcuts::Entry *ea = (const Fl_Menu_Shortcuts::Entry *)a;
+  const Fl_Menu_Shortcuts::Entry *eb = (const Fl_Menu_Shortcuts::Entry *)b;
+  if (ea->key != eb->key) return ea->key < eb->key ? -1 : 1;
+  return ea->rank - eb->rank;
+}
+
+// Add all items of one (sub)menu level, then all of its submenus.
+void Fl_Menu_Shortcuts::add_level(const Fl_Menu_Item *first, int parent, int depth) {
+  const Fl_Menu_Item *m;
+  if (!first || depth > 64) return; // protect against FL_SUBMENU_POINTER loops
+  for (m = first; m->text; m = next_item(m)) {
+    if (!(m->shortcut_ & FL_KEY_MASK)) continue;
+    if (num_entries >= alloc_entries) {
+      alloc_entries = alloc_entries ? 2 * alloc_entries : 64;
+      entries = (Entry *)realloc(entries, alloc_entries * sizeof(Entry));
+    }
+    Entry &e = entries[num_entries];
+    e.key = m->shortcut_ & FL_KEY_MASK;
+    e.rank = num_entries++;
+    e.parent = parent;
+    e.item = m;
+  }
+  for (m = first; m->text; m = next_item(m)) {
+    if (!m->submenu()) continue;
+    if (num_submenus >= alloc_submenus) {
+      alloc_submenus = alloc_submenus ? 2 * alloc_submenus : 16;
+      submenus = (Submenu *)realloc(submenus, alloc_submenus * sizeof(Submenu));
+    }
+    submenus[num_submenus].parent = parent;
+    submenus[num_submenus].item = m;
+    add_level((m->flags & FL_SUBMENU) ? m + 1 : (const Fl_Menu_Item *)m->user_data_,
+              num_submenus++, depth + 1);
+  }
+}
+
+void Fl_Menu_Shortcuts::build(const Fl_Menu_Item *m) {
+  menu = m;
+  num_entries = num_submenus = 0;
+  add_level(m, -1, 0);
+  qsort(entries, num_entries, sizeof(Entry), compare_entries);
+}
+
+// Return the index of the first entry with the given key or -1.
+int Fl_Menu_Shortcuts::find(unsigned key) const {
+  int lo = 0, hi = num_entries;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (entries[mid].key < key) lo = mid + 1;
+    else hi = mid;
+  }
+  return (lo < num_entries && entries[lo].key == key) ? lo : -1;
+}
+
+// Return whether all submenus up to the top level are active.
+int Fl_Menu_Shortcuts::active(int parent) const {
+  for (; parent >= 0; parent = submenus[parent].parent)
+    if (!submenus[parent].item->active()) return 0;
+  return 1;
+}
+
+// Same as menu->test_shortcut(), but only looks at the items whose key
+// can match the current event.
+const Fl_Menu_Item *Fl_Menu_Shortcuts::find() const {
+  unsigned keys[3];
+  int nkeys = 0, i, k;
+  keys[nkeys++] = Fl::event_key();
+  if (Fl::event_length()) {
+    unsigned c = fl_utf8decode(Fl::event_text(), Fl::event_text() + Fl::event_length(), 0);
+    keys[nkeys++] = c;
+    if (Fl::event_state(FL_CTRL)) keys[nkeys++] = c ^ 0x40;
+  }
+  const Entry *best = 0;
+  for (k = 0; k < nkeys; k++) {
+    for (i = 0; i < k; i++) if (keys[i] == keys[k]) break;
+    if (i < k) continue; // same key already checked
+    for (i = find(keys[k]); i >= 0 && i < num_entries && entries[i].key == keys[k]; i++) {
+      const Entry &e = entries[i];
+      if (best && best->rank < e.rank) break;
+      if (e.item->active() && active(e.parent) && Fl::test_shortcut(e.item->shortcut_)) {
+        best = &e;
+        break;
+      }
+    }
+  }
+  return best ? best->item : 0;
+}
+
+////////////////////////////////////////////////////////////////
+// Pathname table
+
+// The table holds a hash of the pathname of each item as find_index()
+// builds it, the length of the pathname, and the index of the submenu
+// that contains the item. A pathname is found by looking at the items
+// with the same hash and checking their labels and the labels of their
+// parents against the pathname.
+class Fl_Menu_Paths {
+public:
+  const Fl_Menu_Item *menu;     // menu() the table was built for or NULL
+  int num_items, alloc_items;
+  unsigned *hash;               // hash of the pathname of each item
+  int *length;                  // length of the pathname of each item
+  int *parent;                  // index of the submenu of each item or -1
+  int *next;                    // next item with the same hash bucket or -1
+  int *buckets;                 // first item of each hash bucket or -1
+  int num_buckets;              // a power of 2
+
+  Fl_Menu_Paths() :
+    menu(0), num_items(0), alloc_items(0),
+    hash(0), length(0), parent(0), next(0),
+    buckets(0), num_buckets(0) {}
+  ~Fl_Menu_Paths() {
+    free(hash);
+    free(length);
+    free(parent);
+    free(next);
+    free(buckets);
+  }
+  void build(const Fl_Menu_Item *m, int n);
+  int find(const char *pathname) const;
+
+private:
+  int matches(const char *pathname, int len, int t) const;
+};
+
+// FNV-1a hash of string s, continuing from h
+static unsigned hash_string(unsigned h, const char *s) {
+  for (; *s; s++) h = (h ^ (unsigned char)*s) * 16777619U;
+  return h;
+}
+
+#define HASH_SEED 2166136261U
+
+void Fl_Menu_Paths::build(const Fl_Menu_Item *m, int n) {
+  menu = m;
+  num_items = n;
+  if (n > alloc_items) {
+    alloc_items = n;
+    hash = (unsigned *)realloc(hash, n * sizeof(unsigned));
+    length = (int *)realloc(length, n * sizeof(int));
+    parent = (int *)realloc(parent, n * sizeof(int));
+    next = (int *)realloc(next, n * sizeof(int));
+  }
+  int nb = 16;
+  while (nb < n) nb *= 2;
+  if (nb != num_buckets) {
+    num_buckets = nb;
+    buckets = (int *)realloc(buckets, nb * sizeof(int));
+  }
+  int t, b;
+  for (b = 0; b < num_buckets; b++) buckets[b] = -1;
+  // compute the pathnames like find_index() did before the table existed:
+  // a submenu or an item extends the pathname of its submenu, and a
+  // terminator returns to the parent submenu
+  int sub = -1;
+  for (t = 0; t < n; t++) {
+    const Fl_Menu_Item *mi = m + t;
+    if (!(mi->flags & FL_SUBMENU) && !mi->label()) {
+      // end of submenu, not a pathname
+      hash[t] = 0;
+      length[t] = -1;
+      parent[t] = sub;
+      if (sub >= 0) sub = parent[sub];
+      continue;
+    }
+    const char *label = mi->label() ? mi->label() : "";
+    unsigned h = HASH_SEED;
+    int len = 0;
+    if (sub >= 0 && length[sub] > 0) {
+      h = hash_string(hash[sub], "/");
+      len = length[sub] + 1;
+    }
+    hash[t] = hash_string(h, label);
+    length[t] = len + (int)strlen(label);
+    parent[t] = sub;
+    if (mi->flags & FL_SUBMENU) sub = t;
+  }
+  // link the items into the buckets in ascending order
+  for (t = n - 1; t >= 0; t--) {
+    if (length[t] < 0) continue;
+    b = hash[t] & (num_buckets - 1);
+    next[t] = buckets[b];
+    buckets[b] = t;
+  }
+}
+
+// Check whether the first len characters of pathname are the pathname
+// of item t.
+int Fl_Menu_Paths::matches(const char *pathname, int len, int t) const {
+  if (length[t] != len) return 0;
+  const char *label = menu[t].label() ? menu[t].label() : "";
+  int n = (int)strlen(label);
+  if (n > len || strncmp(pathname + len - n, label, n)) return 0;
+  len -= n;
+  int p = parent[t];
+  if (p < 0 || length[p] == 0) return len == 0;
+  return len > 0 && pathname[len - 1] == '/' && matches(pathname, len - 1, p);
+}
+
+// Return the index of the first item with the given pathname or -1.
+int Fl_Menu_Paths::find(const char *pathname) const {
+  if (!num_buckets) return -1;
+  int len = (int)strlen(pathname);
+  unsigned h = hash_string(HASH_SEED, pathname);
+  for (int t = buckets[h & (num_buckets - 1)]; t >= 0; t = next[t])
+    if (hash[t] == h && matches(pathname, len, t)) return t;
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////
+
 /** Get the menu 'pathname' for the specified menuitem.
 
     If finditem==NULL, mvalue() is used (the most recently picked menuitem).
@@ -210,12 +480,20 @@ int Fl_Menu_::find_index(Fl_Callback *cb) const {
 
  To get the menu item pointer for a pathname, use find_item()
 
+ By default this method walks all menu items. Large menus can enable a
+ table of the pathnames with path_table(int) to speed up the search.
+
  \param[in] pathname The path and name of the menu item to find
  \returns        The index of the matching item, or -1 if not found.
- \see            item_pathname()
+ \see            item_pathname(), path_table(int)
 
 */
 int Fl_Menu_::find_index(const char *pathname) const {
+  if (paths_ && menu_) {
+    // the table is rebuilt when needed after the menu was changed
+    if (paths_->menu != menu_) paths_->build(menu_, size());
+    return(paths_->find(pathname));
+  }
   char menupath[1024] = "";     // File/Export
   for ( int t=0; t < size(); t++ ) {
     Fl_Menu_Item *m = menu_ + t;
@@ -387,6 +665,8 @@ Fl_Menu_::Fl_Menu_(int X,int Y,int W,int H,const char* l)
   box(FL_UP_BOX);
   when(FL_WHEN_RELEASE_ALWAYS);
   value_ = menu_ = 0;
+  shortcuts_ = 0;
+  paths_ = 0;
   alloc = 0;
   selection_color(FL_SELECTION_COLOR);
   textfont(FL_HELVETICA);
@@ -440,6 +720,8 @@ void Fl_Menu_::copy(const Fl_Menu_Item* m, void* ud) {
 
 Fl_Menu_::~Fl_Menu_() {
   clear();
+  delete shortcuts_;
+  delete paths_;
 }
 
 // Fl_Menu::add() uses this to indicate the owner of the dynamically-
@@ -464,6 +746,7 @@ void Fl_Menu_::clear() {
   }
   menu_ = 0;
   value_ = 0;
+  menu_changed();
 }
 
 /**
@@ -506,3 +789,75 @@ int Fl_Menu_::clear_submenu(int index) {
   }
   return(0);
 }
+
+/**
+  Enables or disables the shortcut table of the menu.
+
+  By default test_shortcut() walks all menu items and submenus to find
+  an item whose shortcut matches the current keystroke. This can take
+  considerable time for menus with many items, since every unhandled
+  keystroke in a window is tested against all menus of the window.
+
+  If the shortcut table is enabled, the menu keeps the items with a
+  shortcut in a table sorted by key, so only a few items need to be
+  checked. test_shortcut() returns the same item as without the table.
+
+  The table is rebuilt automatically if the menu is changed with any of
+  the methods of this class, e.g. menu(), add(), insert(), remove(),
+  shortcut(int, int), or mode(int, int). If you change the shortcut or
+  the flags of a Fl_Menu_Item directly, call menu_end() afterwards to
+  rebuild the table.
+
+  \param[in] on  non-zero to enable, zero to disable the table
+
+  \since 1.4.0
+*/
+void Fl_Menu_::shortcut_table(int on) {
+  if (on && !shortcuts_) {
+    shortcuts_ = new Fl_Menu_Shortcuts();
+  } else if (!on && shortcuts_) {
+    delete shortcuts_;
+    shortcuts_ = 0;
+  }
+}
+
+/**
+  Enables or disables the pathname table of the menu.
+
+  By default find_index(const char*) and find_item(const char*) walk all
+  menu items and submenus and build the pathname of each item until one
+  matches. This can take considerable time for menus with many items.
+
+  If the pathname table is enabled, the menu keeps a hash of the pathname
+  of each item, so only a few items need to be checked. find_index()
+  returns the same index as without the table.
+
+  The table is rebuilt automatically if the menu is changed with any of
+  the methods of this class, e.g. menu(), add(), insert(), remove(),
+  or replace(). If you change the label of a Fl_Menu_Item directly,
+  call menu_end() afterwards to rebuild the table.
+
+  \param[in] on  non-zero to enable, zero to disable the table
+
+  \since 1.4.0
+*/
+void Fl_Menu_::path_table(int on) {
+  if (on && !paths_) {
+    paths_ = new Fl_Menu_Paths();
+  } else if (!on && paths_) {
+    delete paths_;
+    paths_ = 0;
+  }
+}
+
+// Called whenever the menu array, the shortcut, or the label of an item changes.
+void Fl_Menu_::menu_changed() {
+  if (shortcuts_) shortcuts_->menu = 0;
+  if (paths_) paths_->menu = 0;
+}
+
+const Fl_Menu_Item* Fl_Menu_::test_shortcut() {
+  if (!shortcuts_ || !menu_) return picked(menu()->test_shortcut());
+  if (shortcuts_->menu != menu_) shortcuts_->build(menu_);
+  return picked(shortcuts_->find());
+}
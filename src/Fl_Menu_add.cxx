@@ -402,6 +402,7 @@ int Fl_Menu_::insert(
   int value_offset = (int) (value_-menu_);
   menu_ = local_array; // in case it reallocated it
   if (value_) value_ = menu_+value_offset;
+  menu_changed();
   return r;
 }
 
@@ -442,6 +443,248 @@ int Fl_Menu_::add(const char *str) {
 
 
 
+// Advance to the next item of a menu array, skipping the contents of
+// submenus, but not invisible items (unlike Fl_Menu_Item::next()).
+static const Fl_Menu_Item *next_menu_item(const Fl_Menu_Item *m) {
+  int nest = 0;
+  do {
+    if (!m->text) {
+      if (!nest) return m;
+      nest--;
+    } else if (m->flags & FL_SUBMENU) {
+      nest++;
+    }
+    m++;
+  } while (nest);
+  return m;
+}
+
+// Temporary tree of menu items used by Fl_Menu_::add(const Fl_Menu_Item*, int)
+struct Fl_Menu_Node {
+  Fl_Menu_Item item;            // the item, text is the label
+  const Fl_Menu_Item *old;      // the item in the old menu array or NULL
+  int first, last;              // first and last item of a submenu or -1
+  int next;                     // next item in the same submenu or -1
+  int parent;                   // submenu of the item or -1
+  int hnext;                    // next node in the same hash bucket or -1
+  unsigned hash;                // hash of parent, submenu flag, and label
+};
+
+struct Fl_Menu_Tree {
+  Fl_Menu_Node *nodes;
+  int num_nodes, alloc_nodes;
+  int first, last;              // first and last item of the top level
+  int *buckets;                 // first node of each hash bucket or -1
+  int num_buckets;              // a power of 2
+};
+
+// Hash of a label that matches compare(), i.e. ignores '&' signs
+static unsigned hash_label(int parent, int submenu, const char *label) {
+  unsigned h = 2166136261U ^ (unsigned)parent ^ ((unsigned)submenu << 31);
+  for (; *label; label++)
+    if (*label != '&') h = (h ^ (unsigned char)*label) * 16777619U;
+  return h;
+}
+
+// Return the first visible item with the label in the given submenu,
+// which must be a submenu if submenu is set, or -1.
+static int tree_find(const Fl_Menu_Tree &t, int parent, int submenu, const char *label) {
+  unsigned h = hash_label(parent, submenu, label);
+  for (int i = t.buckets[h & (t.num_buckets - 1)]; i >= 0; i = t.nodes[i].hnext) {
+    const Fl_Menu_Node &n = t.nodes[i];
+    if (n.hash == h && n.parent == parent && n.item.visible() &&
+        ((n.item.flags & FL_SUBMENU) != 0) == submenu && !compare(n.item.text, label))
+      return i;
+  }
+  return -1;
+}
+
+// Append a node to the given submenu, text is not copied.
+static int tree_add(Fl_Menu_Tree &t, int parent, const Fl_Menu_Item &item,
+                    const Fl_Menu_Item *old) {
+  if (t.num_nodes >= t.alloc_nodes) {
+    t.alloc_nodes = t.alloc_nodes ? 2 * t.alloc_nodes : 64;
+    t.nodes = (Fl_Menu_Node *)realloc(t.nodes, t.alloc_nodes * sizeof(Fl_Menu_Node));
+  }
+  int i = t.num_nodes++;
+  Fl_Menu_Node &n = t.nodes[i];
+  n.item = item;
+  n.old = old;
+  n.first = n.last = n.next = -1;
+  n.parent = parent;
+  int &last = parent < 0 ? t.last : t.nodes[parent].last;
+  if (last < 0) (parent < 0 ? t.first : t.nodes[parent].first) = i;
+  else t.nodes[last].next = i;
+  last = i;
+  n.hash = hash_label(parent, (item.flags & FL_SUBMENU) != 0, item.text ? item.text : "");
+  int b = n.hash & (t.num_buckets - 1);
+  // keep the buckets in ascending order, so tree_find() finds the first item
+  int *p = &t.buckets[b];
+  while (*p >= 0) p = &t.nodes[*p].hnext;
+  *p = i;
+  t.nodes[i].hnext = -1;
+  return i;
+}
+
+// Add the items of an existing (sub)menu array to the tree.
+static void tree_add_menu(Fl_Menu_Tree &t, int parent, const Fl_Menu_Item *m) {
+  for (; m->text; m = next_menu_item(m)) {
+    int i = tree_add(t, parent, *m, m);
+    if (m->flags & FL_SUBMENU) tree_add_menu(t, i, m + 1);
+  }
+}
+
+// Write the items of a (sub)menu and its terminator to the array,
+// returns the next free position.
+static int tree_write(const Fl_Menu_Tree &t, int first, Fl_Menu_Item *array, int pos,
+                      const Fl_Menu_Item *value, const Fl_Menu_Item *&new_value,
+                      int node, int &node_pos) {
+  for (int i = first; i >= 0; i = t.nodes[i].next) {
+    const Fl_Menu_Node &n = t.nodes[i];
+    if (n.old && n.old == value) new_value = array + pos;
+    if (i == node) node_pos = pos;
+    array[pos++] = n.item;
+    if (n.item.flags & FL_SUBMENU)
+      pos = tree_write(t, n.first, array, pos, value, new_value, node, node_pos);
+  }
+  memset(array + pos, 0, sizeof(Fl_Menu_Item));
+  return pos + 1;
+}
+
+/**
+  Adds many menu items at once.
+
+  This is the same as calling add(const char*, int, Fl_Callback*, void*, int)
+  with the text, shortcut, callback, user data, and flags of each of the
+  \p n items in \p items, but much faster for many items. The text of each
+  item is a label or a menu pathname as described for add(). Submenus are
+  created from the pathnames as needed, and an existing item with the same
+  pathname is replaced.
+
+  Use this method to build large dynamic menus, for instance a menu of
+  recently used files or objects. add() needs to look at all items in a
+  submenu and to move all following items for each new item, whereas
+  this method looks up the submenus in a hash table and builds the new
+  menu array in one pass.
+
+  \b Example:
+  \code
+    Fl_Menu_Item items[] = {
+      { "File/&Open",       FL_COMMAND+'o', open_cb },
+      { "File/Recent/a.txt", 0,             recent_cb, (void*)"a.txt" },
+      { "File/Recent/b.txt", 0,             recent_cb, (void*)"b.txt" },
+      { "Edit/&Copy",       FL_COMMAND+'c', copy_cb }
+    };
+    menubar->add(items, 4);
+  \endcode
+
+  \param[in] items array of items, the text of all items must not be NULL
+  \param[in] n number of items in \p items
+  \returns the index into the menu() array of the last item added
+  \see add(const char*, int, Fl_Callback*, void*, int)
+  \since 1.4.0
+*/
+int Fl_Menu_::add(const Fl_Menu_Item *items, int n) {
+  if (n <= 0) return -1;
+  if (this == fl_menu_array_owner) menu_end();
+
+  // estimate the number of nodes, every '/' may start a new submenu:
+  int i, old_size = size(), max_nodes = old_size + n;
+  const char *p;
+  for (i = 0; i < n; i++)
+    for (p = items[i].text; *p; p++) if (*p == '/') max_nodes++;
+
+  Fl_Menu_Tree t;
+  t.nodes = 0;
+  t.num_nodes = t.alloc_nodes = 0;
+  t.first = t.last = -1;
+  for (t.num_buckets = 16; t.num_buckets < max_nodes; t.num_buckets *= 2) { }
+  t.buckets = (int *)malloc(t.num_buckets * sizeof(int));
+  for (i = 0; i < t.num_buckets; i++) t.buckets[i] = -1;
+  if (menu_) tree_add_menu(t, -1, menu_);
+
+  // the same parsing as in Fl_Menu_Item::insert():
+  char *buf = 0;
+  int buf_size = 0, node = -1;
+  for (i = 0; i < n; i++) {
+    const char *mytext = items[i].text;
+    int myflags = items[i].flags;
+    int flags1 = 0, parent = -1;
+    const char *item;
+    int len = (int)strlen(mytext) + 1;
+    if (len > buf_size) {
+      buf_size = len;
+      buf = (char *)realloc(buf, buf_size);
+    }
+    // split at slashes to make submenus:
+    for (;;) {
+      // leading slash makes us assume it is a filename:
+      if (*mytext == '/') {item = mytext; break;}
+      // leading underscore causes divider line:
+      if (*mytext == '_') {mytext++; flags1 = FL_MENU_DIVIDER;}
+      // copy to buf, changing \x to x:
+      char *q = buf;
+      for (p = mytext; *p && *p != '/'; *q++ = *p++) if (*p=='\\' && p[1]) p++;
+      *q = 0;
+      item = buf;
+      if (*p != '/') break; // not a menu title
+      mytext = p + 1;       // point at item title
+      // find a matching menu title or create a new menu:
+      int m = tree_find(t, parent, 1, item);
+      if (m < 0) {
+        Fl_Menu_Item sub;
+        memset(&sub, 0, sizeof(sub));
+        sub.text = fl_strdup(item);
+        sub.flags = FL_SUBMENU|flags1;
+        sub.labelfont_ = FL_HELVETICA;
+        m = tree_add(t, parent, sub, 0);
+      }
+      parent = m;
+      flags1 = 0;
+    }
+    // find a matching menu item or add a new one, new submenus are always added:
+    node = (myflags & FL_SUBMENU) ? -1 : tree_find(t, parent, 0, item);
+    if (node < 0) {
+      Fl_Menu_Item mi;
+      memset(&mi, 0, sizeof(mi));
+      mi.text = fl_strdup(item);
+      mi.flags = myflags|flags1;    // the hash depends on FL_SUBMENU
+      mi.labelfont_ = FL_HELVETICA;
+      node = tree_add(t, parent, mi, 0);
+    }
+    // fill it in:
+    Fl_Menu_Item &m = t.nodes[node].item;
+    m.shortcut_ = items[i].shortcut_;
+    m.callback_ = items[i].callback_;
+    m.user_data_ = items[i].user_data_;
+    m.flags = myflags|flags1;
+  }
+  free(buf);
+
+  // count the items and terminators and write the new menu array:
+  int num = 1;
+  for (i = 0; i < t.num_nodes; i++)
+    num += (t.nodes[i].item.flags & FL_SUBMENU) ? 2 : 1;
+  Fl_Menu_Item *array = new Fl_Menu_Item[num];
+  // value() may also point into a submenu array (FL_SUBMENU_POINTER):
+  const Fl_Menu_Item *new_value =
+    (value_ >= menu_ && value_ < menu_ + old_size) ? 0 : value_;
+  int node_pos = -1;
+  tree_write(t, t.first, array, 0, value_, new_value, node, node_pos);
+  free(t.nodes);
+  free(t.buckets);
+
+  // replace the old array, the strings are now owned by the new array:
+  if (!menu_) alloc = 2;        // indicates that the strings can be freed
+  else if (!alloc) alloc = 1;   // a user-provided static array, as copy() does
+  else delete[] menu_;
+  menu_ = array;
+  value_ = new_value;
+  menu_changed();
+  return node_pos;
+}
+
+
 /**
   Changes the text of item \p i.  This is the only way to get
   slash into an add()'ed menu item.  If the menu array was directly set
@@ -458,6 +701,7 @@ void Fl_Menu_::replace(int i, const char *str) {
       str = fl_strdup(str?str:"");
   }
   menu_[i].text = str;
+  menu_changed();
 }
 
 
@@ -484,6 +728,7 @@ void Fl_Menu_::remove(int i) {
   }
   // MRS: "n" is the menu size(), which includes the trailing NULL entry...
   memmove(item, next_item, (menu_+n-next_item)*sizeof(Fl_Menu_Item));
+  menu_changed();
 }
 
 /**
@@ -522,5 +767,6 @@ const Fl_Menu_Item *Fl_Menu_::menu_end() {
       value_ = newMenu + value_offset;
     fl_menu_array_owner = 0;
   }
+  menu_changed();
   return menu_;
 }
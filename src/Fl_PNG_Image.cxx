@@ -35,6 +35,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
 extern "C"
@@ -91,6 +92,32 @@ Fl_PNG_Image::Fl_PNG_Image (const char *filename): Fl_RGB_Image(0,0,0)
 }
 
 
+/**
+ The constructor loads a PNG image file at reduced resolution.
+
+ The image is decoded row by row and each row is immediately averaged into
+ blocks of n x n pixels, where n is the largest integer factor that still
+ yields at least \p W x \p H pixels. Only the reduced image is kept in
+ memory, hence even huge images can be loaded as thumbnails. Interlaced
+ images are handled as well.
+
+ The image data is stored at the reduced resolution, i.e. data_w() and
+ data_h() are the reduced size, whereas w() and h() are the full size of the
+ image (see Fl_Image::scale()). If \p W or \p H is 0 or the image is not
+ larger than twice the requested size, the image is loaded at full resolution.
+
+ \param[in] filename  Name of PNG file to read
+ \param[in] W, H      minimum size of the image data in pixels
+
+ \see Fl_Shared_Image::get(const char *name, int W, int H)
+ \since 1.4.0
+ */
+Fl_PNG_Image::Fl_PNG_Image (const char *filename, int W, int H): Fl_RGB_Image(0,0,0)
+{
+  load_png_(filename, NULL, 0, W, H);
+}
+
+
 /**
  \brief Constructor that reads a PNG image from memory.
 
@@ -110,7 +137,48 @@ Fl_PNG_Image::Fl_PNG_Image (
 }
 
 
-void Fl_PNG_Image::load_png_(const char *name_png, const unsigned char *buffer_png, int maxsize)
+/**
+ Reads the size of a PNG image file without decoding the image.
+
+ Only the PNG signature and the image header are read, which is much
+ faster than loading the image if only its size is needed, e.g. for
+ the layout of a window that shows the image later.
+
+ \param[in]  filename  Name of PNG file to read
+ \param[out] W, H      size of the image, 0 on error
+ \returns 0 on success, Fl_Image::ERR_FILE_ACCESS if the file could not be
+   opened or read, or Fl_Image::ERR_FORMAT if it is not a PNG file
+
+ \since 1.4.0
+ */
+int Fl_PNG_Image::read_size(const char *filename, int &W, int &H)
+{
+  uchar header[24];     // signature, IHDR chunk length and type, width, height
+  W = H = 0;
+  FILE *fp = fl_fopen(filename, "rb");
+  if (!fp) return ERR_FILE_ACCESS;
+  size_t n = fread(header, 1, sizeof(header), fp);
+  fclose(fp);
+  if (n < sizeof(header)) return ERR_FILE_ACCESS;
+  if (memcmp(header, "\211PNG\r\n\032\n", 8) || memcmp(header + 12, "IHDR", 4))
+    return ERR_FORMAT;
+  W = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+  H = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+  if (W <= 0 || H <= 0) {
+    W = H = 0;
+    return ERR_FORMAT;
+  }
+  return 0;
+}
+
+
+/*
+ Reads a PNG image from a file or from memory. If W and H are given, the image
+ is reduced by the largest integer factor that yields at least W x H pixels
+ while it is decoded.
+ */
+void Fl_PNG_Image::load_png_(const char *name_png, const unsigned char *buffer_png, int maxsize,
+                             int W, int H)
 {
 #if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
   int i;                // Looping var
@@ -121,10 +189,13 @@ void Fl_PNG_Image::load_png_(const char *name_png, const unsigned char *buffer_p
   fl_png_memory png_mem_data;
   int from_memory = (buffer_png != NULL); // true if reading image from memory
 
-  // Note: The file pointer fp must not be an automatic (stack) variable
-  // to avoid potential clobbering by setjmp/longjmp (gcc: [-Wclobbered]).
-  static FILE *fp;      // intentionally initialized separately below
-  fp = NULL;            // always initialize file pointer
+  // Note: The file pointer fp and the buffers for reduced images must be
+  // volatile to avoid potential clobbering by setjmp/longjmp (gcc:
+  // [-Wclobbered]). They are not static since images may be decoded in
+  // several threads at once (see Fl_Shared_Image::get_async()).
+  FILE * volatile fp = NULL;
+  png_bytep volatile row = NULL;
+  unsigned * volatile sum = NULL;
 
   if (!from_memory) {
     if ((fp = fl_fopen(name_png, "rb")) == NULL) {
@@ -147,6 +218,8 @@ void Fl_PNG_Image::load_png_(const char *name_png, const unsigned char *buffer_p
 
   if (setjmp(png_jmpbuf(pp))) {
     png_destroy_read_struct(&pp, &info, NULL);
+    delete[] row;
+    delete[] sum;
     if (!from_memory) fclose(fp);
     Fl::warning("PNG file or data \"%s\" is too large or contains errors!\n", display_name);
     w(0); h(0); d(0); ld(ERR_FORMAT);
@@ -197,24 +270,95 @@ void Fl_PNG_Image::load_png_(const char *name_png, const unsigned char *buffer_p
     png_set_tRNS_to_alpha(pp);
 #  endif // HAVE_PNG_GET_VALID && HAVE_PNG_SET_TRNS_TO_ALPHA
 
-  if (((size_t)w()) * h() * d() > max_size() ) longjmp(png_jmpbuf(pp), 1);
-  array = new uchar[w() * h() * d()];
-  alloc_array = 1;
+  // Reduce the image by an integer factor if a smaller size was requested,
+  // the factor is limited so that the sums of a block fit into 32 bits
+  int full_w = w(), full_h = h(), f = 1;
+  if (W > 0 && H > 0) {
+    f = full_w / W < full_h / H ? full_w / W : full_h / H;
+    if (f > 4096) f = 4096;
+    if (f < 2) f = 1;
+  }
+
+  if (f == 1) {
+    if (((size_t)w()) * h() * d() > max_size() ) longjmp(png_jmpbuf(pp), 1);
+    array = new uchar[w() * h() * d()];
+    alloc_array = 1;
+
+    // Allocate pointers...
+    rows = new png_bytep[h()];
 
-  // Allocate pointers...
-  rows = new png_bytep[h()];
+    for (i = 0; i < h(); i ++)
+      rows[i] = (png_bytep)(array + i * w() * d());
 
-  for (i = 0; i < h(); i ++)
-    rows[i] = (png_bytep)(array + i * w() * d());
+    // Read the image, handling interlacing as needed...
+    for (i = png_set_interlace_handling(pp); i > 0; i --)
+      png_read_rows(pp, rows, NULL, h());
 
-  // Read the image, handling interlacing as needed...
-  for (i = png_set_interlace_handling(pp); i > 0; i --)
-    png_read_rows(pp, rows, NULL, h());
+    // Free memory...
+    delete[] rows;
+  } else {
+    int dw = (full_w + f - 1) / f, dh = (full_h + f - 1) / f;
+    int x, y, c, n = dw * dh * channels;
+    if (((size_t)dw) * dh * channels > max_size() ) longjmp(png_jmpbuf(pp), 1);
+
+    // Decode one row at a time and add each pixel to the sum of its block.
+    // Interlaced images are read pass by pass without libpng's interlace
+    // handling, which would need the full image; the rows of each pass
+    // contain every col_inc-th pixel of every row_inc-th row.
+    static const int start_row[7] = { 0, 0, 4, 0, 2, 0, 1 };
+    static const int start_col[7] = { 0, 4, 0, 2, 0, 1, 0 };
+    static const int row_inc[7]   = { 8, 8, 8, 4, 4, 2, 2 };
+    static const int col_inc[7]   = { 8, 8, 4, 4, 2, 2, 1 };
+    int passes = (png_get_interlace_type(pp, info) == PNG_INTERLACE_ADAM7) ? 7 : 1;
+    png_read_update_info(pp, info);
+    row = new png_byte[png_get_rowbytes(pp, info)];
+    sum = new unsigned[n];
+    for (i = 0; i < n; i ++) sum[i] = 0;
+    for (int pass = 0; pass < passes; pass ++) {
+      int x0 = 0, y0 = 0, dx = 1, dy = 1;
+      if (passes > 1) {
+        x0 = start_col[pass]; y0 = start_row[pass];
+        dx = col_inc[pass];   dy = row_inc[pass];
+        if (x0 >= full_w || y0 >= full_h) continue; // libpng skips empty passes
+      }
+      for (y = y0; y < full_h; y += dy) {
+        png_read_row(pp, row, NULL);
+        unsigned *s = sum + (y / f) * dw * channels;
+        png_bytep p = row;
+        for (x = x0; x < full_w; x += dx) {
+          unsigned *t = s + (x / f) * channels;
+          for (c = 0; c < channels; c ++) t[c] += *p++;
+        }
+      }
+    }
+
+    // Divide the sums by the number of pixels per block, which is smaller
+    // at the right and bottom edges if the size is not a multiple of f
+    array = new uchar[n];
+    alloc_array = 1;
+    uchar *dst = (uchar *)array;
+    unsigned *src = sum;
+    for (y = 0; y < dh; y ++) {
+      int bh = full_h - y * f < f ? full_h - y * f : f;
+      for (x = 0; x < dw; x ++) {
+        int bw = full_w - x * f < f ? full_w - x * f : f;
+        unsigned count = (unsigned)(bw * bh);
+        for (c = 0; c < channels; c ++) *dst++ = (uchar)((*src++ + count / 2) / count);
+      }
+    }
+    delete[] row;
+    delete[] sum;
+    row = NULL;
+    sum = NULL;
+    w(dw);
+    h(dh);
+  }
 
   if (channels == 4) Fl::system_driver()->png_extra_rgba_processing((uchar*)array, w(), h());
 
-  // Free memory and return...
-  delete[] rows;
+  // Keep the full size as the drawing size of a reduced image
+  if (w() != full_w || h() != full_h)
+    scale(full_w, full_h, 0, 1);
 
   png_read_end(pp, info);
   png_destroy_read_struct(&pp, &info, NULL);
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <sys/stat.h>
 #include <FL/fl_utf8.h>
 #include <FL/fl_string.h>
 #include "flstring.h"
@@ -841,10 +842,40 @@ char Fl_Preferences::getUserdataPath( char *path, int pathlen ) {
  deleting the base preferences flushes automatically.
  */
 void Fl_Preferences::flush() {
+  if ( rootNode )
+    Fl::remove_timeout( RootNode::flushCB, rootNode );
   if ( rootNode && node->dirty() )
     rootNode->write();
 }
 
+/**
+ Writes all preferences to disk after a delay.
+
+ The preferences are written when no other call to flush(double) for the
+ same preferences file happened for \p delay seconds, so an application
+ can call this after every change without writing the file every time.
+ The file is written only if any preferences were changed. Calling flush()
+ or deleting the base preferences group writes pending changes immediately.
+
+ The file is written by a timeout (see Fl::add_timeout()), hence the
+ application must run the FLTK event loop for delayed writes.
+
+ \param[in] delay time in seconds to wait for more changes, if zero or
+    negative the preferences are written immediately
+
+ \see flush()
+ \since 1.4.0
+ */
+void Fl_Preferences::flush( double delay ) {
+  if ( !rootNode ) return;
+  if ( delay <= 0.0 ) {
+    flush();
+    return;
+  }
+  Fl::remove_timeout( RootNode::flushCB, rootNode );
+  Fl::add_timeout( delay, RootNode::flushCB, rootNode );
+}
+
 //-----------------------------------------------------------------------------
 // helper class to create dynamic group and entry names on the fly
 //
@@ -902,6 +933,17 @@ Fl_Preferences::Name::~Name() {
 
 int Fl_Preferences::Node::lastEntrySet = -1;
 
+// nodes with fewer entries or children are searched linearly
+#define HASH_MIN 8
+
+// FNV-1a hash of the first 'len' bytes of a name
+static unsigned hashName( const char *name, int len ) {
+  unsigned h = 2166136261U;
+  for ( int i = 0; i < len; i++ )
+    h = ( h ^ (unsigned char)name[i] ) * 16777619U;
+  return h;
+}
+
 // create the root node
 // - construct the name of the file that will hold our preferences
 Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs, Root root, const char *vendor, const char *application )
@@ -956,6 +998,7 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs )
 
 // destroy the root node and all depending nodes
 Fl_Preferences::RootNode::~RootNode() {
+  Fl::remove_timeout( flushCB, this );
   if ( prefs_->node->dirty() )
     write();
   if ( filename_ ) {
@@ -1023,6 +1066,13 @@ int Fl_Preferences::RootNode::read() {
   return 0;
 }
 
+// timeout callback for Fl_Preferences::flush(double)
+void Fl_Preferences::RootNode::flushCB( void *v ) {
+  RootNode *rn = (RootNode*)v;
+  if ( rn->prefs_->node->dirty() )
+    rn->write();
+}
+
 // write the group tree and all entry leafs
 int Fl_Preferences::RootNode::write() {
   if (!filename_)   // RUNTIME preferences, or filename could not be created
@@ -1034,14 +1084,41 @@ int Fl_Preferences::RootNode::write() {
   if ( ((root_&Fl_Preferences::ROOT_MASK)==Fl_Preferences::SYSTEM) && !(fileAccess_ & Fl_Preferences::SYSTEM_WRITE_OK) )
     return -1;
   fl_make_path_for_file(filename_);
-  FILE *f = fl_fopen( filename_, "wb" );
-  if ( !f )
+  // write a temporary file first and replace the preferences file only
+  // if everything was written, so the file is never left incomplete. If
+  // the file is a symbolic link, the file it points to is replaced, and
+  // the new file gets the permissions of the old one.
+  char *target = Fl::system_driver()->realpath( filename_ );
+  const char *name = target ? target : filename_;
+  struct stat st;
+  int keep_mode = ( fl_stat( name, &st ) == 0 );
+  size_t len = strlen( name );
+  char *tempname = (char*)malloc( len+5 );
+  memcpy( tempname, name, len );
+  strcpy( tempname+len, ".tmp" );
+  FILE *f = fl_fopen( tempname, "wb" );
+  if ( !f ) {
+    free( tempname );
+    free( target );
     return -1;
+  }
   fprintf( f, "; FLTK preferences file format 1.0\n" );
   fprintf( f, "; vendor: %s\n", vendor_ );
   fprintf( f, "; application: %s\n", application_ );
   prefs_->node->write( f );
-  fclose( f );
+  int err = ferror( f );
+  if ( fclose( f ) )
+    err = 1;
+  if ( !err && keep_mode )
+    fl_chmod( tempname, st.st_mode & 07777 );
+  if ( !err && Fl::system_driver()->rename_replace( tempname, name ) )
+    err = 1;
+  if ( err )
+    fl_unlink( tempname );
+  free( tempname );
+  free( target );
+  if ( err )
+    return -1;
   if (Fl::system_driver()->preferences_need_protection_check()) {
     // unix: make sure that system prefs are user-readable
     if (strncmp(filename_, "/etc/fltk/", 10) == 0) {
@@ -1122,6 +1199,10 @@ Fl_Preferences::Node::Node( const char *path ) {
   indexed_ = 0;
   index_ = 0;
   nIndex_ = NIndex_ = 0;
+  entryHash_ = 0;
+  NEntryHash_ = 0;
+  childHash_ = 0;
+  NChildHash_ = 0;
 }
 
 void Fl_Preferences::Node::deleteAllChildren() {
@@ -1152,6 +1233,7 @@ void Fl_Preferences::Node::deleteAllEntries() {
     nEntry_ = 0;
     NEntry_ = 0;
   }
+  deleteEntryHash();
   dirty_ = 1;
 }
 
@@ -1227,6 +1309,14 @@ void Fl_Preferences::Node::setParent( Node *pn ) {
   sprintf( nameBuffer, "%s/%s", pn->path_, path_ );
   free( path_ );
   path_ = fl_strdup( nameBuffer );
+  if ( pn->indexed_ ) {         // append this node to the parent's index
+    if ( pn->nIndex_ >= pn->NIndex_ ) {
+      pn->NIndex_ = 2 * pn->nIndex_ + 16;
+      pn->index_ = (Node**)realloc( pn->index_, pn->NIndex_*sizeof(Node*) );
+    }
+    pn->index_[ pn->nIndex_++ ] = this;
+    pn->addChildHash( pn->nIndex_-1 );
+  }
 }
 
 // find the corresponding root node
@@ -1246,25 +1336,23 @@ Fl_Preferences::Node *Fl_Preferences::Node::addChild( const char *path ) {
   char *name = fl_strdup( nameBuffer );
   Node *nd = find( name );
   free( name );
-  updateIndex();
   return nd;
 }
 
 // create and set, or change an entry within this node
 void Fl_Preferences::Node::set( const char *name, const char *value )
 {
-  for ( int i=0; i<nEntry_; i++ ) {
-    if ( strcmp( name, entry_[i].name ) == 0 ) {
-      if ( !value ) return; // annotation
-      if ( strcmp( value, entry_[i].value ) != 0 ) {
-        if ( entry_[i].value )
-          free( entry_[i].value );
-        entry_[i].value = fl_strdup( value );
-        dirty_ = 1;
-      }
-      lastEntrySet = i;
-      return;
+  int i = getEntry( name );
+  if ( i >= 0 ) {
+    if ( !value ) return; // annotation
+    if ( strcmp( value, entry_[i].value ) != 0 ) {
+      if ( entry_[i].value )
+        free( entry_[i].value );
+      entry_[i].value = fl_strdup( value );
+      dirty_ = 1;
     }
+    lastEntrySet = i;
+    return;
   }
   if ( NEntry_==nEntry_ ) {
     NEntry_ = NEntry_ ? NEntry_*2 : 10;
@@ -1274,6 +1362,7 @@ void Fl_Preferences::Node::set( const char *name, const char *value )
   entry_[ nEntry_ ].value = value?fl_strdup(value):0;
   lastEntrySet = nEntry_;
   nEntry_++;
+  addEntryHash( nEntry_-1 );
   dirty_ = 1;
 }
 
@@ -1318,9 +1407,19 @@ const char *Fl_Preferences::Node::get( const char *name ) {
 
 // find the index of an entry, returns -1 if no such entry
 int Fl_Preferences::Node::getEntry( const char *name ) {
-  for ( int i=0; i<nEntry_; i++ ) {
-    if ( strcmp( name, entry_[i].name ) == 0 ) {
-      return i;
+  if ( nEntry_ < HASH_MIN ) {
+    for ( int i=0; i<nEntry_; i++ ) {
+      if ( strcmp( name, entry_[i].name ) == 0 ) {
+        return i;
+      }
+    }
+    return -1;
+  }
+  if ( !entryHash_ ) createEntryHash();
+  unsigned mask = NEntryHash_ - 1;
+  for ( unsigned h = hashName( name, (int) strlen( name ) ) & mask; entryHash_[h] >= 0; h = (h+1) & mask ) {
+    if ( strcmp( name, entry_[ entryHash_[h] ].name ) == 0 ) {
+      return entryHash_[h];
     }
   }
   return -1;
@@ -1332,6 +1431,7 @@ char Fl_Preferences::Node::deleteEntry( const char *name ) {
   if ( ix == -1 ) return 0;
   memmove( entry_+ix, entry_+ix+1, (nEntry_-ix-1) * sizeof(Entry) );
   nEntry_--;
+  deleteEntryHash();            // indexes have changed
   dirty_ = 1;
   return 1;
 }
@@ -1345,13 +1445,10 @@ Fl_Preferences::Node *Fl_Preferences::Node::find( const char *path ) {
     if ( path[ len ] == 0 )
       return this;
     if ( path[ len ] == '/' ) {
-      Node *nd;
-      for ( nd = child_; nd; nd = nd->next_ ) {
-        Node *nn = nd->find( path );
-        if ( nn ) return nn;
-      }
       const char *s = path+len+1;
       const char *e = strchr( s, '/' );
+      Node *nd = findChild( s, e ? (int)(e-s) : (int) strlen( s ) );
+      if ( nd ) return nd->find( path );
       if (e) strlcpy( nameBuffer, s, e-s+1 );
       else strlcpy( nameBuffer, s, sizeof(nameBuffer));
       nd = new Node( nameBuffer );
@@ -1364,40 +1461,51 @@ Fl_Preferences::Node *Fl_Preferences::Node::find( const char *path ) {
 }
 
 // find a group somewhere in the tree starting here
-// caller must not set 'offset' argument
+// the 'offset' argument is no longer used
 // - if the node does not exist, 'search' returns NULL
 // - if the pathname is "." (current node) return this node
 // - if the pathname is "./" (root node) return the topmost node
 // - if the pathname starts with "./", start the search at the root node instead
 Fl_Preferences::Node *Fl_Preferences::Node::search( const char *path, int offset ) {
-  if ( offset == 0 ) {
-    if ( path[0] == '.' ) {
-      if ( path[1] == 0 ) {
-        return this; // user was searching for current node
-      } else if ( path[1] == '/' ) {
-        Node *nn = this;
-        while ( nn->parent() ) nn = nn->parent();
-        if ( path[2]==0 ) {             // user is searching for root ( "./" )
-          return nn;
-        }
-        return nn->search( path+2, 2 ); // do a relative search on the root node
+  Node *nd = this;
+  if ( path[0] == '.' ) {
+    if ( path[1] == 0 ) {
+      return this; // user was searching for current node
+    } else if ( path[1] == '/' ) {
+      while ( nd->parent() ) nd = nd->parent();
+      if ( path[2]==0 ) {               // user is searching for root ( "./" )
+        return nd;
       }
+      path += 2;                        // do a relative search on the root node
     }
-    offset = (int) strlen( path_ ) + 1;
   }
-  int len = (int) strlen( path_ );
-  if ( len < offset-1 ) return 0;
-  len -= offset;
-  if ( ( len <= 0 ) || ( strncmp( path, path_+offset, len ) == 0 ) ) {
-    if ( len > 0 && path[ len ] == 0 )
-      return this;
-    if ( len <= 0 || path[ len ] == '/' ) {
-      for ( Node *nd = child_; nd; nd = nd->next_ ) {
-        Node *nn = nd->search( path, offset );
-        if ( nn ) return nn;
-      }
-      return 0;
+  if ( path[0] == 0 ) return 0;
+  for (;;) {
+    const char *e = strchr( path, '/' );
+    nd = nd->findChild( path, e ? (int)(e-path) : (int) strlen( path ) );
+    if ( !nd || !e ) return nd;
+    path = e+1;
+  }
+}
+
+// find a child node by name, 'name' does not need to be terminated after 'len' bytes
+Fl_Preferences::Node *Fl_Preferences::Node::findChild( const char *name, int len ) {
+  createIndex();
+  if ( nIndex_ < HASH_MIN ) {
+    for ( int i = 0; i < nIndex_; i++ ) {
+      const char *nm = index_[i]->name();
+      if ( strncmp( nm, name, len ) == 0 && nm[len] == 0 )
+        return index_[i];
     }
+    return 0;
+  }
+  if ( !childHash_ ) createChildHash();
+  unsigned mask = NChildHash_ - 1;
+  for ( unsigned h = hashName( name, len ) & mask; childHash_[h] >= 0; h = (h+1) & mask ) {
+    Node *nd = index_[ childHash_[h] ];
+    const char *nm = nd->name();
+    if ( strncmp( nm, name, len ) == 0 && nm[len] == 0 )
+      return nd;
   }
   return 0;
 }
@@ -1491,6 +1599,7 @@ void Fl_Preferences::Node::createIndex() {
 
 void Fl_Preferences::Node::updateIndex() {
   indexed_ = 0;
+  deleteChildHash();
 }
 
 void Fl_Preferences::Node::deleteIndex() {
@@ -1498,6 +1607,79 @@ void Fl_Preferences::Node::deleteIndex() {
   NIndex_ = nIndex_ = 0;
   index_ = 0;
   indexed_ = 0;
+  deleteChildHash();
+}
+
+// Entries and children of nodes with many names are found through hash
+// tables of their indexes in entry_ and index_. Free slots are -1.
+// A table is built when it is first needed and kept at most half full.
+
+void Fl_Preferences::Node::createEntryHash() {
+  int n = 32;
+  while ( n < 2*nEntry_ ) n *= 2;
+  NEntryHash_ = n;
+  entryHash_ = (int*)realloc( entryHash_, n*sizeof(int) );
+  memset( entryHash_, 0xff, n*sizeof(int) );
+  unsigned mask = n - 1;
+  for ( int i = 0; i < nEntry_; i++ ) {
+    unsigned h = hashName( entry_[i].name, (int) strlen( entry_[i].name ) ) & mask;
+    while ( entryHash_[h] >= 0 ) h = (h+1) & mask;
+    entryHash_[h] = i;
+  }
+}
+
+// add the entry 'ix' to the hash table if there is one
+void Fl_Preferences::Node::addEntryHash( int ix ) {
+  if ( !entryHash_ ) return;
+  if ( 2*nEntry_ > NEntryHash_ ) {
+    createEntryHash();
+    return;
+  }
+  unsigned mask = NEntryHash_ - 1;
+  unsigned h = hashName( entry_[ix].name, (int) strlen( entry_[ix].name ) ) & mask;
+  while ( entryHash_[h] >= 0 ) h = (h+1) & mask;
+  entryHash_[h] = ix;
+}
+
+void Fl_Preferences::Node::deleteEntryHash() {
+  if ( entryHash_ ) free( entryHash_ );
+  entryHash_ = 0;
+  NEntryHash_ = 0;
+}
+
+void Fl_Preferences::Node::createChildHash() {
+  int n = 32;
+  while ( n < 2*nIndex_ ) n *= 2;
+  NChildHash_ = n;
+  childHash_ = (int*)realloc( childHash_, n*sizeof(int) );
+  memset( childHash_, 0xff, n*sizeof(int) );
+  unsigned mask = n - 1;
+  for ( int i = 0; i < nIndex_; i++ ) {
+    const char *nm = index_[i]->name();
+    unsigned h = hashName( nm, (int) strlen( nm ) ) & mask;
+    while ( childHash_[h] >= 0 ) h = (h+1) & mask;
+    childHash_[h] = i;
+  }
+}
+
+// add the child 'ix' in index_ to the hash table if there is one
+void Fl_Preferences::Node::addChildHash( int ix ) {
+  if ( !childHash_ ) return;
+  if ( 2*nIndex_ > NChildHash_ ) {
+    createChildHash();
+    return;
+  }
+  unsigned mask = NChildHash_ - 1;
+  const char *nm = index_[ix]->name();
+  unsigned h = hashName( nm, (int) strlen( nm ) ) & mask;
+  while ( childHash_[h] >= 0 ) h = (h+1) & mask;
+  childHash_[h] = ix;
+}
+
+void Fl_Preferences::Node::deleteChildHash() {
+  if ( childHash_ ) free( childHash_ );
+  childHash_ = 0;
+  NChildHash_ = 0;
 }
 
 /**
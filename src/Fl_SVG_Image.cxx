@@ -25,6 +25,7 @@
 #include "Fl_Screen_Driver.H"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if !defined(HAVE_LONG_LONG)
 static double strtoll(const char *str, char **endptr, int base) {
@@ -43,6 +44,39 @@ static double strtoll(const char *str, char **endptr, int base) {
 #include <zlib.h>
 #endif
 
+// Rasterizations of an SVG image are kept in a short list shared by all copies
+// of the image, so that drawing the same image alternately at a few sizes (e.g.,
+// at several zoom levels or as 16, 24 and 32 pixel icons) does not run the
+// rasterizer each time.
+//
+// Rasterization runs in the thread that draws or resizes the image. Workers
+// of Fl_Shared_Image::get_async() only parse SVG files, so the shared
+// rasterizer and the cache are not locked. A raster is not split into bands
+// for several threads: the detached workers of fl_thread.h can't be joined
+// without polling, and nanosvg would scan the edges of all paths for each band,
+// which takes most of the time for icon sizes.
+#define RASTER_CACHE_MAX 4              // max number of cached rasters per image
+#define RASTER_CACHE_PIXELS (1024*1024) // larger rasters are not cached
+
+struct Fl_SVG_Raster {
+  int w, h, d;                  // d() after desaturate() is 2
+  double fx, fy;                // scaling factors used by the rasterizer
+  bool desaturate;              // desaturate() was applied
+  float average_weight;         // color_average() was applied if < 1
+  Fl_Color average_color;
+  uchar *array;
+  Fl_SVG_Raster *next;
+};
+
+static void free_rasters(Fl_SVG_Raster *r) {
+  while (r) {
+    Fl_SVG_Raster *next = r->next;
+    delete[] r->array;
+    delete r;
+    r = next;
+  }
+}
+
 /** The constructor loads the SVG image from the given .svg/.svgz filename or in-memory data.
  \param filename Name of a .svg or .svgz file, or NULL.
  \param svg_data A pointer to the memory location of the SVG image data.
@@ -64,6 +98,7 @@ Fl_SVG_Image::Fl_SVG_Image(Fl_SVG_Image *source) : Fl_RGB_Image(NULL, 0, 0, 4) {
 Fl_SVG_Image::~Fl_SVG_Image() {
   if ( --counted_svg_image_->ref_count <= 0) {
     nsvgDelete(counted_svg_image_->svg_image);
+    free_rasters(counted_svg_image_->rasters);
     delete counted_svg_image_;
   }
 }
@@ -124,9 +159,11 @@ void Fl_SVG_Image::init_(const char *filename, const char *in_filedata, Fl_SVG_I
     counted_svg_image_ = new counted_NSVGimage;
     counted_svg_image_->svg_image = NULL;
     counted_svg_image_->ref_count = 1;
+    counted_svg_image_->rasters = NULL;
   }
   char *filedata = NULL;
   to_desaturate_ = false;
+  average_color_ = FL_GRAY;
   average_weight_ = 1;
   proportional = true;
   if (filename) {
@@ -183,13 +220,53 @@ void Fl_SVG_Image::rasterize_(int W, int H) {
     fx = (double)W / counted_svg_image_->svg_image->width;
     fy = (double)H / counted_svg_image_->svg_image->height;
   }
-  array = new uchar[W*H*4];
-  nsvgRasterizeXY(rasterizer, counted_svg_image_->svg_image, 0, 0, fx, fy, (uchar* )array, W, H, W*4);
-  alloc_array = 1;
-  data((const char * const *)&array, 1);
-  d(4);
-  if (to_desaturate_) Fl_RGB_Image::desaturate();
-  if (average_weight_ < 1) Fl_RGB_Image::color_average(average_color_, average_weight_);
+  // look for a previous rasterization with the same parameters
+  Fl_SVG_Raster **pr, *r = NULL;
+  int count = 0;
+  for (pr = &counted_svg_image_->rasters; *pr; pr = &(*pr)->next, count++) {
+    r = *pr;
+    if (r->w == W && r->h == H && r->fx == fx && r->fy == fy &&
+        r->desaturate == to_desaturate_ && r->average_weight == average_weight_ &&
+        (average_weight_ >= 1 || r->average_color == average_color_)) break;
+  }
+  if (*pr) { // found: move it to the front of the list
+    *pr = r->next;
+    r->next = counted_svg_image_->rasters;
+    counted_svg_image_->rasters = r;
+    array = new uchar[W*H*r->d];
+    memcpy((uchar*)array, r->array, W*H*r->d);
+    alloc_array = 1;
+    data((const char * const *)&array, 1);
+    d(r->d);
+  } else {
+    array = new uchar[W*H*4];
+    nsvgRasterizeXY(rasterizer, counted_svg_image_->svg_image, 0, 0, fx, fy, (uchar* )array, W, H, W*4);
+    alloc_array = 1;
+    data((const char * const *)&array, 1);
+    d(4);
+    if (to_desaturate_) Fl_RGB_Image::desaturate();
+    if (average_weight_ < 1) Fl_RGB_Image::color_average(average_color_, average_weight_);
+    if (W*H <= RASTER_CACHE_PIXELS) {
+      if (count >= RASTER_CACHE_MAX) { // drop the least recently used raster
+        for (pr = &counted_svg_image_->rasters; (*pr)->next; pr = &(*pr)->next) {}
+        free_rasters(*pr);
+        *pr = NULL;
+      }
+      r = new Fl_SVG_Raster;
+      r->w = W;
+      r->h = H;
+      r->fx = fx;
+      r->fy = fy;
+      r->desaturate = to_desaturate_;
+      r->average_weight = average_weight_;
+      r->average_color = average_color_;
+      r->d = d();
+      r->array = new uchar[W*H*r->d];
+      memcpy(r->array, array, W*H*r->d);
+      r->next = counted_svg_image_->rasters;
+      counted_svg_image_->rasters = r;
+    }
+  }
   rasterized_ = true;
   raster_w_ = W;
   raster_h_ = H;
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <FL/fl_utf8.h>
+#include <FL/fl_string.h>
 #include "flstring.h"
 
 #include <FL/Fl.H>
@@ -25,6 +26,7 @@
 #include <FL/Fl_XPM_Image.H>
 #include <FL/Fl_Preferences.H>
 #include <FL/fl_draw.H>
+#include "fl_thread.h"
 
 //
 // Global class vars...
@@ -38,6 +40,17 @@ Fl_Shared_Handler *Fl_Shared_Image::handlers_ = 0;// Additional format handlers
 int     Fl_Shared_Image::num_handlers_ = 0;     // Number of format handlers
 int     Fl_Shared_Image::alloc_handlers_ = 0;   // Allocated format handlers
 
+// Size requested by get() while loading, see requested_size(). Images
+// requested with get_async() are decoded by worker threads, which need
+// their own copy.
+#ifdef FL_THREAD_LOCAL
+static FL_THREAD_LOCAL int requested_w = 0;
+static FL_THREAD_LOCAL int requested_h = 0;
+#else
+static int requested_w = 0;
+static int requested_h = 0;
+#endif // FL_THREAD_LOCAL
+
 
 //
 // Typedef the C API sort function type the only way I know how...
@@ -197,6 +210,36 @@ Fl_Shared_Image::update() {
   }
 }
 
+
+//
+// 'Fl_Shared_Image::add_loaded()' - Add a newly loaded image to the cache.
+//
+// Returns the image, or its copy with the size W x H if requested.
+//
+
+Fl_Shared_Image *
+Fl_Shared_Image::add_loaded(int W, int H) {
+  if (W && H && image_->data_w() < image_->w()) {
+    // The handler loaded the image at reduced resolution (see
+    // requested_size()), cache only the copy and not the "original"
+    Fl_Shared_Image *temp = (Fl_Shared_Image *)copy(W, H);
+    delete this;
+    temp->add();
+    return temp;
+  }
+
+  add();
+
+  if ((w() != W || h() != H) && W && H) {
+    Fl_Shared_Image *temp = (Fl_Shared_Image *)copy(W, H);
+    temp->add();
+    return temp;
+  }
+
+  return this;
+}
+
+
 /**
   The destructor frees all memory and server resources that are
   used by the image.
@@ -463,14 +506,17 @@ Fl_Shared_Image* Fl_Shared_Image::get(const char *name, int W, int H) {
   if ((temp = find(name, W, H)) != NULL) return temp;
 
   if ((temp = find(name)) == NULL) {
+    requested_w = W;
+    requested_h = H;
     temp = new Fl_Shared_Image(name);
+    requested_w = requested_h = 0;
 
     if (!temp->image_) {
       delete temp;
       return NULL;
     }
 
-    temp->add();
+    return temp->add_loaded(W, H);
   }
 
   if ((temp->w() != W || temp->h() != H) && W && H) {
@@ -481,6 +527,352 @@ Fl_Shared_Image* Fl_Shared_Image::get(const char *name, int W, int H) {
   return temp;
 }
 
+
+//
+// Images requested with get_async() are decoded by a small pool of worker
+// threads if threads are available. Each worker takes the oldest queued
+// job, calls the image handlers to decode the image into a private image,
+// and marks the job as done. A timeout in the main thread adds the decoded
+// images to the list of shared images and calls the callbacks, so only the
+// main thread touches the list of shared images and the requests. XBM and
+// XPM files and all images without threads are loaded by the timeout.
+//
+
+// Maximum number of worker threads
+#define ASYNC_MAX_THREADS 4
+
+// Time between checks for images decoded by the workers
+#define ASYNC_INTERVAL 0.02
+
+// States of Fl_Async_Image_Job
+enum {
+  ASYNC_QUEUED,                 // Waiting for a worker
+  ASYNC_DECODING,               // Being decoded by a worker
+  ASYNC_DONE                    // Decoded or failed
+};
+
+// An image requested with get_async(), owned by the main thread
+struct Fl_Async_Image_Request {
+  char                     *name;
+  int                      w, h;
+  Fl_Shared_Image_Callback *cb;
+  void                     *data;
+};
+
+// An image being decoded, one job per name and size of pending requests.
+// Only state and next may change after the job was queued.
+struct Fl_Async_Image_Job {
+  char               *name;           // Name of image file
+  int                w, h;            // Requested size
+  Fl_Shared_Handler  *handlers;       // Copy of the image handlers
+  int                num_handlers;    // Number of image handlers
+  int                state;           // ASYNC_QUEUED, ASYNC_DECODING, or ASYNC_DONE
+  int                main_thread;     // Set if the main thread must load the image
+  Fl_Image           *image;          // Decoded image or NULL
+  Fl_Async_Image_Job *next;           // Next job in queue
+};
+
+static Fl_Async_Image_Request *async_requests = 0;
+static int num_async_requests = 0;
+static int alloc_async_requests = 0;
+
+// The job queue and the number of workers, protected by async_mutex
+static Fl_Thread_Mutex async_mutex;
+static Fl_Async_Image_Job *async_jobs = 0;
+static int num_async_queued = 0;
+static int num_async_workers = 0;
+
+// Find the job for an image, the caller must hold the lock
+static Fl_Async_Image_Job *find_async_job(const char *name, int W, int H) {
+  for (Fl_Async_Image_Job *j = async_jobs; j; j = j->next)
+    if (j->w == W && j->h == H && !strcmp(j->name, name)) return j;
+  return 0;
+}
+
+static void free_async_job(Fl_Async_Image_Job *j) {
+  free(j->name);
+  delete[] j->handlers;
+  delete j;
+}
+
+// Decode the image of a job with the image handlers. This runs in a
+// worker thread, or in the main thread if no threads are available.
+static void decode_async_job(Fl_Async_Image_Job *j) {
+  FILE          *fp;            // File pointer
+  uchar         header[64];     // Buffer for auto-detecting files
+  Fl_Image      *img = 0;       // New image
+
+  if ((fp = fl_fopen(j->name, "rb")) != NULL) {
+    if (fread(header, 1, sizeof(header), fp)==0) { /* ignore */ }
+    fclose(fp);
+
+    if (memcmp(header, "#define", 7) == 0 || // XBM file
+        memcmp(header, "/* XPM */", 9) == 0) // XPM file
+      j->main_thread = 1;
+    else {
+      requested_w = j->w;
+      requested_h = j->h;
+      for (int i = 0; i < j->num_handlers && !img; i ++)
+        img = (j->handlers[i])(j->name, header, sizeof(header));
+      requested_w = requested_h = 0;
+    }
+  }
+
+  async_mutex.lock();
+  j->image = img;
+  j->state = ASYNC_DONE;
+  async_mutex.unlock();
+}
+
+// Take the oldest queued job, the caller must hold the lock
+static Fl_Async_Image_Job *next_async_job() {
+  for (Fl_Async_Image_Job *j = async_jobs; j; j = j->next)
+    if (j->state == ASYNC_QUEUED) {
+      j->state = ASYNC_DECODING;
+      num_async_queued --;
+      return j;
+    }
+  return 0;
+}
+
+static void async_worker(void *) {
+  for (;;) {
+    async_mutex.lock();
+    Fl_Async_Image_Job *j = next_async_job();
+    if (!j) num_async_workers --;
+    async_mutex.unlock();
+    if (!j) return;
+    decode_async_job(j);
+  }
+}
+
+//
+// 'Fl_Shared_Image::async_timeout_cb()' - Add images decoded by the workers.
+//
+
+void Fl_Shared_Image::async_timeout_cb(void *) {
+  Fl_Async_Image_Job *done = 0, **last = &done, **p, *j;
+  int i, n, num_done, pending, decode_now;
+
+  async_mutex.lock();
+  // Without workers decode one image now, pending events are handled
+  // before the next one
+  j = num_async_workers ? 0 : next_async_job();
+  async_mutex.unlock();
+  if (j) decode_async_job(j);
+
+  // Take the finished jobs out of the queue, the callbacks may add or
+  // cancel requests
+  async_mutex.lock();
+  for (p = &async_jobs; (j = *p) != NULL; ) {
+    if (j->state == ASYNC_DONE) {
+      *p    = j->next;
+      *last = j;
+      last  = &j->next;
+    } else p = &j->next;
+  }
+  *last   = 0;
+  pending = async_jobs != 0;
+  decode_now = num_async_queued && !num_async_workers;
+  async_mutex.unlock();
+
+  if (decode_now) Fl::repeat_timeout(0.0, async_timeout_cb);
+  else if (pending) Fl::repeat_timeout(ASYNC_INTERVAL, async_timeout_cb);
+
+  while ((j = done) != NULL) {
+    done = j->next;
+
+    // Take the requests for this image out of the list
+    Fl_Async_Image_Request *r = new Fl_Async_Image_Request[num_async_requests + 1];
+    for (i = n = num_done = 0; i < num_async_requests; i ++) {
+      Fl_Async_Image_Request *a = async_requests + i;
+      if (a->w == j->w && a->h == j->h && !strcmp(a->name, j->name))
+        r[num_done ++] = *a;
+      else
+        async_requests[n ++] = *a;
+    }
+    num_async_requests = n;
+
+    // Add the image to the list of shared images, unless it was loaded
+    // in the meantime, and take one reference per request before the
+    // first callback can release it
+    Fl_Shared_Image **img = new Fl_Shared_Image *[num_done + 1];
+    img[0] = 0;
+    if (!num_done) {
+      delete j->image;
+    } else if (j->main_thread) {
+      delete j->image;
+      img[0] = get(j->name, j->w, j->h);
+    } else if (j->image) {
+      Fl_Shared_Image *temp = find(j->name, j->w, j->h);
+      if (!temp) temp = find(j->name);
+      if (temp) {
+        temp->release();
+        delete j->image;
+        img[0] = get(j->name, j->w, j->h);
+      } else {
+        temp = new Fl_Shared_Image(j->name, j->image);
+        temp->alloc_image_ = 1;
+        img[0] = temp->add_loaded(j->w, j->h);
+      }
+    }
+    for (i = 1; i < num_done; i ++)
+      img[i] = img[0] ? find(j->name, img[0]->w(), img[0]->h()) : 0;
+    free_async_job(j);
+
+    for (i = 0; i < num_done; i ++) {
+      (r[i].cb)(img[i], r[i].data);
+      free(r[i].name);
+    }
+    delete[] img;
+    delete[] r;
+  }
+}
+
+/**
+  Finds an image or loads it in the background.
+
+  If the image \p name is already in the list of shared images with the
+  requested size, it is returned immediately like with find(). Otherwise
+  get_async() returns NULL, the program should show a placeholder instead,
+  and the image is loaded like with get(name, W, H) without blocking the
+  user interface. The callback \p cb is then called in the main thread
+  with the loaded image, or with NULL if the image could not be loaded.
+
+  If threads are available, the images are decoded by up to four worker
+  threads with the image handlers (see add_handler()), hence these must
+  be thread-safe. The handlers of the fltk_images library are thread-safe.
+  The decoded images are added to the list of shared images by the main
+  thread while the program waits for events. XBM and XPM images, and all
+  images if threads are not available, are loaded one at a time by the
+  main thread, and pending events are handled between the images.
+
+  Either way the program stays responsive even if thousands of images
+  are requested, for instance as previews in a file browser. Images are
+  decoded in the order of the requests, and requests for the same image
+  are decoded only once. A request with the same image, \p cb, and \p data
+  as a pending request is ignored. Requests that are no longer needed,
+  e.g. because the widget showing the image was scrolled out of view or
+  deleted, should be removed with cancel_async().
+
+  The image returned or passed to the callback must be released with
+  release() when no longer needed.
+
+  \param[in] name  name of the image
+  \param[in] W, H  desired size, see get(const char *name, int W, int H)
+  \param[in] cb    function called with the loaded image
+  \param[in] data  user data passed to \p cb
+
+  \returns the image if it is already loaded, NULL otherwise
+
+  \see Fl_Shared_Image::cancel_async()
+  \since 1.4.0
+*/
+Fl_Shared_Image *Fl_Shared_Image::get_async(const char *name, int W, int H,
+                                            Fl_Shared_Image_Callback *cb, void *data) {
+  Fl_Shared_Image *temp;
+
+  if ((temp = find(name, W, H)) != NULL) return temp;
+
+  for (int i = 0; i < num_async_requests; i ++) {
+    Fl_Async_Image_Request *r = async_requests + i;
+    if (r->cb == cb && r->data == data && r->w == W && r->h == H && !strcmp(r->name, name))
+      return NULL;
+  }
+
+  if (num_async_requests >= alloc_async_requests) {
+    alloc_async_requests = alloc_async_requests ? 2 * alloc_async_requests : 32;
+    async_requests = (Fl_Async_Image_Request *)realloc(async_requests,
+                        alloc_async_requests * sizeof(Fl_Async_Image_Request));
+  }
+  Fl_Async_Image_Request *r = async_requests + num_async_requests ++;
+  r->name = fl_strdup(name);
+  r->w    = W;
+  r->h    = H;
+  r->cb   = cb;
+  r->data = data;
+
+  // Queue a job unless the image is already being decoded, and start
+  // another worker if all are busy
+  async_mutex.lock();
+  if (!find_async_job(name, W, H)) {
+    Fl_Async_Image_Job *j = new Fl_Async_Image_Job;
+    j->name         = fl_strdup(name);
+    j->w            = W;
+    j->h            = H;
+    j->handlers     = new Fl_Shared_Handler[num_handlers_ + 1];
+    j->num_handlers = num_handlers_;
+    j->state        = ASYNC_QUEUED;
+    j->main_thread  = 0;
+    j->image        = 0;
+    j->next         = 0;
+    if (num_handlers_)
+      memcpy(j->handlers, handlers_, num_handlers_ * sizeof(Fl_Shared_Handler));
+
+    Fl_Async_Image_Job **p;
+    for (p = &async_jobs; *p; p = &(*p)->next) {/*empty*/}
+    *p = j;
+    num_async_queued ++;
+
+#ifdef FL_THREAD_LOCAL
+    if (num_async_workers < num_async_queued && num_async_workers < ASYNC_MAX_THREADS) {
+      num_async_workers ++;
+      if (!fl_start_thread(async_worker, 0)) num_async_workers --;
+    }
+#endif // FL_THREAD_LOCAL
+  }
+  async_mutex.unlock();
+
+  if (!Fl::has_timeout(async_timeout_cb)) Fl::add_timeout(0.0, async_timeout_cb);
+  return NULL;
+}
+
+/**
+  Cancels pending requests of get_async().
+
+  All requests that have not been loaded yet and were made with the
+  callback \p cb and the user data \p data are removed. Images that are
+  no longer requested are not decoded, or discarded if a worker thread
+  is already decoding them.
+
+  \param[in] cb    callback passed to get_async()
+  \param[in] data  user data passed to get_async()
+
+  \since 1.4.0
+*/
+void Fl_Shared_Image::cancel_async(Fl_Shared_Image_Callback *cb, void *data) {
+  int i, k, n = 0, num_cancel = 0;
+  Fl_Async_Image_Request *cancel = new Fl_Async_Image_Request[num_async_requests + 1];
+  for (i = 0; i < num_async_requests; i ++) {
+    Fl_Async_Image_Request *r = async_requests + i;
+    if (r->cb == cb && r->data == data) cancel[num_cancel ++] = *r;
+    else async_requests[n ++] = *r;
+  }
+  num_async_requests = n;
+
+  // Drop the queued jobs of images that are no longer requested
+  for (i = 0; i < num_cancel; i ++) {
+    Fl_Async_Image_Request *r = cancel + i;
+    for (k = 0; k < num_async_requests; k ++) {
+      Fl_Async_Image_Request *a = async_requests + k;
+      if (a->w == r->w && a->h == r->h && !strcmp(a->name, r->name)) break;
+    }
+    if (k >= num_async_requests) {
+      async_mutex.lock();
+      Fl_Async_Image_Job *j = find_async_job(r->name, r->w, r->h), **p;
+      if (j && j->state == ASYNC_QUEUED) {
+        for (p = &async_jobs; *p != j; p = &(*p)->next) {/*empty*/}
+        *p = j->next;
+        num_async_queued --;
+        free_async_job(j);
+      }
+      async_mutex.unlock();
+    }
+    free(r->name);
+  }
+  delete[] cancel;
+}
+
 /** Builds a shared image from a pre-existing Fl_RGB_Image.
 
  \param[in] rgb         an Fl_RGB_Image used to build a new shared image.
@@ -498,6 +890,28 @@ Fl_Shared_Image *Fl_Shared_Image::get(Fl_RGB_Image *rgb, int own_it)
 }
 
 
+/**
+  Returns the size requested by the Fl_Shared_Image::get() or get_async()
+  call that is currently loading an image in this thread.
+
+  Image handlers can use this to decode large images at a reduced
+  resolution that is at least \p W x \p H pixels, for instance a JPEG
+  image that is only shown as a thumbnail. Such an image must keep its
+  full size as w() and h() and store the reduced size as data_w() and
+  data_h() (see Fl_Image::scale()). get() then only caches the copy of the
+  image in the requested size.
+
+  \param[out] W, H  requested size, or 0 if get() was called without a size
+                    or no image is being loaded
+
+  \see Fl_Shared_Image::add_handler()
+  \since 1.4.0
+*/
+void Fl_Shared_Image::requested_size(int &W, int &H) {
+  W = requested_w;
+  H = requested_h;
+}
+
 /** Adds a shared image handler, which is basically a test function
     for adding new formats.
 */
@@ -46,6 +46,90 @@ void Fl_Table::IntVector::size(unsigned int count) {
   }
 }
 
+// Row heights or column widths with fast position lookups (private to Fl_Table)
+
+Fl_Table::SizeVector::~SizeVector() { // DTOR
+  if (tree)
+    free(tree);
+  tree = 0;
+}
+
+// (Re)build the Fenwick tree from the sizes in O(n)
+void Fl_Table::SizeVector::build() {
+  unsigned int n = sizes.size();
+  tree = (int*)realloc(tree, (n+1) * sizeof(int));
+  tree[0] = 0;
+  for (unsigned int i = 1; i <= n; i++)
+    tree[i] = sizes[i-1];
+  for (unsigned int i = 1; i <= n; i++) {
+    unsigned int j = i + (i & (0-i));
+    if (j <= n) tree[j] += tree[i];
+  }
+}
+
+void Fl_Table::SizeVector::size(unsigned int count, int fill) {
+  unsigned int now_size = sizes.size();
+  if (count == now_size) return;
+  sizes.size(count);
+  for (unsigned int i = now_size; i < count; i++)
+    sizes[i] = fill;
+  if (count == 0) {                     // empty: uniform again
+    uniform = 1;
+    if (tree) free(tree);
+    tree = 0;
+    return;
+  }
+  if (uniform) {
+    if (now_size == 0) usize = fill;    // first entries define the size
+    else if (fill != usize && count > now_size) uniform = 0;
+  }
+  if (!uniform) build();
+}
+
+void Fl_Table::SizeVector::set(int x, int val) {
+  int delta = val - sizes[x];
+  if (delta == 0) return;
+  sizes[x] = val;
+  if (uniform) {
+    if (sizes.size() == 1) { usize = val; return; }
+    uniform = 0;
+    build();
+    return;
+  }
+  for (unsigned int i = x + 1; i <= sizes.size(); i += (i & (0-i)))
+    tree[i] += delta;
+}
+
+long Fl_Table::SizeVector::position(int x) const {
+  unsigned int n = sizes.size();
+  if (x <= 0) return(0);
+  if ((unsigned int)x > n) x = n;
+  if (uniform) return((long)x * usize);
+  long pos = 0;
+  for (unsigned int i = x; i > 0; i -= (i & (0-i)))
+    pos += tree[i];
+  return(pos);
+}
+
+int Fl_Table::SizeVector::find(long pos) const {
+  unsigned int n = sizes.size();
+  if (pos < 0 || n == 0) return(0);
+  if (uniform) {
+    if (usize <= 0 || pos / usize >= (long)n) return(n);
+    return(int(pos / usize));
+  }
+  // descend the tree: largest x with position(x) <= pos
+  unsigned int x = 0, bit = 1;
+  while ((bit << 1) <= n) bit <<= 1;
+  for (; bit; bit >>= 1) {
+    if (x + bit <= n && tree[x + bit] <= pos) {
+      x += bit;
+      pos -= tree[x];
+    }
+  }
+  return(x);
+}
+
 
 /** Sets the vertical scroll position so 'row' is at the top,
     and causes the screen to redraw.
@@ -61,7 +145,7 @@ void Fl_Table::row_position(int row) {
   }
   vscrollbar->Fl_Slider::value(newtop);
   table_scrolled();
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
   _row_position = row;  // HACK: override what table_scrolled() came up with
 }
 
@@ -80,7 +164,7 @@ void Fl_Table::col_position(int col) {
   }
   hscrollbar->Fl_Slider::value(newleft);
   table_scrolled();
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
   _col_position = col;  // HACK: override what table_scrolled() came up with
 }
 
@@ -88,38 +172,14 @@ void Fl_Table::col_position(int col) {
   Returns the scroll position (in pixels) of the specified 'row'.
 */
 long Fl_Table::row_scroll_position(int row) {
-  int startrow = 0;
-  long scroll = 0;
-  // OPTIMIZATION:
-  //     Attempt to use precomputed row scroll position
-  //
-  if ( toprow_scrollpos != -1 && row >= toprow ) {
-    scroll = toprow_scrollpos;
-    startrow = toprow;
-  }
-  for ( int t=startrow; t<row; t++ ) {
-    scroll += row_height(t);
-  }
-  return(scroll);
+  return(_rowheights.position(row));
 }
 
 /**
   Returns the scroll position (in pixels) of the specified column 'col'.
 */
 long Fl_Table::col_scroll_position(int col) {
-  int startcol = 0;
-  long scroll = 0;
-  // OPTIMIZATION:
-  //     Attempt to use precomputed row scroll position
-  //
-  if ( leftcol_scrollpos != -1 && col >= leftcol ) {
-    scroll = leftcol_scrollpos;
-    startcol = leftcol;
-  }
-  for ( int t=startcol; t<col; t++ ) {
-    scroll += col_width(t);
-  }
-  return(scroll);
+  return(_colwidths.position(col));
 }
 
 /**
@@ -140,10 +200,15 @@ Fl_Table::Fl_Table(int X, int Y, int W, int H, const char *l) : Fl_Group(X,Y,W,H
   _col_resize       = 0;
   _row_resize_min   = 1;
   _col_resize_min   = 1;
-  _redraw_toprow    = -1;
-  _redraw_botrow    = -1;
-  _redraw_leftcol   = -1;
-  _redraw_rightcol  = -1;
+  _dirty_cells      = 0;
+  _dirty_alloc      = 0;
+  _dirty_toprow     = 0;
+  _dirty_leftcol    = 0;
+  _dirty_rows       = 0;
+  _dirty_cols       = 0;
+  _dirty_count      = 0;
+  _drawn_hpos       = 0;
+  _drawn_vpos       = 0;
   table_w           = 0;
   table_h           = 0;
   toprow            = 0;
@@ -198,6 +263,7 @@ Fl_Table::Fl_Table(int X, int Y, int W, int H, const char *l) : Fl_Group(X,Y,W,H
 */
 Fl_Table::~Fl_Table() {
   // The parent Fl_Group takes care of destroying scrollbars
+  if ( _dirty_cells ) free(_dirty_cells);
 }
 
 /**
@@ -212,13 +278,10 @@ void Fl_Table::row_height(int row, int height) {
     return;             // OPTIMIZATION: no change? avoid redraw
   }
   // Add row heights, even if none yet
-  int now_size = (int)_rowheights.size();
-  if ( row >= now_size ) {
-    _rowheights.size(row);
-    while (now_size < row)
-      _rowheights[now_size++] = height;
+  if ( row >= (int)_rowheights.size() ) {
+    _rowheights.size(row+1, height);
   }
-  _rowheights[row] = height;
+  _rowheights.set(row, height);
   table_resized();
   if ( row <= botrow ) {        // OPTIMIZATION: only redraw if onscreen or above screen
     redraw();
@@ -241,14 +304,10 @@ void Fl_Table::col_width(int col, int width)
     return;                     // OPTIMIZATION: no change? avoid redraw
   }
   // Add column widths, even if none yet
-  int now_size = (int)_colwidths.size();
-  if ( col >= now_size ) {
-    _colwidths.size(col+1);
-    while (now_size < col) {
-      _colwidths[now_size++] = width;
-    }
+  if ( col >= (int)_colwidths.size() ) {
+    _colwidths.size(col+1, width);
   }
-  _colwidths[col] = width;
+  _colwidths.set(col, width);
   table_resized();
   if ( col <= rightcol ) {      // OPTIMIZATION: only redraw if onscreen or to the left
     redraw();
@@ -560,38 +619,30 @@ void Fl_Table::recalc_dimensions() {
   TODO: Assumes ti[xywh] has already been recalculated.
 */
 void Fl_Table::table_scrolled() {
-  // Find top row
-  int y, row, voff = vscrollbar->value();
-  for ( row=y=0; row < _rows; row++ ) {
-    y += row_height(row);
-    if ( y > voff ) { y -= row_height(row); break; }
-  }
+  // Find top row: first row whose bottom is below the scroll position
+  int row, voff = vscrollbar->value();
+  row = _rowheights.find(voff);
+  if ( row > _rows ) row = _rows;
   _row_position = toprow = ( row >= _rows ) ? (row - 1) : row;
-  toprow_scrollpos = y;         // OPTIMIZATION: save for later use
-  // Find bottom row
+  toprow_scrollpos = (int)_rowheights.position(row);    // OPTIMIZATION: save for later use
+  // Find bottom row: first row whose bottom reaches the bottom edge
   voff = vscrollbar->value() + tih;
-  for ( ; row < _rows; row++ ) {
-    y += row_height(row);
-    if ( y >= voff ) { break; }
-  }
-  botrow = ( row >= _rows ) ? (row - 1) : row;
+  int bot = _rowheights.find(voff - 1L);
+  if ( bot < row ) bot = row;
+  if ( bot > _rows ) bot = _rows;
+  botrow = ( bot >= _rows ) ? (bot - 1) : bot;
   // Left column
-  int x, col, hoff = hscrollbar->value();
-  for ( col=x=0; col < _cols; col++ ) {
-    x += col_width(col);
-    if ( x > hoff ) { x -= col_width(col); break; }
-  }
+  int col, hoff = hscrollbar->value();
+  col = _colwidths.find(hoff);
+  if ( col > _cols ) col = _cols;
   _col_position = leftcol = ( col >= _cols ) ? (col - 1) : col;
-  leftcol_scrollpos = x;        // OPTIMIZATION: save for later use
+  leftcol_scrollpos = (int)_colwidths.position(col);    // OPTIMIZATION: save for later use
   // Right column
-  //    Work with data left over from leftcol calculation
-  //
   hoff = hscrollbar->value() + tiw;
-  for ( ; col < _cols; col++ ) {
-    x += col_width(col);
-    if ( x >= hoff ) { break; }
-  }
-  rightcol = ( col >= _cols ) ? (col - 1) : col;
+  int right = _colwidths.find(hoff - 1L);
+  if ( right < col ) right = col;
+  if ( right > _cols ) right = _cols;
+  rightcol = ( right >= _cols ) ? (right - 1) : right;
   // First tell children to scroll
   draw_cell(CONTEXT_RC_RESIZE, 0,0,0,0,0,0);
 }
@@ -647,7 +698,7 @@ void Fl_Table::scroll_cb(Fl_Widget*w, void *data) {
   Fl_Table *o = (Fl_Table*)data;
   o->recalc_dimensions();       // recalc tix, tiy, etc.
   o->table_scrolled();
-  o->redraw();
+  o->damage(FL_DAMAGE_SCROLL);  // OPTIMIZATION: draw() scrolls what is already on screen
 }
 
 /**
@@ -658,11 +709,7 @@ void Fl_Table::rows(int val) {
   _rows = val;
   {
     int default_h = ( _rowheights.size() > 0 ) ? _rowheights.back() : 25;
-    int now_size = _rowheights.size();
-    _rowheights.size(val);                      // enlarge or shrink as needed
-    while ( now_size < val ) {
-      _rowheights[now_size++] = default_h;      // fill new
-    }
+    _rowheights.size(val, default_h);           // enlarge or shrink as needed, fill new
   }
   table_resized();
 
@@ -681,11 +728,7 @@ void Fl_Table::cols(int val) {
   _cols = val;
   {
     int default_w = ( _colwidths.size() > 0 ) ? _colwidths[_colwidths.size()-1] : 80;
-    int now_size = _colwidths.size();
-    _colwidths.size(val);                       // enlarge or shrink as needed
-    while ( now_size < val ) {
-      _colwidths[now_size++] = default_w;       // fill new
-    }
+    _colwidths.size(val, default_w);            // enlarge or shrink as needed, fill new
   }
   table_resized();
   redraw();
@@ -1171,6 +1214,109 @@ void Fl_Table::_redraw_cell(TableContext context, int r, int c) {
   draw_cell(context, r, c, X, Y, W, H); // call users' function to draw it
 }
 
+/**
+  Redraws the cells in rows \p topRow to \p botRow and columns \p leftCol
+  to \p rightCol.
+
+  Like redraw_cell(), this marks only the given cells to be redrawn by
+  the next draw(). Several ranges add up cell by cell, not to the
+  rectangle around them. Cells that are scrolled off-screen are ignored.
+*/
+void Fl_Table::redraw_range(int topRow, int botRow, int leftCol, int rightCol) {
+  if ( topRow < toprow ) topRow = toprow;
+  if ( botRow > botrow ) botRow = botrow;
+  if ( leftCol < leftcol ) leftCol = leftcol;
+  if ( rightCol > rightcol ) rightCol = rightcol;
+  for ( int r = topRow; r <= botRow; r++ ) {
+    for ( int c = leftCol; c <= rightCol; c++ ) {
+      redraw_cell(r, c);
+    }
+  }
+}
+
+/**
+  Redraws the cell at row \p R and column \p C.
+
+  Unlike redraw(), only the cells marked this way are redrawn (via
+  draw_cell()) by the next draw(), so tables that change a few cells at
+  a time, e.g. to show live data, should use this instead of redraw().
+  Cells that are scrolled off-screen are ignored.
+
+  \see redraw_range()
+*/
+void Fl_Table::redraw_cell(int R, int C) {
+  if ( R < toprow || R > botrow || C < leftcol || C > rightcol ) return;
+  int nrows = botrow - toprow + 1;
+  int ncols = rightcol - leftcol + 1;
+  if ( _dirty_count &&
+       ( _dirty_toprow != toprow || _dirty_leftcol != leftcol ||
+         _dirty_rows != nrows || _dirty_cols != ncols ) ) {
+    // Table scrolled since cells were marked and not drawn yet? Draw all
+    memset(_dirty_cells, 0, _dirty_rows * _dirty_cols);
+    _dirty_count = 0;
+    redraw();
+    return;
+  }
+  if ( _dirty_count == 0 ) {
+    // Start a new set of flags for the visible cells
+    if ( nrows * ncols > _dirty_alloc ) {
+      _dirty_alloc = nrows * ncols;
+      if ( _dirty_cells ) free(_dirty_cells);
+      _dirty_cells = (unsigned char*)calloc(_dirty_alloc, 1);
+    }
+    _dirty_toprow  = toprow;
+    _dirty_leftcol = leftcol;
+    _dirty_rows    = nrows;
+    _dirty_cols    = ncols;
+  }
+  unsigned char &flag = _dirty_cells[(R - toprow) * ncols + (C - leftcol)];
+  if ( flag ) return;
+  flag = 1;
+  _dirty_count++;
+  damage(FL_DAMAGE_CHILD);
+}
+
+// Returns 1 if the box type draws nothing inside its frame
+static int is_frame(Fl_Boxtype b) {
+  switch (b) {
+    case FL_NO_BOX:
+    case FL_UP_FRAME:
+    case FL_DOWN_FRAME:
+    case FL_THIN_UP_FRAME:
+    case FL_THIN_DOWN_FRAME:
+    case FL_ENGRAVED_FRAME:
+    case FL_EMBOSSED_FRAME:
+    case FL_BORDER_FRAME:
+    case _FL_SHADOW_FRAME:
+    case _FL_ROUNDED_FRAME:
+    case _FL_OVAL_FRAME:
+    case _FL_PLASTIC_UP_FRAME:
+    case _FL_PLASTIC_DOWN_FRAME:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+// Draws the area of the table exposed by fl_scroll()
+void Fl_Table::_scroll_draw_cb(void *v, int X, int Y, int W, int H) {
+  Fl_Table *t = (Fl_Table*)v;
+  fl_push_clip(X, Y, W, H);
+  fl_rectf(X, Y, W, H, t->color());     // dead zones of the table
+  for ( int r = t->toprow; r <= t->botrow; r++ ) {
+    int cx, cy, cw, ch;
+    t->find_cell(CONTEXT_CELL, r, t->leftcol, cx, cy, cw, ch);
+    if ( cy >= Y + H ) break;                   // below exposed area
+    if ( cy + ch <= Y ) continue;               // above exposed area
+    for ( int c = t->leftcol; c <= t->rightcol; c++ ) {
+      t->find_cell(CONTEXT_CELL, r, c, cx, cy, cw, ch);
+      if ( cx + cw <= X || cx >= X + W ) continue;
+      t->draw_cell(CONTEXT_CELL, r, c, cx, cy, cw, ch);
+    }
+  }
+  fl_pop_clip();
+}
+
 /**
   See if the cell at row \p r and column \p c is selected.
   \returns 1 if the cell is selected, 0 if not.
@@ -1252,11 +1398,22 @@ void Fl_Table::set_selection(int row_top, int col_left, int row_bot, int col_rig
 */
 void Fl_Table::draw() {
     int scrollsize = _scrollbar_size ? _scrollbar_size : Fl::scrollbar_size();
+  uchar d = damage();
   // Check if scrollbar size changed
   if ( ( vscrollbar && (scrollsize != vscrollbar->w()) ) ||
        ( hscrollbar && (scrollsize != hscrollbar->h()) ) ) {
     // handle size change, min/max, table dim's, etc
     table_resized();
+    d |= FL_DAMAGE_ALL;
+  }
+  // Scrolled? Copy the cells already on screen unless that is not possible:
+  // child widgets must be redrawn, Fl_Group::draw() fills boxes that are
+  // not frames over the cells before they could be copied, and scaling by
+  // fractional values may leave gaps.
+  if ( (d & FL_DAMAGE_SCROLL) && !(d & FL_DAMAGE_ALL) ) {
+    float scale = Fl_Surface_Device::surface()->driver()->scale();
+    if ( table->visible() || !is_frame(box()) || scale != int(scale) )
+      d |= FL_DAMAGE_ALL;
   }
 
   draw_cell(CONTEXT_STARTPAGE, 0, 0,            // let user's drawing routine
@@ -1281,24 +1438,49 @@ void Fl_Table::draw() {
   //    that leak around the border.
   //
   if ( ! table->visible() ) {
-    if ( damage() & FL_DAMAGE_ALL || damage() & FL_DAMAGE_CHILD ) {
+    if ( d & FL_DAMAGE_ALL || d & FL_DAMAGE_CHILD ) {
       draw_box(table->box(), tox, toy, tow, toh, table->color());
     }
   }
   // Clip all further drawing to the inner widget dimensions
   fl_push_clip(wix, wiy, wiw, wih);
   {
-    // Only redraw a few cells?
-    if ( ! ( damage() & FL_DAMAGE_ALL ) && _redraw_leftcol != -1 ) {
-      fl_push_clip(tix, tiy, tiw, tih);
-      for ( int c = _redraw_leftcol; c <= _redraw_rightcol; c++ ) {
-        for ( int r = _redraw_toprow; r <= _redraw_botrow; r++ ) {
-          _redraw_cell(CONTEXT_CELL, r, c);
+    // Scroll the cells on screen, draw only the exposed ones and the headers
+    if ( (d & FL_DAMAGE_SCROLL) && !(d & FL_DAMAGE_ALL) ) {
+      int dx = _drawn_hpos - (int)hscrollbar->value();
+      int dy = _drawn_vpos - (int)vscrollbar->value();
+      fl_scroll(tix, tiy, tiw, tih, dx, dy, _scroll_draw_cb, this);
+      int X,Y,W,H;
+      if ( row_header() && dy ) {
+        get_bounds(CONTEXT_ROW_HEADER, X, Y, W, H);
+        fl_push_clip(X,Y,W,H);
+        for ( int r = toprow; r <= botrow; r++ ) {
+          _redraw_cell(CONTEXT_ROW_HEADER, r, 0);
+        }
+        fl_pop_clip();
+      }
+      if ( col_header() && dx ) {
+        get_bounds(CONTEXT_COL_HEADER, X, Y, W, H);
+        fl_push_clip(X,Y,W,H);
+        for ( int c = leftcol; c <= rightcol; c++ ) {
+          _redraw_cell(CONTEXT_COL_HEADER, 0, c);
         }
+        fl_pop_clip();
+      }
+    }
+    // Only redraw the cells marked by redraw_cell() that are still visible
+    if ( ! ( d & FL_DAMAGE_ALL ) && _dirty_count ) {
+      fl_push_clip(tix, tiy, tiw, tih);
+      for ( int i = 0; i < _dirty_rows * _dirty_cols; i++ ) {
+        if ( !_dirty_cells[i] ) continue;
+        int r = _dirty_toprow + i / _dirty_cols;
+        int c = _dirty_leftcol + i % _dirty_cols;
+        if ( r < toprow || r > botrow || c < leftcol || c > rightcol ) continue;
+        _redraw_cell(CONTEXT_CELL, r, c);
       }
       fl_pop_clip();
     }
-    if ( damage() & FL_DAMAGE_ALL ) {
+    if ( d & FL_DAMAGE_ALL ) {
       int X,Y,W,H;
       // Draw row headers, if any
       if ( row_header() ) {
@@ -1385,7 +1567,12 @@ void Fl_Table::draw() {
     draw_cell(CONTEXT_ENDPAGE, 0, 0,            // let user's drawing
               tix, tiy, tiw, tih);              // routines cleanup
 
-    _redraw_leftcol = _redraw_rightcol = _redraw_toprow = _redraw_botrow = -1;
+    if ( _dirty_count ) {
+      memset(_dirty_cells, 0, _dirty_rows * _dirty_cols);
+      _dirty_count = 0;
+    }
+    _drawn_hpos = (int)hscrollbar->value();
+    _drawn_vpos = (int)vscrollbar->value();
   }
   fl_pop_clip();
 }
@@ -30,6 +30,7 @@
 #include <FL/Fl_Text_Buffer.H>
 #include <FL/Fl_Text_Display.H>
 #include <FL/Fl_Window.H>
+#include <FL/Fl_Graphics_Driver.H>
 #include "Fl_Screen_Driver.H"
 
 #undef min
@@ -128,6 +129,9 @@ Fl_Text_Display::Fl_Text_Display(int X, int Y, int W, int H, const char* l)
   mHorizOffset = 0;
   mTopLineNumHint = 1;
   mHorizOffsetHint = 0;
+  mScrollOnly = 0;
+  mScrollLines = 0;
+  mScrollPixels = 0;
   mNStyles = 0;
   mStyleTable = NULL;
   mUnfinishedStyle = 0;
@@ -423,6 +427,7 @@ void Fl_Text_Display::highlight_data(Fl_Text_Buffer *styleBuffer,
   mColumnScale = 0;
 
   mStyleBuffer->canUndo(0);
+  mScrollOnly = 0;
   damage(FL_DAMAGE_EXPOSE);
 }
 
@@ -720,6 +725,12 @@ void Fl_Text_Display::draw_text( int left, int top, int width, int height ) {
 
 
 
+// Draw the area of the text exposed by fl_scroll() in draw()
+void Fl_Text_Display::scroll_draw_cb(void *v, int X, int Y, int W, int H) {
+  ((Fl_Text_Display *)v)->draw_text(X, Y, W, H);
+}
+
+
 /**
  \brief Marks text from start to end as needing a redraw.
 
@@ -1740,6 +1751,7 @@ void Fl_Text_Display::buffer_modified_cb( int pos, int nInserted, int nDeleted,
 
   /* If the changes caused scrolling, re-paint everything and we're done. */
   if ( scrolled ) {
+    textD->mScrollOnly = 0;
     textD->damage(FL_DAMAGE_EXPOSE);
     if ( textD->mStyleBuffer )   /* See comments in extendRangeForStyleMods */
       textD->mStyleBuffer->primary_selection()->selected(0);
@@ -1772,6 +1784,7 @@ void Fl_Text_Display::buffer_modified_cb( int pos, int nInserted, int nDeleted,
     }
     if (linesInserted > 1) {
       // textD->draw_line_numbers(false); // can't do this b/c not called from virtual draw();
+      textD->mScrollOnly = 0;
       textD->damage(::FL_DAMAGE_EXPOSE);
     }
   } else {
@@ -2919,6 +2932,15 @@ int Fl_Text_Display::scroll_(int topLineNum, int horizOffset) {
   if (mHorizOffset == horizOffset && mTopLineNum == topLineNum)
     return 0;
 
+  /* Remember how far the text moved, so draw() can copy the text that
+   stays visible, unless all text must be redrawn anyway */
+  if (!(damage() & (FL_DAMAGE_ALL | FL_DAMAGE_EXPOSE))) {
+    mScrollOnly = 1;
+    mScrollLines = mScrollPixels = 0;
+  }
+  mScrollLines += mTopLineNum - topLineNum;
+  mScrollPixels += mHorizOffset - horizOffset;
+
   /* If the vertical scroll position has changed, update the line
    starts array and related counters in the text display */
   offset_line_starts(topLineNum);
@@ -3791,8 +3813,26 @@ void Fl_Text_Display::draw(void) {
   update_child(*mVScrollBar);
   update_child(*mHScrollBar);
 
+  // if the text was only scrolled, copy the text that stays visible and
+  // draw the exposed area. This is not possible if other parts of the text
+  // changed or with fractional scaling, where copying can leave gaps
+  int scrolled = 0;
+  if (mScrollOnly && (damage() & FL_DAMAGE_EXPOSE) && !(damage() & FL_DAMAGE_ALL) &&
+      Fl_Surface_Device::surface() == Fl_Display_Device::display_device()) {
+    float s = Fl_Surface_Device::surface()->driver()->scale();
+    if (s == int(s)) {
+      int fontHeight = mMaxsize ? mMaxsize : textsize_;
+      fl_push_clip(text_area.x, text_area.y, text_area.w, text_area.h);
+      fl_scroll(text_area.x, text_area.y, text_area.w, text_area.h,
+                mScrollPixels, mScrollLines * fontHeight, scroll_draw_cb, this);
+      fl_pop_clip();
+      scrolled = 1;
+    }
+  }
+  mScrollOnly = 0;
+
   // draw all of the text
-  if (damage() & (FL_DAMAGE_ALL | FL_DAMAGE_EXPOSE)) {
+  if (!scrolled && (damage() & (FL_DAMAGE_ALL | FL_DAMAGE_EXPOSE))) {
     //printf("drawing all text\n");
     int X = 0, Y = 0, W = 0, H = 0;
     if (fl_clip_box(text_area.x, text_area.y, text_area.w, text_area.h,
@@ -5,6 +5,8 @@
 #include <string.h>
 
 #include <FL/Fl_Tree.H>
+#include <FL/Fl_Device.H>
+#include <FL/Fl_Graphics_Driver.H>
 #include <FL/Fl_Preferences.H>
 #include <FL/fl_string.h>
 
@@ -28,7 +30,7 @@
 
 // INTERNAL: scroller callback (hor+vert scroll)
 static void scroll_cb(Fl_Widget*,void *data) {
-  ((Fl_Tree*)data)->redraw();
+  ((Fl_Tree*)data)->damage(FL_DAMAGE_SCROLL);
 }
 
 // INTERNAL: Parse elements from 'path' into an array of null terminated strings
@@ -85,6 +87,8 @@ Fl_Tree::Fl_Tree(int X, int Y, int W, int H, const char *L) : Fl_Group(X,Y,W,H,L
   _scrollbar_size  = 0;                         // 0: uses Fl::scrollbar_size()
 
   _lastselect       = 0;
+  _drawn_hpos = _drawn_vpos = 0;
+  _draw_top = _draw_bot = 0;
 
   box(FL_DOWN_BOX);
   color(FL_BACKGROUND2_COLOR, FL_SELECTION_COLOR);
@@ -329,8 +333,8 @@ int Fl_Tree::handle(int e) {
               set_item_focus(next_visible_item(_item_focus, ekey));     // next item up|dn
               if ( _item_focus ) {                                      // item in focus?
                 // Autoscroll
-                int itemtop = _item_focus->y();
-                int itembot = _item_focus->y()+_item_focus->h();
+                int itemtop = item_y(_item_focus);
+                int itembot = itemtop+_item_focus->h();
                 if ( itemtop < y() ) { show_item_top(_item_focus); }
                 if ( itembot > y()+h() ) { show_item_bottom(_item_focus); }
                 // Extend selection
@@ -654,6 +658,10 @@ void Fl_Tree::calc_dimensions() {
 /// potentially a slow calculation if the tree has many items (potentially
 /// hundreds of thousands), and should therefore be called sparingly.
 ///
+/// The resulting layout is saved in the items, so that draw() and
+/// find_clicked() only need to visit the items inside the viewport
+/// (and their parents) until the next recalc.
+///
 /// For this reason, recalc_tree() is used as a way to /schedule/
 /// calculation when changes affect the tree hierarchy's size.
 ///
@@ -689,6 +697,18 @@ void Fl_Tree::calc_tree() {
   calc_dimensions();
 }
 
+// Returns the current y position of \p 'item', even if it was not drawn
+// since the tree was scrolled. Uses the layout of the last calc_tree()
+// unless a recalc is pending.
+//
+int Fl_Tree::item_y(const Fl_Tree_Item *item) const {
+  if ( _tree_w < 0 ) return(item->y());         // no layout yet: use last drawn position
+  int Y = _tiy + _prefs.margintop() - (int)_vscroll->value();
+  for ( ; item && item != _root; item = item->_parent )
+    Y += item->_layout_y;
+  return(Y);
+}
+
 void Fl_Tree::resize(int X,int Y,int W, int H) {
   fix_scrollbar_order();
   Fl_Group::resize(X,Y,W,H);
@@ -696,42 +716,76 @@ void Fl_Tree::resize(int X,int Y,int W, int H) {
   init_sizes();
 }
 
+// Draw the items in the current clip region of the tree area,
+// and the box and label if 'all' is set.
+void Fl_Tree::draw_tree_area(int all) {
+  // Let group draw box+label but *NOT* children.
+  // We handle drawing children ourselves by calling each item's draw()
+  if ( all ) {
+    Fl_Group::draw_box();
+    Fl_Group::draw_label();
+  }
+  if ( ! _root ) return;
+  // These values are changed during drawing
+  // By end, 'Y' will be the lowest point on the tree
+  int X = _tix + _prefs.marginleft() - _hscroll->value();
+  int Y = _tiy + _prefs.margintop()  - _vscroll->value();
+  int W = _tiw - X + _tix;
+  // Adjust root's X/W if connectors off
+  if (_prefs.connectorstyle() == FL_TREE_CONNECTOR_NONE) {
+    X -= _prefs.openicon()->w();
+    W += _prefs.openicon()->w();
+  }
+  // Draw entire tree, starting with root
+  fl_push_clip(_tix,_tiy,_tiw,_tih);
+  {
+    // Items outside the clip region are laid out but not rendered
+    int cx, cy, cw, ch;
+    fl_clip_box(_tix, _tiy, _tiw, _tih, cx, cy, cw, ch);
+    _draw_top = cy;
+    _draw_bot = cy + ch;
+    int xmax = 0;
+    fl_font(_prefs.labelfont(), _prefs.labelsize());
+    _root->draw(X, Y, W,                              // descend into tree here to draw it
+                (Fl::focus()==this)?_item_focus:0,    // show focus item ONLY if Fl_Tree has focus
+                xmax, 1, 1);
+  }
+  fl_pop_clip();
+}
+
+// Draw the part of the tree area exposed by fl_scroll() in draw()
+void Fl_Tree::scroll_draw_cb(void *v, int X, int Y, int W, int H) {
+  fl_push_clip(X, Y, W, H);
+  ((Fl_Tree*)v)->draw_tree_area(1);
+  fl_pop_clip();
+}
+
 /// Standard FLTK draw() method, handles drawing the tree widget.
+///
+/// If the tree was only scrolled since it was last drawn, the items that
+/// stay visible are copied to their new position and only the exposed
+/// area is drawn. This is not done if the items have child widgets,
+/// while an item is dragged, or with fractional scaling.
+///
 void Fl_Tree::draw() {
   fix_scrollbar_order();
   // Has tree recalc been scheduled? If so, do it
-  if ( _tree_w == -1 ) calc_tree();
+  uchar d = damage();
+  if ( _tree_w == -1 ) { calc_tree(); d |= FL_DAMAGE_ALL; }
   else calc_dimensions();
-  // Let group draw box+label but *NOT* children.
-  // We handle drawing children ourselves by calling each item's draw()
-  {
-    // Draw group's bg + label
-    if ( damage() & ~FL_DAMAGE_CHILD) { // redraw entire widget?
-      Fl_Group::draw_box();
-      Fl_Group::draw_label();
-    }
-    if ( ! _root ) return;
-    // These values are changed during drawing
-    // By end, 'Y' will be the lowest point on the tree
-    int X = _tix + _prefs.marginleft() - _hscroll->value();
-    int Y = _tiy + _prefs.margintop()  - _vscroll->value();
-    int W = _tiw - X + _tix;
-    // Adjust root's X/W if connectors off
-    if (_prefs.connectorstyle() == FL_TREE_CONNECTOR_NONE) {
-      X -= _prefs.openicon()->w();
-      W += _prefs.openicon()->w();
-    }
-    // Draw entire tree, starting with root
-    fl_push_clip(_tix,_tiy,_tiw,_tih);
-    {
-      int xmax = 0;
-      fl_font(_prefs.labelfont(), _prefs.labelsize());
-      _root->draw(X, Y, W,                              // descend into tree here to draw it
-                  (Fl::focus()==this)?_item_focus:0,    // show focus item ONLY if Fl_Tree has focus
-                  xmax, 1, 1);
-    }
-    fl_pop_clip();
+  int hpos = (int)_hscroll->value(), vpos = (int)_vscroll->value();
+  float scale = Fl_Surface_Device::surface()->driver()->scale();
+  if ( (d & FL_DAMAGE_SCROLL) && !(d & ~(FL_DAMAGE_SCROLL|FL_DAMAGE_CHILD)) &&
+       children() <= 2 && scale == int(scale) &&        // no item widgets, integral scale?
+       !(_prefs.selectmode() == FL_TREE_SELECT_SINGLE_DRAGGABLE && Fl::pushed() == this) ) {
+    fl_scroll(_tix, _tiy, _tiw, _tih, _drawn_hpos - hpos, _drawn_vpos - vpos,
+              scroll_draw_cb, this);
+  } else {
+    draw_tree_area(d & ~FL_DAMAGE_CHILD);               // redraw entire widget?
   }
+  _drawn_hpos = hpos;
+  _drawn_vpos = vpos;
+  if ( ! _root ) return;
   // Draw scrollbars last
   draw_child(*_vscroll);
   draw_child(*_hscroll);
@@ -2359,7 +2413,8 @@ void Fl_Tree::item_draw_mode(int mode) {
 int Fl_Tree::displayed(Fl_Tree_Item *item) {
   item = item ? item : first();
   if (!item) return(0);
-  return( (item->y() >= y()) && (item->y() <= (y()+h()-item->h())) ? 1 : 0);
+  int Y = item_y(item);
+  return( (Y >= y()) && (Y <= (y()+h()-item->h())) ? 1 : 0);
 }
 
 /// Adjust the vertical scrollbar so that \p 'item' is visible
@@ -2379,7 +2434,7 @@ int Fl_Tree::displayed(Fl_Tree_Item *item) {
 void Fl_Tree::show_item(Fl_Tree_Item *item, int yoff) {
   item = item ? item : first();
   if (!item) return;
-  int newval = item->y() - y() - yoff + (int)_vscroll->value();
+  int newval = item_y(item) - y() - yoff + (int)_vscroll->value();
   if ( newval < _vscroll->minimum() ) newval = (int)_vscroll->minimum();
   if ( newval > _vscroll->maximum() ) newval = (int)_vscroll->maximum();
   _vscroll->value(newval);
@@ -2456,7 +2511,7 @@ void Fl_Tree::vposition(int pos) {
   if (pos > _vscroll->maximum()) pos = (int)_vscroll->maximum();
   if (pos == _vscroll->value()) return;
   _vscroll->value(pos);
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
 }
 
 /// Returns the horizontal scroll position as a pixel offset.
@@ -2481,7 +2536,7 @@ void Fl_Tree::hposition(int pos) {
   if (pos > _hscroll->maximum()) pos = (int)_hscroll->maximum();
   if (pos == _hscroll->value()) return;
   _hscroll->value(pos);
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
 }
 
 /**
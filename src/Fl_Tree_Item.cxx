@@ -73,6 +73,9 @@ void Fl_Tree_Item::_Init(const Fl_Tree_Prefs &prefs, Fl_Tree *tree) {
   _children.manage_item_destroy(1);     // let array's dtor manage destroying Fl_Tree_Items
   _prev_sibling     = 0;
   _next_sibling     = 0;
+  _layout_y         = 0;
+  _layout_h         = 0;
+  _layout_widgets   = 0;
 }
 
 /// Constructor.
@@ -129,6 +132,9 @@ Fl_Tree_Item::Fl_Tree_Item(const Fl_Tree_Item *o) {
   _parent           = o->_parent;
   _prev_sibling     = 0;                // do not copy ptrs! use update_prev_next()
   _next_sibling     = 0;                // do not copy ptrs! use update_prev_next()
+  _layout_y         = 0;
+  _layout_h         = 0;
+  _layout_widgets   = 0;
 }
 
 /// Print the tree as 'ascii art' to stdout.
@@ -438,6 +444,7 @@ Fl_Tree_Item *Fl_Tree_Item::insert_above(const Fl_Tree_Prefs &prefs, const char
 Fl_Tree_Item* Fl_Tree_Item::deparent(int pos) {
   Fl_Tree_Item *orphan = _children[pos];
   if ( _children.deparent(pos) < 0 ) return NULL;
+  recalc_tree();                // may change tree geometry
   return orphan;
 }
 
@@ -452,6 +459,7 @@ int Fl_Tree_Item::reparent(Fl_Tree_Item *newchild, int pos) {
   int ret;
   if ( (ret = _children.reparent(newchild, this, pos)) < 0 ) return ret;
   newchild->parent(this);               // take custody
+  recalc_tree();                        // may change tree geometry
   return 0;
 }
 
@@ -464,6 +472,7 @@ int Fl_Tree_Item::reparent(Fl_Tree_Item *newchild, int pos) {
 /// \see move_above(), move_below(), move_into(), move(Fl_Tree_Item*,int,int)
 ///
 int Fl_Tree_Item::move(int to, int from) {
+  recalc_tree();                // may change tree geometry
   return _children.move(to, from);
 }
 
@@ -673,6 +682,7 @@ int Fl_Tree_Item::remove_child(const char *name) {
 ///
 void Fl_Tree_Item::swap_children(int ax, int bx) {
   _children.swap(ax, bx);
+  recalc_tree();                // may change tree geometry
 }
 
 /// Swap two of our immediate children, given item pointers.
@@ -762,6 +772,9 @@ void Fl_Tree_Item::draw_vertical_connector(int x, int y1, int y2, const Fl_Tree_
 /// \version 1.3.3 ABI feature
 ///
 const Fl_Tree_Item *Fl_Tree_Item::find_clicked(const Fl_Tree_Prefs &prefs, int yonly) const {
+  // Tree's layout is up to date? Then only descend into the matching subtrees
+  if ( _tree && _tree->_tree_w >= 0 )
+    return(_find_clicked(prefs, yonly, _tree->item_y(this)));
   if ( ! is_visible() ) return(0);
   if ( is_root() && !prefs.showroot() ) {
     // skip event check if we're root but root not being shown
@@ -788,6 +801,45 @@ const Fl_Tree_Item *Fl_Tree_Item::find_clicked(const Fl_Tree_Prefs &prefs, int y
   return(0);
 }
 
+// Find the item that the last event was over using the layout of the last
+// draw(), where Y is the current top of this item. Binary searches the
+// children for the first one that reaches down to the event, so this only
+// looks at the items along the path to the clicked item.
+//
+const Fl_Tree_Item *Fl_Tree_Item::_find_clicked(const Fl_Tree_Prefs &prefs, int yonly, int Y) const {
+  if ( ! is_visible() ) return(0);
+  int ey = Fl::event_y();
+  if ( is_root() && !prefs.showroot() ) {
+    // skip event check if we're root but root not being shown
+  } else {
+    // See if event is over us
+    if ( yonly ) {
+      if ( ey >= Y && ey <= (Y+_xywh[3]) ) {
+        return(this);
+      }
+    } else {
+      if ( Fl::event_inside(_xywh[0], Y, _xywh[2], _xywh[3]) ) {
+        return(this);
+      }
+    }
+  }
+  if ( is_open() ) {                            // open? check children of this item
+    int lo = 0, hi = children();
+    while ( lo < hi ) {                         // first child whose bottom is not above event
+      int mid = (lo + hi) / 2;
+      const Fl_Tree_Item *c = _children[mid];
+      if ( Y + c->_layout_y + c->_layout_h < ey ) lo = mid + 1;
+      else hi = mid;
+    }
+    for ( int t=lo; t<children() && Y + _children[t]->_layout_y <= ey; t++ ) {
+      const Fl_Tree_Item *item;
+      if ( (item = _children[t]->_find_clicked(prefs, yonly, Y + _children[t]->_layout_y)) != NULL )
+        return(item);
+    }
+  }
+  return(0);
+}
+
 /// Non-const version of Fl_Tree_Item::find_clicked(const Fl_Tree_Prefs&,int) const
 Fl_Tree_Item *Fl_Tree_Item::find_clicked(const Fl_Tree_Prefs &prefs, int yonly) {
   // "Effective C++, 3rd Ed", p.23. Sola fide, Amen.
@@ -1008,9 +1060,12 @@ int Fl_Tree_Item::draw_item_content(int render) {
 void Fl_Tree_Item::draw(int X, int &Y, int W, Fl_Tree_Item *itemfocus,
                         int &tree_item_xmax, int lastchild, int render) {
   Fl_Tree_Prefs &prefs = _tree->_prefs;
-  if ( !is_visible() ) return;
+  if ( !is_visible() ) { _layout_widgets = 0; return; }
+  int Y0 = Y;                           // top of this item, children's _layout_y is relative to this
   int tree_top = tree()->_tiy;
   int tree_bot = tree_top + tree()->_tih;
+  int draw_top = tree()->_draw_top;     // part of the tree area being drawn
+  int draw_bot = tree()->_draw_bot;
   int H = calc_item_height(prefs);      // height of item
   int H2 = H + prefs.linespacing();     // height of item with line spacing
 
@@ -1083,7 +1138,7 @@ void Fl_Tree_Item::draw(int X, int &Y, int W, Fl_Tree_Item *itemfocus,
       widget()->resize(wx,wy,ww,wh);            // we'll handle redraw below
     }
   }
-  char clipped = ((Y+H) < tree_top) || (Y>tree_bot) ? 1 : 0;
+  char clipped = ((Y+H) < draw_top) || (Y>draw_bot) ? 1 : 0;
   if (!render) clipped = 0;                     // NOT rendering? Then don't clip, so we calc unclipped items
   char active = (is_active() && tree()->active_r()) ? 1 : 0;
   char drawthis = ( is_root() && prefs.showroot() == 0 ) ? 0 : 1;
@@ -1160,26 +1215,52 @@ void Fl_Tree_Item::draw(int X, int &Y, int W, Fl_Tree_Item *itemfocus,
   if ( xmax > tree_item_xmax )
     tree_item_xmax = xmax;
   // Draw child items (if any)
+  int widgets = widget() ? 1 : 0;
   if ( has_children() && is_open() ) {
     int child_x = drawthis ? (hconn_x_center - (icon_w/2) + 1)  // offset children to right,
                            : X;                                 // unless didn't drawthis
     int child_w = W - (child_x-X);
     int child_y_start = Y;
-    for ( int t=0; t<children(); t++ ) {
+    // When rendering, skip children scrolled off-screen using the layout
+    // calc_tree() saved, unless widgets in their subtrees need to be moved.
+    int skip = render && tree()->_tree_w >= 0 && _layout_widgets == widgets;
+    int t = 0;
+    if ( skip ) {
+      int lo = 0, hi = children();
+      while ( lo < hi ) {                       // first child that reaches into the viewport
+        int mid = (lo + hi) / 2;
+        Fl_Tree_Item *c = _children[mid];
+        if ( Y0 + c->_layout_y + c->_layout_h < tree_top ) lo = mid + 1;
+        else hi = mid;
+      }
+      if ( (t = lo) > 0 )
+        Y = Y0 + _children[t-1]->_layout_y + _children[t-1]->_layout_h;
+    }
+    for ( ; t<children(); t++ ) {
+      Fl_Tree_Item *child = _children[t];
+      if ( skip && Y > tree_bot ) {             // remaining children are below the viewport
+        Fl_Tree_Item *last = _children[children()-1];
+        Y = Y0 + last->_layout_y + last->_layout_h;
+        break;
+      }
       int is_lastchild = ((t+1)==children()) ? 1 : 0;
-      _children[t]->draw(child_x, Y, child_w, itemfocus, tree_item_xmax, is_lastchild, render);
+      child->_layout_y = Y - Y0;
+      child->draw(child_x, Y, child_w, itemfocus, tree_item_xmax, is_lastchild, render);
+      child->_layout_h = Y - Y0 - child->_layout_y;
+      widgets += child->_layout_widgets;
     }
     if ( has_children() && is_open() ) {
       Y += prefs.openchild_marginbottom();              // offset below open child tree
     }
     if ( ! lastchild ) {
       // Special 'clipped' calculation. (intentional variable shadowing)
-      int is_clipped = ((child_y_start < tree_top) && (Y < tree_top)) ||
-                       ((child_y_start > tree_bot) && (Y > tree_bot));
+      int is_clipped = ((child_y_start < draw_top) && (Y < draw_top)) ||
+                       ((child_y_start > draw_bot) && (Y > draw_bot));
       if (render && !is_clipped )
         draw_vertical_connector(hconn_x, child_y_start, Y, prefs);
     }
   }
+  _layout_widgets = widgets;
 }
 
 
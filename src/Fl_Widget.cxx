@@ -139,6 +139,8 @@ Fl_Widget::Fl_Widget(int X, int Y, int W, int H, const char* L) {
 
 void Fl_Widget::resize(int X, int Y, int W, int H) {
   x_ = X; y_ = Y; w_ = W; h_ = H;
+  // parent_ may be a widget that is not a group, see Fl_Value_Input
+  if (parent_ && parent_->as_group()) parent_->child_resized();
 }
 
 // this is useful for parent widgets to call to resize children:
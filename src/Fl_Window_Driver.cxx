@@ -58,8 +58,14 @@ int Fl_Window_Driver::dh() {return pWindow->dh;}
 int Fl_Window_Driver::aspect() {return pWindow->aspect;}
 int Fl_Window_Driver::force_position() {return pWindow->force_position(); }
 void Fl_Window_Driver::force_position(int c) { pWindow->force_position(c); }
-void Fl_Window_Driver::x(int X) {pWindow->x(X); }
-void Fl_Window_Driver::y(int Y) {pWindow->y(Y); }
+void Fl_Window_Driver::x(int X) {
+  pWindow->x(X);
+  if (pWindow->parent()) pWindow->parent()->child_resized();
+}
+void Fl_Window_Driver::y(int Y) {
+  pWindow->y(Y);
+  if (pWindow->parent()) pWindow->parent()->child_resized();
+}
 int Fl_Window_Driver::fullscreen_screen_top() {return pWindow->fullscreen_screen_top;}
 int Fl_Window_Driver::fullscreen_screen_bottom() {return pWindow->fullscreen_screen_bottom;}
 int Fl_Window_Driver::fullscreen_screen_left() {return pWindow->fullscreen_screen_left;}
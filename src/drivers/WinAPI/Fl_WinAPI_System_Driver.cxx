@@ -56,8 +56,6 @@ typedef RPC_STATUS (WINAPI *uuid_func)(UUID __RPC_FAR *Uuid);
 inline int isdirsep(char c) { return c == '/' || c == '\\'; }
 
 static wchar_t *mbwbuf = NULL;
-static wchar_t *wbuf = NULL;
-static wchar_t *wbuf1 = NULL;
 
 extern "C" {
   int fl_scandir(const char *dirname, struct dirent ***namelist,
@@ -85,7 +83,10 @@ extern "C" {
   'wbuf' is NULL a new buffer is allocated with realloc(). Hence the pointer
   'wbuf' can be shared among multiple calls to this function if it has been
   initialized with NULL (or malloc or realloc) before the first call.
-  Ideally every call to this function has its own static pointer though.
+
+  The file system functions below convert into a local buffer that is
+  freed before they return, since they can be called by worker threads,
+  e.g. by Fl_File_Browser::load_async() and Fl_Shared_Image::get_async().
 
   The return value is either the old value of 'wbuf' (if the string fits)
   or a pointer at the (re)allocated buffer.
@@ -191,7 +192,9 @@ char *Fl_WinAPI_System_Driver::utf2mbcs(const char *utf8) {
 
 char *Fl_WinAPI_System_Driver::getenv(const char *var) {
   static char *buf = NULL;
+  wchar_t *wbuf = NULL;
   wchar_t *ret = _wgetenv(utf8_to_wchar(var, wbuf));
+  free(wbuf);
   if (!ret) return NULL;
   return wchar_to_utf8(ret, buf);
 }
@@ -208,9 +211,13 @@ int Fl_WinAPI_System_Driver::putenv(const char *var) {
 }
 
 int Fl_WinAPI_System_Driver::open(const char *fnam, int oflags, int pmode) {
+  wchar_t *wbuf = NULL;
   utf8_to_wchar(fnam, wbuf);
-  if (pmode == -1) return _wopen(wbuf, oflags);
-  else return _wopen(wbuf, oflags, pmode);
+  int ret;
+  if (pmode == -1) ret = _wopen(wbuf, oflags);
+  else ret = _wopen(wbuf, oflags, pmode);
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::open_ext(const char *fnam, int binary, int oflags, int pmode) {
@@ -220,16 +227,23 @@ int Fl_WinAPI_System_Driver::open_ext(const char *fnam, int binary, int oflags,
 }
 
 FILE *Fl_WinAPI_System_Driver::fopen(const char *fnam, const char *mode) {
+  wchar_t *wbuf = NULL, *wbuf1 = NULL;
   utf8_to_wchar(fnam, wbuf);
   utf8_to_wchar(mode, wbuf1);
-  return _wfopen(wbuf, wbuf1);
+  FILE *ret = _wfopen(wbuf, wbuf1);
+  free(wbuf);
+  free(wbuf1);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::system(const char *cmd) {
 # ifdef __MINGW32__
   return ::system(fl_utf2mbcs(cmd));
 # else
-  return _wsystem(utf8_to_wchar(cmd, wbuf));
+  wchar_t *wbuf = NULL;
+  int ret = _wsystem(utf8_to_wchar(cmd, wbuf));
+  free(wbuf);
+  return ret;
 # endif
 }
 
@@ -238,6 +252,7 @@ int Fl_WinAPI_System_Driver::execvp(const char *file, char *const *argv) {
   return _execvp(fl_utf2mbcs(file), argv);
 # else
   wchar_t **ar;
+  wchar_t *wbuf = NULL;
   utf8_to_wchar(file, wbuf);
 
   int i = 0, n = 0;
@@ -261,16 +276,23 @@ int Fl_WinAPI_System_Driver::execvp(const char *file, char *const *argv) {
     i++;
   }
   free(ar);
+  free(wbuf);
   return -1;            // STR #3040
 #endif
 }
 
 int Fl_WinAPI_System_Driver::chmod(const char *fnam, int mode) {
-  return _wchmod(utf8_to_wchar(fnam, wbuf), mode);
+  wchar_t *wbuf = NULL;
+  int ret = _wchmod(utf8_to_wchar(fnam, wbuf), mode);
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::access(const char *fnam, int mode) {
-  return _waccess(utf8_to_wchar(fnam, wbuf), mode);
+  wchar_t *wbuf = NULL;
+  int ret = _waccess(utf8_to_wchar(fnam, wbuf), mode);
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::stat(const char *fnam, struct stat *b) {
@@ -280,7 +302,10 @@ int Fl_WinAPI_System_Driver::stat(const char *fnam, struct stat *b) {
   if (len > 0 && (fnam[len-1] == '/' || fnam[len-1] == '\\'))
     len--;
   // convert filename and execute _wstat()
-  return _wstat(utf8_to_wchar(fnam, wbuf, len), (struct _stat *)b);
+  wchar_t *wbuf = NULL;
+  int ret = _wstat(utf8_to_wchar(fnam, wbuf, len), (struct _stat *)b);
+  free(wbuf);
+  return ret;
 }
 
 char *Fl_WinAPI_System_Driver::getcwd(char *buf, int len) {
@@ -298,25 +323,51 @@ char *Fl_WinAPI_System_Driver::getcwd(char *buf, int len) {
 }
 
 int Fl_WinAPI_System_Driver::chdir(const char *path) {
-  return _wchdir(utf8_to_wchar(path, wbuf));
+  wchar_t *wbuf = NULL;
+  int ret = _wchdir(utf8_to_wchar(path, wbuf));
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::unlink(const char *fnam) {
-  return _wunlink(utf8_to_wchar(fnam, wbuf));
+  wchar_t *wbuf = NULL;
+  int ret = _wunlink(utf8_to_wchar(fnam, wbuf));
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::mkdir(const char *fnam, int mode) {
-  return _wmkdir(utf8_to_wchar(fnam, wbuf));
+  wchar_t *wbuf = NULL;
+  int ret = _wmkdir(utf8_to_wchar(fnam, wbuf));
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::rmdir(const char *fnam) {
-  return _wrmdir(utf8_to_wchar(fnam, wbuf));
+  wchar_t *wbuf = NULL;
+  int ret = _wrmdir(utf8_to_wchar(fnam, wbuf));
+  free(wbuf);
+  return ret;
 }
 
 int Fl_WinAPI_System_Driver::rename(const char *fnam, const char *newnam) {
+  wchar_t *wbuf = NULL, *wbuf1 = NULL;
   utf8_to_wchar(fnam, wbuf);
   utf8_to_wchar(newnam, wbuf1);
-  return _wrename(wbuf, wbuf1);
+  int ret = _wrename(wbuf, wbuf1);
+  free(wbuf);
+  free(wbuf1);
+  return ret;
+}
+
+int Fl_WinAPI_System_Driver::rename_replace(const char *fnam, const char *newnam) {
+  wchar_t *wbuf = NULL, *wbuf1 = NULL;
+  utf8_to_wchar(fnam, wbuf);
+  utf8_to_wchar(newnam, wbuf1);
+  int ret = MoveFileExW(wbuf, wbuf1, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+  free(wbuf);
+  free(wbuf1);
+  return ret;
 }
 
 // Two Windows-specific functions fl_utf8_to_locale() and fl_locale_to_utf8()
@@ -913,7 +964,10 @@ char *Fl_WinAPI_System_Driver::preference_rootnode(Fl_Preferences *prefs, Fl_Pre
 }
 
 void *Fl_WinAPI_System_Driver::load(const char *filename) {
-  return LoadLibraryW(utf8_to_wchar(filename, wbuf));
+  wchar_t *wbuf = NULL;
+  void *ret = LoadLibraryW(utf8_to_wchar(filename, wbuf));
+  free(wbuf);
+  return ret;
 }
 
 void Fl_WinAPI_System_Driver::png_extra_rgba_processing(unsigned char *ptr, int w, int h)
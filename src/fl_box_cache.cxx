@@ -0,0 +1,248 @@
+//
+// Box drawing cache for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Cache of pre-rendered boxes for the gradient box types of the "gleam",
+// "plastic", and "gtk+" schemes. These box types draw dozens of lines
+// in different colors for each box, which is slow if many boxes must be
+// drawn.
+//
+// The box types using the cache are horizontally uniform except for a
+// few columns at the left and right edges. A cached box consists of
+// three images: the left edge, a part of the uniform middle, and the right
+// edge. Boxes of the same type, height, and color but different widths
+// share the same images, the middle image is repeated as often as needed.
+// Pixels that are not drawn by the box function are transparent.
+
+#include <FL/Fl.H>
+#include <FL/fl_draw.H>
+#include <FL/Fl_Device.H>
+#include <FL/Fl_Graphics_Driver.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_RGB_Image.H>
+#include <stdlib.h>
+#include <string.h>
+#include "fl_box_cache.h"
+
+extern unsigned fl_cmap[256];
+
+// width of the middle image in FLTK units
+#define MIDDLE_W 32
+
+struct Fl_Box_Cache_Entry {
+  Fl_Box_Draw_F *f;             // box drawing function
+  int edge, h;                  // edge width and box height
+  Fl_Color c;                   // box color
+  int active;                   // Fl::draw_box_active()
+  float scale;                  // scale factor of the display
+  Fl_RGB_Image *left, *middle, *right;
+  int bytes;                    // memory used by the images
+  unsigned long stamp;          // last use, for LRU eviction
+  Fl_Box_Cache_Entry *next;     // next entry in hash bucket
+};
+
+#define HASH_SIZE 256
+
+static int cache_size = 0;              // byte budget, 0 = disabled
+static int cache_used = 0;              // bytes currently used
+static unsigned long cache_stamp = 0;
+static Fl_Box_Cache_Entry *cache[HASH_SIZE];
+static unsigned cache_cmap[256];        // colormap the cache was built with
+
+static void free_entry(Fl_Box_Cache_Entry *e) {
+  cache_used -= e->bytes;
+  delete e->left;
+  delete e->middle;
+  delete e->right;
+  delete e;
+}
+
+static void flush_cache() {
+  for (int i = 0; i < HASH_SIZE; i++) {
+    while (cache[i]) {
+      Fl_Box_Cache_Entry *e = cache[i];
+      cache[i] = e->next;
+      free_entry(e);
+    }
+  }
+}
+
+// Remove least recently used entries until the cache fits into max bytes.
+static void trim_cache(int max) {
+  while (cache_used > max) {
+    Fl_Box_Cache_Entry **oldest = 0;
+    for (int i = 0; i < HASH_SIZE; i++)
+      for (Fl_Box_Cache_Entry **p = cache + i; *p; p = &(*p)->next)
+        if (!oldest || (*p)->stamp < (*oldest)->stamp) oldest = p;
+    if (!oldest) break;
+    Fl_Box_Cache_Entry *e = *oldest;
+    *oldest = e->next;
+    free_entry(e);
+  }
+}
+
+/**
+  Sets the memory budget of the box drawing cache in bytes.
+
+  The gradient box types of the "gleam", "plastic", and "gtk+" schemes
+  draw many lines in different colors for each box. If the cache is
+  enabled these boxes are rendered once per box type, height, and color
+  and later drawn as images, which is much faster if many boxes of the
+  same kind must be drawn.
+
+  The cache is disabled by default (size 0). A budget of one or a few
+  megabytes is typically sufficient for all boxes of an application.
+  Setting a smaller size frees the least recently used cached boxes.
+
+  \param[in] bytes  maximum memory used by the cache, 0 disables the cache
+
+  \since 1.4.0
+*/
+void Fl::box_cache_size(int bytes) {
+  cache_size = bytes < 0 ? 0 : bytes;
+  trim_cache(cache_size);
+}
+
+/**
+  Returns the memory budget of the box drawing cache in bytes.
+  \see Fl::box_cache_size(int)
+  \since 1.4.0
+*/
+int Fl::box_cache_size() {
+  return cache_size;
+}
+
+// Make an image from a part of the box drawn on a white and a black
+// background, pixels that differ are not drawn by the box function and
+// are transparent.
+static Fl_RGB_Image *make_part(const uchar *white, const uchar *black, int ld,
+                               int X, int W, int H, int w, int h) {
+  int alpha = 0, x, y;
+  for (y = 0; y < H && !alpha; y++) {
+    const uchar *pw = white + y * ld + X * 3, *pb = black + y * ld + X * 3;
+    if (memcmp(pw, pb, W * 3)) alpha = 1;
+  }
+  int d = alpha ? 4 : 3;
+  uchar *array = new uchar[W * H * d], *p = array;
+  for (y = 0; y < H; y++) {
+    const uchar *pw = white + y * ld + X * 3, *pb = black + y * ld + X * 3;
+    for (x = 0; x < W; x++, pw += 3, pb += 3) {
+      *p++ = pw[0];
+      *p++ = pw[1];
+      *p++ = pw[2];
+      if (alpha) *p++ = (pw[0] == pb[0] && pw[1] == pb[1] && pw[2] == pb[2]) ? 255 : 0;
+    }
+  }
+  Fl_RGB_Image *img = new Fl_RGB_Image(array, W, H, d);
+  img->alloc_array = 1;
+  img->scale(w, h, 0, 1);
+  return img;
+}
+
+// Render a box on an image surface with the given background color.
+static Fl_RGB_Image *render(Fl_Box_Draw_F *f, int w, int h, Fl_Color c, Fl_Color bg) {
+  Fl_Image_Surface *surf = new Fl_Image_Surface(w, h, 1);
+  Fl_Surface_Device::push_current(surf);
+  fl_color(bg);
+  fl_rectf(0, 0, w, h);
+  f(0, 0, w, h, c);
+  Fl_RGB_Image *img = surf->image();
+  Fl_Surface_Device::pop_current();
+  delete surf;
+  return img;
+}
+
+static Fl_Box_Cache_Entry *make_entry(Fl_Box_Draw_F *f, int edge, int h, Fl_Color c) {
+  int w = 2 * edge + MIDDLE_W;
+  Fl_RGB_Image *white = render(f, w, h, c, FL_WHITE);
+  Fl_RGB_Image *black = render(f, w, h, c, FL_BLACK);
+  Fl_Box_Cache_Entry *e = 0;
+  if (white->d() == 3 && black->d() == 3 &&
+      white->data_w() == black->data_w() && white->data_h() == black->data_h()) {
+    int W = white->data_w(), H = white->data_h();
+    int ld = white->ld() ? white->ld() : W * 3;
+    int E = W * edge / w; // edge width in pixels
+    const uchar *pw = (const uchar *)white->data()[0];
+    const uchar *pb = (const uchar *)black->data()[0];
+    e = new Fl_Box_Cache_Entry;
+    e->left = make_part(pw, pb, ld, 0, E, H, edge, h);
+    e->middle = make_part(pw, pb, ld, E, W - 2 * E, H, MIDDLE_W, h);
+    e->right = make_part(pw, pb, ld, W - E, E, H, edge, h);
+    e->bytes = W * H * 4 + (int)sizeof(Fl_Box_Cache_Entry);
+  }
+  delete white;
+  delete black;
+  return e;
+}
+
+/*
+  Draws a box with the box drawing function f using the cache.
+
+  The box must look the same for all widths except for edge columns at
+  the left and the right side, i.e. all other columns must be identical.
+  Boxes that are too small, boxes that are not drawn on the display, and
+  all boxes if the cache is disabled are drawn directly.
+*/
+void fl_cached_box(Fl_Box_Draw_F *f, int edge, int x, int y, int w, int h, Fl_Color c) {
+  if (!cache_size || w < 2 * edge + MIDDLE_W || h <= 0 || h > 256 ||
+      Fl_Surface_Device::surface() != Fl_Display_Device::display_device()) {
+    f(x, y, w, h, c);
+    return;
+  }
+
+  // all colors may be derived from the colormap, e.g. after Fl::background()
+  if (memcmp(cache_cmap, fl_cmap, sizeof(fl_cmap))) {
+    flush_cache();
+    memcpy(cache_cmap, fl_cmap, sizeof(fl_cmap));
+  }
+
+  int active = Fl::draw_box_active();
+  float scale = fl_graphics_driver->scale();
+  unsigned hash = ((unsigned)(fl_intptr_t)f ^ (unsigned)c ^ (unsigned)(h * 31 + edge)) % HASH_SIZE;
+  Fl_Box_Cache_Entry *e;
+  for (e = cache[hash]; e; e = e->next) {
+    if (e->f == f && e->edge == edge && e->h == h && e->c == c &&
+        e->active == active && e->scale == scale) break;
+  }
+  if (!e) {
+    e = make_entry(f, edge, h, c);
+    if (!e || e->bytes > cache_size) {
+      if (e) {
+        cache_used += e->bytes; // free_entry() subtracts it
+        free_entry(e);
+      }
+      f(x, y, w, h, c);
+      return;
+    }
+    e->f = f;
+    e->edge = edge;
+    e->h = h;
+    e->c = c;
+    e->active = active;
+    e->scale = scale;
+    trim_cache(cache_size - e->bytes);
+    cache_used += e->bytes;
+    e->next = cache[hash];
+    cache[hash] = e;
+  }
+  e->stamp = ++cache_stamp;
+
+  // the middle part is uniform, so tiles may overlap the last one
+  e->left->draw(x, y);
+  int X, R = x + w - edge - MIDDLE_W;
+  for (X = x + edge; X < R; X += MIDDLE_W) e->middle->draw(X, y);
+  e->middle->draw(R, y);
+  e->right->draw(x + w - edge, y);
+}
@@ -0,0 +1,27 @@
+//
+// Internal box drawing cache header for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef FL_BOX_CACHE_H
+#define FL_BOX_CACHE_H
+
+#include <FL/Fl.H>
+
+// Draws a box with the box drawing function f through the box cache,
+// see fl_box_cache.cxx. All columns except for edge columns at the left
+// and the right side of the box must be identical.
+extern void fl_cached_box(Fl_Box_Draw_F *f, int edge, int x, int y, int w, int h, Fl_Color c);
+
+#endif // !FL_BOX_CACHE_H
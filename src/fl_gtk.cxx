@@ -23,6 +23,7 @@
 
 #include <FL/Fl.H>
 #include <FL/fl_draw.H>
+#include "fl_box_cache.h"
 
 extern void fl_internal_boxtype(Fl_Boxtype, Fl_Box_Draw_F*);
 
@@ -270,13 +271,32 @@ static void gtk_round_down_box(int x, int y, int w, int h, Fl_Color c) {
 
 #endif
 
+// Draw the rectangular boxes through the box cache, see Fl::box_cache_size().
+// All boxes are uniform except for 4 columns at the left and right side.
+
+static void cached_up_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(gtk_up_box, 4, x, y, w, h, c);
+}
+
+static void cached_down_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(gtk_down_box, 4, x, y, w, h, c);
+}
+
+static void cached_thin_up_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(gtk_thin_up_box, 4, x, y, w, h, c);
+}
+
+static void cached_thin_down_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(gtk_thin_down_box, 4, x, y, w, h, c);
+}
+
 Fl_Boxtype fl_define_FL_GTK_UP_BOX() {
-  fl_internal_boxtype(_FL_GTK_UP_BOX, gtk_up_box);
-  fl_internal_boxtype(_FL_GTK_DOWN_BOX, gtk_down_box);
+  fl_internal_boxtype(_FL_GTK_UP_BOX, cached_up_box);
+  fl_internal_boxtype(_FL_GTK_DOWN_BOX, cached_down_box);
   fl_internal_boxtype(_FL_GTK_UP_FRAME, gtk_up_frame);
   fl_internal_boxtype(_FL_GTK_DOWN_FRAME, gtk_down_frame);
-  fl_internal_boxtype(_FL_GTK_THIN_UP_BOX, gtk_thin_up_box);
-  fl_internal_boxtype(_FL_GTK_THIN_DOWN_BOX, gtk_thin_down_box);
+  fl_internal_boxtype(_FL_GTK_THIN_UP_BOX, cached_thin_up_box);
+  fl_internal_boxtype(_FL_GTK_THIN_DOWN_BOX, cached_thin_down_box);
   fl_internal_boxtype(_FL_GTK_THIN_UP_FRAME, gtk_thin_up_frame);
   fl_internal_boxtype(_FL_GTK_THIN_DOWN_FRAME, gtk_thin_down_frame);
   fl_internal_boxtype(_FL_GTK_ROUND_UP_BOX, gtk_round_up_box);
@@ -79,14 +79,20 @@ fl_check_images(const char *name,               // I - Filename
     return new Fl_PNM_Image(name);
 
 #ifdef HAVE_LIBPNG
-  if (memcmp(header, "\211PNG", 4) == 0)// PNG file
-    return new Fl_PNG_Image(name);
+  if (memcmp(header, "\211PNG", 4) == 0) { // PNG file
+    int W, H;
+    Fl_Shared_Image::requested_size(W, H);
+    return new Fl_PNG_Image(name, W, H);
+  }
 #endif // HAVE_LIBPNG
 
 #ifdef HAVE_LIBJPEG
   if (memcmp(header, "\377\330\377", 3) == 0 && // Start-of-Image
-      header[3] >= 0xc0 && header[3] <= 0xfe)   // APPn .. comment for JPEG file
-    return new Fl_JPEG_Image(name);
+      header[3] >= 0xc0 && header[3] <= 0xfe) { // APPn .. comment for JPEG file
+    int W, H;
+    Fl_Shared_Image::requested_size(W, H);
+    return new Fl_JPEG_Image(name, W, H);
+  }
 #endif // HAVE_LIBJPEG
 
 #ifdef FLTK_USE_SVG
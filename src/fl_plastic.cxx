@@ -24,6 +24,7 @@
 #include <FL/Fl.H>
 #include <FL/fl_draw.H>
 #include "flstring.h"
+#include "fl_box_cache.h"
 
 //
 // Uncomment the following line to restore the old plastic box type
@@ -348,16 +349,36 @@ static void down_round(int x, int y, int w, int h, Fl_Color c) {
 }
 
 
+// Draw the rectangular boxes through the box cache, see Fl::box_cache_size().
+// The boxes are uniform except for 4 columns at the left and right side
+// as long as they are shaded horizontally (h < 2 * w). The edges of tall
+// boxes are made wider so the cached box is shaded the same way.
+
+static void cached_thin_up_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(thin_up_box, h < 76 ? 4 : h / 2, x, y, w, h, c);
+}
+
+
+static void cached_up_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(up_box, h < 76 ? 4 : h / 2, x, y, w, h, c);
+}
+
+
+static void cached_down_box(int x, int y, int w, int h, Fl_Color c) {
+  fl_cached_box(down_box, h < 76 ? 4 : h / 2, x, y, w, h, c);
+}
+
+
 extern void fl_internal_boxtype(Fl_Boxtype, Fl_Box_Draw_F*);
 
 
 Fl_Boxtype fl_define_FL_PLASTIC_UP_BOX() {
-  fl_internal_boxtype(_FL_PLASTIC_UP_BOX, up_box);
-  fl_internal_boxtype(_FL_PLASTIC_DOWN_BOX, down_box);
+  fl_internal_boxtype(_FL_PLASTIC_UP_BOX, cached_up_box);
+  fl_internal_boxtype(_FL_PLASTIC_DOWN_BOX, cached_down_box);
   fl_internal_boxtype(_FL_PLASTIC_UP_FRAME, up_frame);
   fl_internal_boxtype(_FL_PLASTIC_DOWN_FRAME, down_frame);
-  fl_internal_boxtype(_FL_PLASTIC_THIN_UP_BOX, thin_up_box);
-  fl_internal_boxtype(_FL_PLASTIC_THIN_DOWN_BOX, down_box);
+  fl_internal_boxtype(_FL_PLASTIC_THIN_UP_BOX, cached_thin_up_box);
+  fl_internal_boxtype(_FL_PLASTIC_THIN_DOWN_BOX, cached_down_box);
   fl_internal_boxtype(_FL_PLASTIC_ROUND_UP_BOX, up_round);
   fl_internal_boxtype(_FL_PLASTIC_ROUND_DOWN_BOX, down_round);
 
@@ -0,0 +1,65 @@
+//
+// Internal thread support for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include "fl_thread.h"
+
+#if defined(_WIN32)
+#  include <process.h>
+#endif
+
+#if defined(_WIN32) || defined(HAVE_PTHREAD)
+
+// Function and argument of a thread being started
+struct Fl_Thread_Start {
+  void  (*func)(void *);
+  void  *arg;
+};
+
+#if defined(_WIN32)
+static unsigned __stdcall thread_main(void *p) {
+#else
+static void *thread_main(void *p) {
+#endif // _WIN32
+  Fl_Thread_Start start = *(Fl_Thread_Start *)p;
+  delete (Fl_Thread_Start *)p;
+  (start.func)(start.arg);
+  return 0;
+}
+
+#endif // _WIN32 || HAVE_PTHREAD
+
+int fl_start_thread(void (*func)(void *), void *arg) {
+#if defined(_WIN32) || defined(HAVE_PTHREAD)
+  Fl_Thread_Start *start = new Fl_Thread_Start;
+  start->func = func;
+  start->arg  = arg;
+#  if defined(_WIN32)
+  uintptr_t thread = _beginthreadex(NULL, 0, thread_main, start, 0, NULL);
+  if (thread) {
+    CloseHandle((HANDLE)thread);
+    return 1;
+  }
+#  else
+  pthread_t thread;
+  if (!pthread_create(&thread, NULL, thread_main, start)) {
+    pthread_detach(thread);
+    return 1;
+  }
+#  endif // _WIN32
+  delete start;
+#endif // _WIN32 || HAVE_PTHREAD
+  return 0;
+}
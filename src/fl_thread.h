@@ -0,0 +1,69 @@
+//
+// Internal thread support header for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef FL_THREAD_H
+#define FL_THREAD_H
+
+// The library uses worker threads for jobs that would block the user
+// interface, like reading huge directories (Fl_File_Browser::load_async())
+// or decoding images (Fl_Shared_Image::get_async()). Workers never call
+// widget or drawing functions, the main thread polls their results.
+
+#include <config.h>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#  include <pthread.h>
+#endif
+
+// Variables that have one instance per thread, not defined if the
+// compiler has no support for them
+#if defined(_MSC_VER)
+#  define FL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#  define FL_THREAD_LOCAL __thread
+#endif
+
+// A mutex for static data shared by the main thread and worker threads.
+// Instances must be static, the lock functions do nothing if the library
+// was built without threads. The mutex is never destroyed, because detached
+// workers may still lock it while static objects are destroyed at exit.
+class Fl_Thread_Mutex {
+#if defined(_WIN32)
+  CRITICAL_SECTION cs_;
+public:
+  Fl_Thread_Mutex() { InitializeCriticalSection(&cs_); }
+  void lock() { EnterCriticalSection(&cs_); }
+  void unlock() { LeaveCriticalSection(&cs_); }
+#elif defined(HAVE_PTHREAD)
+  pthread_mutex_t mutex_;
+public:
+  Fl_Thread_Mutex() { pthread_mutex_init(&mutex_, NULL); }
+  void lock() { pthread_mutex_lock(&mutex_); }
+  void unlock() { pthread_mutex_unlock(&mutex_); }
+#else
+public:
+  void lock() {}
+  void unlock() {}
+#endif // _WIN32
+};
+
+// Starts a detached thread that calls func(arg), returns 0 if the thread
+// could not be started or the library was built without threads.
+extern int fl_start_thread(void (*func)(void *), void *arg);
+
+#endif // !FL_THREAD_H
@@ -0,0 +1,216 @@
+//
+// Unit tests for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_File_Browser.H>
+#include <FL/Fl_Simple_Terminal.H>
+#include <FL/fl_utf8.h>
+#include <FL/filename.H>
+#include <sys/types.h>
+#include <time.h>
+#ifdef _WIN32
+#  include <sys/utime.h>
+#else
+#  include <utime.h>
+#endif
+
+// Number of files in the test directory, more than the browser adds at once
+#define FB_TEST_FILES 2500
+
+//
+//------- test loading directories into Fl_File_Browser ----------
+//
+class FileBrowserTest : public Fl_Group {
+  Fl_Simple_Terminal *tty;
+  int nfailed;
+  char dir[1024];
+  int ncalls;
+
+  void check(int ok, const char *what, const char *name) {
+    if (!ok) {
+      tty->printf("\033[31mFAILED\033[0m: %s (%s)\n", what, name);
+      nfailed++;
+    }
+  }
+
+  static void load_cb(Fl_Widget *, void *v) {
+    ((FileBrowserTest *)v)->ncalls++;
+  }
+
+  // Create an empty file in the test directory
+  int make_file(const char *name) {
+    char path[1200];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fl_fopen(path, "w");
+    if (!f) return 0;
+    fclose(f);
+    return 1;
+  }
+
+  // Set the modification time of the test directory, returns 0 if the
+  // system can't do that
+  int set_dir_time(time_t mtime) {
+    struct utimbuf t;
+    t.actime = t.modtime = mtime;
+    return utime(dir, &t) == 0;
+  }
+
+  // Create the test directory with two subdirectories and many files
+  int make_dir() {
+    const char *tmp = fl_getenv("TMPDIR");
+    if (!tmp) tmp = fl_getenv("TEMP");
+    if (!tmp) tmp = "/tmp";
+    snprintf(dir, sizeof(dir), "%s/fltk_unittest_file_browser", tmp);
+    remove_dir();
+    if (!fl_make_path(dir)) return 0;
+    char path[1200];
+    snprintf(path, sizeof(path), "%s/zsub", dir);
+    fl_mkdir(path, 0777);
+    snprintf(path, sizeof(path), "%s/asub", dir);
+    fl_mkdir(path, 0777);
+    for (int i = 0; i < FB_TEST_FILES; i++) {
+      char name[32];
+      snprintf(name, sizeof(name), "file%d.txt", i);
+      if (!make_file(name)) return 0;
+    }
+    return 1;
+  }
+
+  void remove_dir() {
+    dirent **files;
+    char path[1200];
+    int n = fl_filename_list(dir, &files);
+    for (int i = 0; i < n; i++) {
+      snprintf(path, sizeof(path), "%s/%s", dir, files[i]->d_name);
+      if (fl_filename_isdir(path)) fl_rmdir(path);
+      else fl_unlink(path);
+    }
+    if (n > 0) fl_filename_free_list(&files, n);
+    fl_rmdir(dir);
+  }
+
+  // Load the test directory with load_async() and wait until all files
+  // were added, returns the number of lines
+  int load_async(Fl_File_Browser &fb) {
+    ncalls = 0;
+    int ret = fb.load_async(dir);
+    check(ret == 1, "load_async() returns 1", dir);
+    for (int i = 0; i < 500 && fb.loading(); i++) Fl::wait(0.02);
+    check(!fb.loading(), "load_async() finishes", dir);
+    check(ncalls > 0, "load callback is called", dir);
+    return fb.size();
+  }
+
+  // Check that both browsers list the same lines
+  void check_same(Fl_File_Browser &a, Fl_File_Browser &b, const char *name) {
+    check(a.size() == b.size(), "number of lines", name);
+    if (a.size() != b.size()) return;
+    for (int i = 1; i <= a.size(); i++)
+      if (strcmp(a.text(i), b.text(i))) {
+        check(0, "lines are the same", name);
+        break;
+      }
+  }
+
+  void run() {
+    Fl_File_Browser ref(0, 0, 100, 100), fb(0, 0, 100, 100);
+    fb.load_callback(load_cb, this);
+
+    // load() and load_async() must list the same files...
+    int i, n = ref.load(dir);
+    check(n >= FB_TEST_FILES + 2, "load() returns all files", "load");
+    check(ref.size() >= FB_TEST_FILES + 2, "all files are listed", "load");
+    for (i = 1; i <= ref.size(); i++) {
+      const char *text = ref.text(i);
+      if (text[strlen(text) - 1] != '/') break;
+    }
+    check(i > 2 && !strcmp(ref.text(i - 2), "asub/") && !strcmp(ref.text(i - 1), "zsub/"),
+          "directories are on top", "load");
+    load_async(fb);
+    check_same(ref, fb, "load_async");
+    check(!fb.errmsg(), "no error message", "load_async");
+
+    // load_cancel() stops adding files and doesn't call the callback...
+    ncalls = 0;
+    fb.load_async(dir);
+    fb.load_cancel();
+    int size = fb.size();
+    for (i = 0; i < 10; i++) Fl::wait(0.02);
+    check(!fb.loading(), "loading() returns 0", "load_cancel");
+    check(fb.size() == size, "no files are added", "load_cancel");
+    check(ncalls == 0, "load callback is not called", "load_cancel");
+
+    // Listings are cached until the modification time changes, a file
+    // added without a new modification time doesn't show up...
+    time_t now = time(0);
+    if (set_dir_time(now - 60)) {
+      load_async(fb);
+      check_same(ref, fb, "cached");
+      make_file("new.txt");
+      set_dir_time(now - 60);
+      load_async(fb);
+      check_same(ref, fb, "cached");
+      set_dir_time(now - 30);
+      load_async(fb);
+      check(fb.size() == ref.size() + 1, "new file is listed", "modified");
+      ref.load(dir);
+      check_same(ref, fb, "modified");
+    } else {
+      tty->printf("Can't set the modification time, cache not tested.\n");
+    }
+
+    // Errors are reported after the last callback...
+    char missing[1200];
+    snprintf(missing, sizeof(missing), "%s/missing", dir);
+    ncalls = 0;
+    fb.load_async(missing);
+    for (i = 0; i < 500 && fb.loading(); i++) Fl::wait(0.02);
+    check(!fb.loading() && ncalls > 0, "load finishes", "missing directory");
+    check(fb.size() == 0, "no files are listed", "missing directory");
+    check(fb.errmsg() != 0, "error message is set", "missing directory");
+  }
+
+  static void test_cb(Fl_Widget *, void *v) {
+    FileBrowserTest *t = (FileBrowserTest *)v;
+    t->nfailed = 0;
+    if (t->make_dir()) t->run();
+    else t->check(0, "can't create test directory", t->dir);
+    t->remove_dir();
+    if (t->nfailed) t->tty->printf("%d checks failed.\n", t->nfailed);
+    else t->tty->printf("All checks passed.\n");
+  }
+
+public:
+  static Fl_Widget *create() {
+    return new FileBrowserTest(TESTAREA_X, TESTAREA_Y, TESTAREA_W, TESTAREA_H);
+  }
+  FileBrowserTest(int x, int y, int w, int h) : Fl_Group(x, y, w, h), nfailed(0), ncalls(0) {
+    dir[0] = 0;
+    Fl_Button *b = new Fl_Button(x, y, 120, 25, "Run Tests");
+    b->callback(test_cb, this);
+    tty = new Fl_Simple_Terminal(x, y + 35, w, h - 35);
+    tty->ansi(true);
+    tty->printf("\"Run Tests\" loads a temporary directory with %d files with\n"
+                "Fl_File_Browser::load() and load_async(), including cached\n"
+                "and changed directories.\n", FB_TEST_FILES);
+    resizable(tty);
+    end();
+  }
+};
+
+UnitTest file_browser("file browser", FileBrowserTest::create);
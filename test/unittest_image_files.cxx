@@ -0,0 +1,113 @@
+//
+// Unit tests for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_GIF_Image.H>
+#include <FL/Fl_Simple_Terminal.H>
+
+//
+//------- test reading image files from memory ----------
+//
+class ImageFileTest : public Fl_Group {
+  Fl_Simple_Terminal *tty;
+  int nfailed;
+
+  void check(int ok, const char *what, const char *name) {
+    if (!ok) {
+      tty->printf("\033[31mFAILED\033[0m: %s (%s)\n", what, name);
+      nfailed++;
+    }
+  }
+
+  // Write a GIF with a logical screen of SW x SH pixels and two frames of
+  // W x H pixels at (X, Y) and (0, 0) to buf and return its size. All
+  // pixels of the frames have color index 0.
+  static int make_gif(uchar *buf, int SW, int SH, int W, int H, int X, int Y) {
+    static const uchar header[] = {
+      'G', 'I', 'F', '8', '9', 'a', 0, 0, 0, 0,
+      0x80, 0, 0,                 // global color map with 2 colors
+      0, 0, 0, 255, 255, 255
+    };
+    uchar *p = buf;
+    memcpy(p, header, sizeof(header));
+    p[6] = SW & 255; p[7] = SW >> 8; p[8] = SH & 255; p[9] = SH >> 8;
+    p += sizeof(header);
+    for (int i = 0; i < 2; i++) {
+      int x = i ? 0 : X, y = i ? 0 : Y;
+      *p++ = 0x2c;                // image descriptor
+      *p++ = x & 255; *p++ = x >> 8; *p++ = y & 255; *p++ = y >> 8;
+      *p++ = W & 255; *p++ = W >> 8; *p++ = H & 255; *p++ = H >> 8;
+      *p++ = 0;                   // no local color map
+      *p++ = 2;                   // LZW code size
+      *p++ = 2;                   // clear, 0, end of data with 3 bits each
+      *p++ = 0x44; *p++ = 0x01;
+      *p++ = 0;
+    }
+    *p++ = 0x3b;                  // trailer
+    return (int)(p - buf);
+  }
+
+  static void test_cb(Fl_Widget *, void *v) {
+    ImageFileTest *t = (ImageFileTest *)v;
+    uchar buf[64];
+    int n;
+    t->nfailed = 0;
+    {
+      n = make_gif(buf, 2, 1, 1, 1, 1, 0);
+      Fl_GIF_Image gif("two frames", buf, n, true);
+      t->check(!gif.fail(), "image is loaded", "two frames");
+      t->check(gif.frames() == 2, "all frames are loaded", "two frames");
+      t->check(gif.w() == 1 && gif.h() == 1, "image has the first frame", "two frames");
+      Fl_RGB_Image *frame = gif.frame(1);
+      t->check(frame && frame->w() == 2 && frame->h() == 1,
+               "frame size is the screen size", "two frames");
+    }
+    {
+      // The first frame extends the canvas to 65536 x 65536 pixels,
+      // whose size in bytes does not fit into an int.
+      n = make_gif(buf, 1, 1, 1, 1, 65535, 65535);
+      Fl_GIF_Image gif("oversized screen", buf, n, true);
+      t->check(!gif.fail(), "image is loaded", "oversized screen");
+      t->check(gif.frames() == 0, "frames are not composed", "oversized screen");
+      t->check(gif.w() == 1 && gif.h() == 1, "image has the first frame", "oversized screen");
+    }
+    {
+      n = make_gif(buf, 1, 1, 65535, 65535, 0, 0);
+      Fl_GIF_Image gif("oversized frame", buf, n);
+      t->check(gif.fail() == Fl_Image::ERR_FORMAT, "image is rejected", "oversized frame");
+    }
+    if (t->nfailed) t->tty->printf("%d checks failed.\n", t->nfailed);
+    else t->tty->printf("All checks passed.\n");
+  }
+
+public:
+  static Fl_Widget *create() {
+    return new ImageFileTest(TESTAREA_X, TESTAREA_Y, TESTAREA_W, TESTAREA_H);
+  }
+  ImageFileTest(int x, int y, int w, int h) : Fl_Group(x, y, w, h), nfailed(0) {
+    Fl_Button *b = new Fl_Button(x, y, 120, 25, "Run Tests");
+    b->callback(test_cb, this);
+    tty = new Fl_Simple_Terminal(x, y + 35, w, h - 35);
+    tty->ansi(true);
+    tty->printf("\"Run Tests\" reads crafted GIF images from memory,\n"
+                "including frames that exceed the logical screen.\n");
+    resizable(tty);
+    end();
+  }
+};
+
+UnitTest image_files("image files", ImageFileTest::create);
@@ -0,0 +1,157 @@
+//
+// Unit tests for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Menu_Bar.H>
+#include <FL/Fl_Simple_Terminal.H>
+
+//
+//------- test adding many menu items at once ----------
+//
+class MenuTest : public Fl_Group {
+  Fl_Simple_Terminal *tty;
+  int nfailed;
+
+  void check(int ok, const char *what, const char *name) {
+    if (!ok) {
+      tty->printf("\033[31mFAILED\033[0m: %s (%s)\n", what, name);
+      nfailed++;
+    }
+  }
+
+  static int same_text(const char *a, const char *b) {
+    return a == b || (a && b && !strcmp(a, b));
+  }
+
+  // Add the items of base one by one to two menus. Then add the items
+  // of items one by one to the first menu and with one call of
+  // Fl_Menu_::add(const Fl_Menu_Item*, int) to the second menu, and
+  // check that both menu arrays and all pathname lookups are the same.
+  void test_add(const char *name, const Fl_Menu_Item *base, int nbase,
+                const Fl_Menu_Item *items, int n) {
+    Fl_Menu_Bar single(0, 0, 100, 25), bulk(0, 0, 100, 25);
+    int i, k;
+    for (i = 0; i < nbase; i++) {
+      const Fl_Menu_Item &m = base[i];
+      single.add(m.text, m.shortcut_, m.callback_, m.user_data_, m.flags);
+      bulk.add(m.text, m.shortcut_, m.callback_, m.user_data_, m.flags);
+    }
+    for (i = 0; i < n; i++) {
+      const Fl_Menu_Item &m = items[i];
+      single.add(m.text, m.shortcut_, m.callback_, m.user_data_, m.flags);
+    }
+    bulk.add(items, n);
+
+    check(single.size() == bulk.size(), "size() of the menu", name);
+    if (single.size() != bulk.size()) return;
+    const Fl_Menu_Item *a = single.menu(), *b = bulk.menu();
+    for (i = 0; i < single.size(); i++) {
+      check(same_text(a[i].text, b[i].text), "text of an item", name);
+      check(a[i].flags == b[i].flags, "flags of an item", name);
+      check(a[i].shortcut_ == b[i].shortcut_, "shortcut of an item", name);
+      check(a[i].callback_ == b[i].callback_, "callback of an item", name);
+      check(a[i].user_data_ == b[i].user_data_, "user data of an item", name);
+    }
+    for (k = 0; k < 2; k++) {
+      single.path_table(k);
+      bulk.path_table(k);
+      for (i = 0; i < nbase; i++)
+        check(single.find_index(base[i].text) == bulk.find_index(base[i].text),
+              "find_index() of an existing item", name);
+      for (i = 0; i < n; i++)
+        check(single.find_index(items[i].text) == bulk.find_index(items[i].text),
+              "find_index() of an added item", name);
+    }
+  }
+
+  static void test_cb(Fl_Widget *, void *v) {
+    MenuTest *t = (MenuTest *)v;
+    static Fl_Menu_Item recent[] = {
+      { "a.txt" }, { "b.txt" }, { 0 }
+    };
+    t->nfailed = 0;
+    {
+      Fl_Menu_Item items[] = {
+        { "File", 0, 0, 0, FL_SUBMENU },
+        { "File/Open", FL_COMMAND + 'o' },
+        { "File/Save", FL_COMMAND + 's' }
+      };
+      t->test_add("new submenu", 0, 0, items, 3);
+    }
+    {
+      Fl_Menu_Item base[] = {
+        { "File/Open", FL_COMMAND + 'o' },
+        { "Edit/Copy", FL_COMMAND + 'c' },
+        { "Edit/Hidden", 0, 0, 0, FL_MENU_INVISIBLE }
+      };
+      Fl_Menu_Item items[] = {
+        { "File/Save", FL_COMMAND + 's' },
+        { "Edit/Paste", FL_COMMAND + 'v' },
+        { "File/Open", FL_COMMAND + 'O' },
+        { "Edit/Hidden" },
+        { "_Help/About" },
+        { "Edit/Find/Next", FL_F + 3 },
+        { "Edit/Find", 0, 0, 0, FL_SUBMENU },
+        { "Edit/Find/Previous" }
+      };
+      t->test_add("existing submenus", base, 3, items, 8);
+    }
+    {
+      Fl_Menu_Item base[] = {
+        { "File/Recent", 0, 0, (void *)recent, FL_SUBMENU_POINTER },
+        { "Recent", 0, 0, (void *)recent, FL_SUBMENU_POINTER }
+      };
+      Fl_Menu_Item items[] = {
+        { "File/Recent/c.txt" },
+        { "File/Quit" },
+        { "Recent", FL_COMMAND + 'r', 0, (void *)recent, FL_SUBMENU_POINTER },
+        { "Recent/d.txt" }
+      };
+      t->test_add("FL_SUBMENU_POINTER", base, 2, items, 4);
+    }
+    {
+      static char text[300][32];
+      Fl_Menu_Item items[300];
+      memset(items, 0, sizeof(items));
+      for (int i = 0; i < 300; i++) {
+        snprintf(text[i], sizeof(text[i]), "Dir%d/Sub%d/Item%d", i % 7, i % 3, i % 50);
+        items[i].text = text[i];
+        items[i].shortcut_ = i;
+      }
+      t->test_add("many items", items, 10, items, 300);
+    }
+    if (t->nfailed) t->tty->printf("%d checks failed.\n", t->nfailed);
+    else t->tty->printf("All checks passed.\n");
+  }
+
+public:
+  static Fl_Widget *create() {
+    return new MenuTest(TESTAREA_X, TESTAREA_Y, TESTAREA_W, TESTAREA_H);
+  }
+  MenuTest(int x, int y, int w, int h) : Fl_Group(x, y, w, h), nfailed(0) {
+    Fl_Button *b = new Fl_Button(x, y, 120, 25, "Run Tests");
+    b->callback(test_cb, this);
+    tty = new Fl_Simple_Terminal(x, y + 35, w, h - 35);
+    tty->ansi(true);
+    tty->printf("\"Run Tests\" compares Fl_Menu_::add(const Fl_Menu_Item*, int)\n"
+                "with adding the same items one by one.\n");
+    resizable(tty);
+    end();
+  }
+};
+
+UnitTest menu("menu", MenuTest::create);
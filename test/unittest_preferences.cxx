@@ -0,0 +1,192 @@
+//
+// Unit tests for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <time.h>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Simple_Terminal.H>
+#include <FL/Fl_Preferences.H>
+#include <FL/filename.H>
+#include <FL/fl_utf8.h>
+
+//
+//------- test the Fl_Preferences group and entry lookup ----------
+//
+class PreferencesTest : public Fl_Group {
+  Fl_Simple_Terminal *tty;
+  int nfailed;
+
+  void check(int ok, const char *what, int n) {
+    if (!ok) {
+      tty->printf("\033[31mFAILED\033[0m: %s (%d groups)\n", what, n);
+      nfailed++;
+    }
+  }
+
+  // Build a tree with n groups below the top group and check the path
+  // semantics of groupExists() and deleteGroup(). Groups with many
+  // children or entries use hash tables, hence n is run below and above
+  // that limit.
+  void test_paths(int n) {
+    char name[64], path[64];
+    int i, v;
+    Fl_Preferences top(0L, "unittest_preferences");
+    top.deleteAllGroups();
+    top.deleteAllEntries();
+    for (i = 0; i < n; i++) {
+      snprintf(path, sizeof(path), "g%d/sub/leaf", i);
+      Fl_Preferences leaf(top, path);
+      leaf.set("value", i);
+    }
+    check(top.groups() == n, "number of groups", n);
+    for (i = 0; i < n; i++) {
+      snprintf(name, sizeof(name), "g%d", i);
+      check(top.groupExists(name), "group exists", n);
+      snprintf(path, sizeof(path), "g%d/sub", i);
+      check(top.groupExists(path), "nested group exists", n);
+      snprintf(path, sizeof(path), "g%d/sub/leaf", i);
+      check(top.groupExists(path), "nested group exists", n);
+      snprintf(path, sizeof(path), "g%d/leaf", i);
+      check(!top.groupExists(path), "skipped level does not exist", n);
+      snprintf(path, sizeof(path), "g%d/su", i);
+      check(!top.groupExists(path), "prefix of a group does not exist", n);
+      snprintf(path, sizeof(path), "g%d/sub/leaf", i);
+      Fl_Preferences leaf(top, path);
+      leaf.get("value", v, -1);
+      check(v == i, "entry in nested group", n);
+    }
+    check(!top.groupExists("g"), "prefix of a group does not exist", n);
+    check(!top.groupExists("sub"), "nested group is not a child", n);
+    check(!top.groupExists(""), "empty path does not exist", n);
+    check(top.groupExists("."), "\".\" is the current group", n);
+    check(top.groupExists("./"), "\"./\" is the topmost group", n);
+    check(top.groupExists("./unittest_preferences/g0/sub"),
+          "path relative to the topmost group", n);
+    {
+      Fl_Preferences sub(top, "g0/sub");
+      check(sub.groupExists("leaf"), "group exists in nested group", n);
+      check(!sub.groupExists("g0"), "parent is not a child", n);
+      check(sub.groupExists("./unittest_preferences/g0"),
+            "path relative to the topmost group from nested group", n);
+    }
+    // delete nested groups and create them again
+    for (i = 0; i < n; i += 2) {
+      snprintf(path, sizeof(path), "g%d/sub", i);
+      check(top.deleteGroup(path) != 0, "delete nested group", n);
+      check(!top.groupExists(path), "deleted group does not exist", n);
+      snprintf(path, sizeof(path), "g%d/sub/leaf", i);
+      check(!top.groupExists(path), "child of deleted group does not exist", n);
+      Fl_Preferences leaf(top, path);
+      leaf.get("value", v, -1);
+      check(v == -1, "re-created group has no entries", n);
+      check(top.groupExists(path), "re-created group exists", n);
+    }
+    for (i = 1; i < n; i += 2) {
+      snprintf(path, sizeof(path), "g%d/sub/leaf", i);
+      Fl_Preferences leaf(top, path);
+      leaf.get("value", v, -1);
+      check(v == i, "other groups are unchanged", n);
+    }
+    // delete top level groups and create them again
+    check(top.deleteGroup("g0") != 0, "delete group", n);
+    check(!top.groupExists("g0"), "deleted group does not exist", n);
+    check(top.groups() == n - 1, "number of groups after delete", n);
+    { Fl_Preferences g0(top, "g0"); }
+    check(top.groupExists("g0"), "re-created group exists", n);
+    check(top.groups() == n, "number of groups after re-create", n);
+    // entries, including deleting an entry
+    for (i = 0; i < n; i++) {
+      snprintf(name, sizeof(name), "e%d", i);
+      top.set(name, i);
+    }
+    check(top.entries() == n, "number of entries", n);
+    check(top.deleteEntry("e0") != 0, "delete entry", n);
+    check(!top.entryExists("e0"), "deleted entry does not exist", n);
+    for (i = 1; i < n; i++) {
+      snprintf(name, sizeof(name), "e%d", i);
+      top.get(name, v, -1);
+      check(v == i, "entry after delete", n);
+    }
+    top.deleteAllGroups();
+    top.deleteAllEntries();
+  }
+
+  static void test_cb(Fl_Widget *, void *v) {
+    PreferencesTest *t = (PreferencesTest *)v;
+    t->nfailed = 0;
+    t->test_paths(3);
+    t->test_paths(100);
+    if (t->nfailed) t->tty->printf("%d checks failed.\n", t->nfailed);
+    else t->tty->printf("All checks passed.\n");
+  }
+
+  // Write a preferences file with 100000 entries in one group and read it.
+  static void benchmark_cb(Fl_Widget *, void *data) {
+    PreferencesTest *t = (PreferencesTest *)data;
+    const int n = 100000;
+    char file[FL_PATH_MAX], name[32];
+    const char *dir = fl_getenv("TMPDIR");
+    if (!dir) dir = fl_getenv("TEMP");
+    if (!dir) dir = "/tmp";
+    snprintf(file, sizeof(file), "%s/unittest_preferences.prefs", dir);
+    int i, v, sum = 0;
+    clock_t t0 = clock();
+    {
+      Fl_Preferences prefs(dir, "fltk.org", "unittest_preferences");
+      Fl_Preferences group(prefs, "benchmark");
+      for (i = 0; i < n; i++) {
+        snprintf(name, sizeof(name), "entry%d", i);
+        group.set(name, i);
+      }
+      prefs.flush();
+    }
+    clock_t t1 = clock();
+    {
+      Fl_Preferences prefs(dir, "fltk.org", "unittest_preferences");
+      Fl_Preferences group(prefs, "benchmark");
+      for (i = 0; i < n; i++) {
+        snprintf(name, sizeof(name), "entry%d", i);
+        group.get(name, v, 0);
+        sum += (v == i);
+      }
+    }
+    clock_t t2 = clock();
+    fl_unlink(file);
+    t->tty->printf("%d entries: write %.3fs, read %.3fs%s\n", n,
+                   double(t1 - t0) / CLOCKS_PER_SEC,
+                   double(t2 - t1) / CLOCKS_PER_SEC,
+                   sum == n ? "" : " \033[31m(values differ)\033[0m");
+  }
+
+public:
+  static Fl_Widget *create() {
+    return new PreferencesTest(TESTAREA_X, TESTAREA_Y, TESTAREA_W, TESTAREA_H);
+  }
+  PreferencesTest(int x, int y, int w, int h) : Fl_Group(x, y, w, h), nfailed(0) {
+    Fl_Button *b = new Fl_Button(x, y, 120, 25, "Run Tests");
+    b->callback(test_cb, this);
+    b = new Fl_Button(x + 130, y, 120, 25, "Benchmark");
+    b->callback(benchmark_cb, this);
+    tty = new Fl_Simple_Terminal(x, y + 35, w, h - 35);
+    tty->ansi(true);
+    tty->printf("\"Run Tests\" checks group paths and entries of Fl_Preferences.\n"
+                "\"Benchmark\" writes and reads a file with 100000 entries.\n");
+    resizable(tty);
+    end();
+  }
+};
+
+UnitTest preferences("preferences", PreferencesTest::create);
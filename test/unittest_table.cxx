@@ -0,0 +1,216 @@
+//
+// Unit tests for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2020 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Table.H>
+#include <FL/Fl_Window.H>
+#include <FL/Fl_RGB_Image.H>
+#include <FL/Fl_Simple_Terminal.H>
+#include <FL/fl_draw.H>
+
+#define TT_ROWS 100
+#define TT_COLS 20
+
+// A table with colored cells that counts how many cells it draws
+class CountingTable : public Fl_Table {
+protected:
+  void draw_cell(TableContext context, int R, int C, int X, int Y, int W, int H) {
+    char s[20];
+    switch (context) {
+      case CONTEXT_STARTPAGE:
+        fl_font(FL_HELVETICA, 12);
+        return;
+      case CONTEXT_ROW_HEADER:
+      case CONTEXT_COL_HEADER:
+        snprintf(s, sizeof(s), "%d", context == CONTEXT_ROW_HEADER ? R : C);
+        fl_push_clip(X, Y, W, H);
+        fl_draw_box(FL_THIN_UP_BOX, X, Y, W, H, row_header_color());
+        fl_color(FL_BLACK);
+        fl_draw(s, X, Y, W, H, FL_ALIGN_CENTER);
+        fl_pop_clip();
+        return;
+      case CONTEXT_CELL:
+        ncells++;
+        snprintf(s, sizeof(s), "%d", value[R][C]);
+        fl_push_clip(X, Y, W, H);
+        fl_color(fl_rgb_color(uchar(R * 37), uchar(C * 53), uchar(value[R][C] * 91)));
+        fl_rectf(X, Y, W, H);
+        fl_color(FL_WHITE);
+        fl_draw(s, X, Y, W, H, FL_ALIGN_CENTER);
+        fl_pop_clip();
+        return;
+      default:
+        return;
+    }
+  }
+
+public:
+  int ncells;
+  int value[TT_ROWS][TT_COLS];
+
+  CountingTable(int x, int y, int w, int h) : Fl_Table(x, y, w, h), ncells(0) {
+    for (int r = 0; r < TT_ROWS; r++)
+      for (int c = 0; c < TT_COLS; c++)
+        value[r][c] = r * TT_COLS + c;
+    rows(TT_ROWS);
+    cols(TT_COLS);
+    row_header(1);
+    col_header(1);
+    row_height_all(20);
+    col_width_all(60);
+    end();
+  }
+
+  // Number of cells on screen
+  int nvisible() {
+    int r1, r2, c1, c2;
+    visible_cells(r1, r2, c1, c2);
+    return (r2 - r1 + 1) * (c2 - c1 + 1);
+  }
+};
+
+//
+//------- test redrawing scrolled and changed Fl_Table cells ----------
+//
+class TableTest : public Fl_Group {
+  Fl_Simple_Terminal *tty;
+  CountingTable *table;
+  int nfailed;
+
+  void check(int ok, const char *what, const char *name) {
+    if (!ok) {
+      tty->printf("\033[31mFAILED\033[0m: %s (%s)\n", what, name);
+      nfailed++;
+    }
+  }
+
+  // Draw the pending changes of the table, returns the number of cells drawn
+  int flush() {
+    table->ncells = 0;
+    Fl::flush();
+    return table->ncells;
+  }
+
+  Fl_RGB_Image *capture() {
+    return fl_capture_window_part(window(), table->x(), table->y(), table->w(), table->h());
+  }
+
+  // Check that the table looks the same after a full redraw
+  void check_full_redraw(const char *name) {
+    Fl_RGB_Image *a = capture();
+    table->redraw();
+    int n = flush();
+    check(n == table->nvisible(), "redraw() draws all visible cells", name);
+    Fl_RGB_Image *b = capture();
+    check(a && b && a->w() == b->w() && a->h() == b->h() && a->d() == b->d() &&
+          !memcmp(a->array, b->array, a->w() * a->h() * a->d()),
+          "table looks like after redraw()", name);
+    delete a;
+    delete b;
+  }
+
+  void run() {
+    int r1, r2, c1, c2, n;
+    table->row_position(0);
+    table->col_position(0);
+    table->redraw();
+    flush();
+
+    // Scrolling copies the cells on screen and draws only the exposed ones...
+    table->row_position(2);
+    n = flush();
+    check(n > 0 && n < table->nvisible(), "only exposed cells are drawn", "scroll down");
+    check_full_redraw("scroll down");
+    table->col_position(3);
+    n = flush();
+    check(n > 0 && n < table->nvisible(), "only exposed cells are drawn", "scroll right");
+    check_full_redraw("scroll right");
+    table->row_position(1);
+    table->col_position(1);
+    n = flush();
+    check(n > 0 && n < table->nvisible(), "only exposed cells are drawn", "scroll up and left");
+    check_full_redraw("scroll up and left");
+
+    // ...unless the box of the table is filled over the cells
+    table->box(FL_DOWN_BOX);
+    table->row_position(4);
+    n = flush();
+    check(n == table->nvisible(), "all visible cells are drawn", "scroll with FL_DOWN_BOX");
+    check_full_redraw("scroll with FL_DOWN_BOX");
+    table->box(FL_THIN_DOWN_FRAME);
+    table->redraw();
+    flush();
+
+    // redraw_cell() and redraw_range() draw only the given visible cells
+    table->visible_cells(r1, r2, c1, c2);
+    table->value[r1 + 1][c1 + 1] = -1;
+    table->redraw_cell(r1 + 1, c1 + 1);
+    n = flush();
+    check(n == 1, "one cell is drawn", "redraw_cell");
+    check_full_redraw("redraw_cell");
+    table->value[r1 + 2][c1] = -2;
+    table->value[r1 + 3][c1 + 2] = -3;
+    table->redraw_range(r1 + 2, r1 + 3, c1, c1 + 2);
+    table->redraw_cell(r1 + 2, c1 + 1);
+    n = flush();
+    check(n == 6, "each cell is drawn once", "redraw_range");
+    check_full_redraw("redraw_range");
+    table->redraw_cell(r1 + 1, c1);
+    table->redraw_cell(r2 - 1, c2 - 1);
+    n = flush();
+    check(n == 2, "only the given cells are drawn", "two distant cells");
+    table->redraw_cell(0, 0);
+    table->redraw_range(TT_ROWS - 2, TT_ROWS - 1, 0, TT_COLS - 1);
+    n = flush();
+    check(n == 0, "no cells are drawn", "cells off-screen");
+
+    // Scrolling after redraw_cell() draws the changed cell at its new place
+    table->value[r1 + 4][c1 + 1] = -4;
+    table->redraw_cell(r1 + 4, c1 + 1);
+    table->row_position(r1 + 2);
+    flush();
+    check_full_redraw("redraw_cell and scroll");
+  }
+
+  static void test_cb(Fl_Widget *, void *v) {
+    TableTest *t = (TableTest *)v;
+    t->nfailed = 0;
+    t->run();
+    if (t->nfailed) t->tty->printf("%d checks failed.\n", t->nfailed);
+    else t->tty->printf("All checks passed.\n");
+  }
+
+public:
+  static Fl_Widget *create() {
+    return new TableTest(TESTAREA_X, TESTAREA_Y, TESTAREA_W, TESTAREA_H);
+  }
+  TableTest(int x, int y, int w, int h) : Fl_Group(x, y, w, h), nfailed(0) {
+    Fl_Button *b = new Fl_Button(x, y, 120, 25, "Run Tests");
+    b->callback(test_cb, this);
+    table = new CountingTable(x, y + 35, w, 160);
+    tty = new Fl_Simple_Terminal(x, y + 205, w, h - 205);
+    tty->ansi(true);
+    tty->printf("\"Run Tests\" scrolls the table above and redraws some of\n"
+                "its cells, and compares the cells drawn and the screen\n"
+                "contents with a full redraw.\n");
+    resizable(tty);
+    end();
+  }
+};
+
+UnitTest table("table", TableTest::create);
@@ -153,6 +153,11 @@ public:
 #include "unittest_scrollbarsize.cxx"
 #include "unittest_schemes.cxx"
 #include "unittest_simple_terminal.cxx"
+#include "unittest_preferences.cxx"
+#include "unittest_menu.cxx"
+#include "unittest_image_files.cxx"
+#include "unittest_file_browser.cxx"
+#include "unittest_table.cxx"
 
 // callback whenever the browser value changes
 void Browser_CB(Fl_Widget*, void*) {